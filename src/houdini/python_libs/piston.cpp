@@ -46,6 +46,10 @@ static void _clearPistonDataFromPrim(pxr::UsdStageRefPtr pStage, const pxr::SdfP
 	}
 }
 
+static bool _deformAll(pxr::UsdTimeCode time_code) {
+	return Piston::CurvesDeformerFactory::deformAll(time_code);
+}
+
 struct BSON_to_Python {
 	static PyObject *convert(const Piston::BSON& bson) {
 		dbg_printf("BSON_to_Python::convert()\n");
@@ -65,6 +69,7 @@ boost::python::list get_deformers_map_items(Piston::CurvesDeformerFactory::Defor
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(BaseCurvesDeformer_deform_overloads, Piston::BaseCurvesDeformer::deform, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(BaseCurvesDeformer_deform_dbg_overloads, Piston::BaseCurvesDeformer::deform_dbg, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(BaseCurvesDeformer_deformRange_overloads, Piston::BaseCurvesDeformer::deformRange, 2, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(BaseCurvesDeformer_writeJsonDataToPrim_overloads, Piston::BaseCurvesDeformer::writeJsonDataToPrim, 0, 1)
 
 
@@ -93,6 +98,14 @@ BOOST_PYTHON_MODULE(_piston) {
 		.def("getDataInstancingState", &GlobalConfig::getDataInstancingState)
 		.def("setPointsCacheUsageState", &GlobalConfig::setPointsCacheUsageState)
 		.def("getPointsCacheUsageState", &GlobalConfig::getPointsCacheUsageState)
+		.def("setPointsCacheSpillBudget", &GlobalConfig::setPointsCacheSpillBudget)
+		.def("getPointsCacheSpillBudget", &GlobalConfig::getPointsCacheSpillBudget)
+		.def("setPointsCacheSpillDir", &GlobalConfig::setPointsCacheSpillDir)
+		.def("getPointsCacheSpillDir", &GlobalConfig::getPointsCacheSpillDir)
+		.def("setDataSidecarDir", &GlobalConfig::setDataSidecarDir)
+		.def("getDataSidecarDir", &GlobalConfig::getDataSidecarDir)
+		.def("setThreadsCount", &GlobalConfig::setThreadsCount)
+		.def("getThreadsCount", &GlobalConfig::getThreadsCount)
 	;
 
 	class_<CurvesDeformerFactory, boost::noncopyable>("DeformerFactory",  no_init)
@@ -113,6 +126,9 @@ BOOST_PYTHON_MODULE(_piston) {
 		
 		.def("clear", &CurvesDeformerFactory::clear)
 		.staticmethod("clear")
+
+		.def("deformAll", _deformAll, "@DocString(deformAll)")
+		.staticmethod("deformAll")
 	;
 
 	class_<CurvesDeformerFactory::DeformersMap>("DeformersMap")
@@ -149,6 +165,10 @@ BOOST_PYTHON_MODULE(_piston) {
 		.def("setPointsCacheUsageState", &BaseCurvesDeformer::setPointsCacheUsageState)
 		.def("getPointsCacheUsageState", &BaseCurvesDeformer::getPointsCacheUsageState)
 
+		.def("setAsyncOutputState", &BaseCurvesDeformer::setAsyncOutputState, "@DocString(setAsyncOutputState)")
+		.def("getAsyncOutputState", &BaseCurvesDeformer::getAsyncOutputState)
+		.def("flush", &BaseCurvesDeformer::flush, "@DocString(flush)")
+
 		.def("setInstancingState", &BaseCurvesDeformer::setInstancingState)
 		.def("getInstancingState", &BaseCurvesDeformer::getInstancingState)
 
@@ -156,6 +176,7 @@ BOOST_PYTHON_MODULE(_piston) {
 		.def("getDeformerSubdivLevel", &BaseCurvesDeformer::getDeformerSubdivLevel)
 
 		.def("deform", &BaseCurvesDeformer::deform, BaseCurvesDeformer_deform_overloads(args("time_code")))
+		.def("deformRange", &BaseCurvesDeformer::deformRange, BaseCurvesDeformer_deformRange_overloads(args("start", "end", "step", "ignoreVelocities"), "@DocString(deformRange)"))
 		.def("deform_dbg", &BaseCurvesDeformer::deform_dbg, BaseCurvesDeformer_deform_dbg_overloads(args("time_code")))
 
 		.def("setReadJsonDataFromPrim", &BaseCurvesDeformer::setReadJsonDataFromPrim)
@@ -473,6 +473,7 @@ bool SerializableUsdGeomMeshFaceAdjacency::readFromJSON(const json& j) {
     		return false;
     	}
 
+    	mHasSubdividedAdjacencyData = true;
     	LOG_DBG << "Subdivided adjacency data read from json payload.";
     }
 
@@ -481,6 +482,104 @@ bool SerializableUsdGeomMeshFaceAdjacency::readFromJSON(const json& j) {
 	return true;
 }
 
+static constexpr const char* kJHasSubdData = "adj_has_subd_data";
+static constexpr const char* kBSubdPrefix = "subd_";
+
+bool SerializableUsdGeomMeshFaceAdjacency::dumpToBinary(BinaryDataWriter& writer) const {
+	auto data_to_binary = [&writer](const UsdGeomMeshFaceAdjacency* pAdjacency, const std::string& prefix) {
+		writer.addValue((prefix + kJFaceCount).c_str(), pAdjacency->mFaceCount);
+		writer.addValue((prefix + kJVertexCount).c_str(), pAdjacency->mVertexCount);
+		writer.addValue((prefix + kJMaxFaceCount).c_str(), pAdjacency->mMaxFaceVertexCount);
+
+		writer.addBlock((prefix + kJCounts).c_str(), pAdjacency->mCounts);
+		writer.addBlock((prefix + kJOffsets).c_str(), pAdjacency->mOffsets);
+		writer.addBlock((prefix + kJPrimData).c_str(), pAdjacency->mPrimData);
+		writer.addBlock((prefix + kJVtxToFace).c_str(), pAdjacency->mVtxToFace);
+		writer.addBlock((prefix + kJCornerVertexData).c_str(), pAdjacency->mCornerVertexData);
+
+		writer.addBlock((prefix + kJSrcFaceVertexOffsets).c_str(), pAdjacency->mSrcFaceVertexOffsets);
+		writer.addBlock((prefix + kJSrcFaceVertexIndices).c_str(), pAdjacency->mSrcFaceVertexIndices);
+		writer.addBlock((prefix + kJSrcFaceVertexCounts).c_str(), pAdjacency->mSrcFaceVertexCounts);
+
+		writer.addValue((prefix + kJDataHash).c_str(), static_cast<uint64_t>(pAdjacency->calcHash()));
+	};
+
+	if(!mpAdjacency || !mpAdjacency->isValid()) return false;
+
+	const bool has_subd_data = mpAdjacencySubd && mpAdjacencySubd->isValid();
+
+	data_to_binary(mpAdjacency.get(), "");
+	writer.addValue(kJHasSubdData, static_cast<uint8_t>(has_subd_data));
+	if(has_subd_data) {
+		data_to_binary(mpAdjacencySubd.get(), kBSubdPrefix);
+	}
+
+	return true;
+}
+
+bool SerializableUsdGeomMeshFaceAdjacency::readFromBinary(const BinaryDataReader& reader) {
+	auto binary_to_data = [&reader](UsdGeomMeshFaceAdjacency* pAdjacency, const std::string& prefix) -> bool {
+		assert(pAdjacency);
+		pAdjacency->mValid = false;
+
+		uint64_t data_hash;
+		if(!reader.readValue((prefix + kJFaceCount).c_str(), pAdjacency->mFaceCount) ||
+			!reader.readValue((prefix + kJVertexCount).c_str(), pAdjacency->mVertexCount) ||
+			!reader.readValue((prefix + kJMaxFaceCount).c_str(), pAdjacency->mMaxFaceVertexCount) ||
+			!reader.readBlock((prefix + kJCounts).c_str(), pAdjacency->mCounts) ||
+			!reader.readBlock((prefix + kJOffsets).c_str(), pAdjacency->mOffsets) ||
+			!reader.readBlock((prefix + kJPrimData).c_str(), pAdjacency->mPrimData) ||
+			!reader.readBlock((prefix + kJVtxToFace).c_str(), pAdjacency->mVtxToFace) ||
+			!reader.readBlock((prefix + kJCornerVertexData).c_str(), pAdjacency->mCornerVertexData) ||
+			!reader.readBlock((prefix + kJSrcFaceVertexOffsets).c_str(), pAdjacency->mSrcFaceVertexOffsets) ||
+			!reader.readBlock((prefix + kJSrcFaceVertexIndices).c_str(), pAdjacency->mSrcFaceVertexIndices) ||
+			!reader.readBlock((prefix + kJSrcFaceVertexCounts).c_str(), pAdjacency->mSrcFaceVertexCounts) ||
+			!reader.readValue((prefix + kJDataHash).c_str(), data_hash)) {
+			return false;
+		}
+
+		const size_t calc_adjacency_data_hash = pAdjacency->calcHash();
+		if(calc_adjacency_data_hash != data_hash) {
+			LOG_ERR << "SerializableUsdGeomMeshFaceAdjacency::readFromBinary data hash mismatch !";
+			return false;
+		}
+
+		pAdjacency->mHash = calc_adjacency_data_hash;
+		pAdjacency->mValid = true;
+		return true;
+	};
+
+	if(!mpAdjacency) {
+		mpAdjacency = UsdGeomMeshFaceAdjacency::create();
+	}
+
+	if(!binary_to_data(mpAdjacency.get(), "")) {
+		return false;
+	}
+
+	uint8_t has_subd_data = 0;
+	reader.readValue(kJHasSubdData, has_subd_data);
+
+	if(has_subd_data) {
+		if(!mpAdjacencySubd) {
+			mpAdjacencySubd = UsdGeomMeshFaceAdjacency::create();
+		}
+
+		if(!binary_to_data(mpAdjacencySubd.get(), kBSubdPrefix)) {
+			LOG_WRN << "Error reading subdivided adjacency data !!!";
+			mpAdjacencySubd->invalidate();
+			return false;
+		}
+
+		mHasSubdividedAdjacencyData = true;
+		LOG_DBG << "Subdivided adjacency data read from binary payload.";
+	}
+
+	LOG_DBG << "Adjacency data read from binary payload.";
+
+	return true;
+}
+
 const std::string& SerializableUsdGeomMeshFaceAdjacency::typeName() const { 
 	static const std::string kTypeName = "SerializableUsdGeomMeshFaceAdjacency";
 	return kTypeName;
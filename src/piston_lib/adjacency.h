@@ -103,6 +103,10 @@ class SerializableUsdGeomMeshFaceAdjacency: public SerializableDeformerDataBase
 		virtual bool dumpToJSON(json& j) const override;
 		virtual bool readFromJSON(const json& j) override;
 
+		virtual bool hasBinaryLayout() const override { return true; }
+		virtual bool dumpToBinary(BinaryDataWriter& writer) const override;
+		virtual bool readFromBinary(const BinaryDataReader& reader) override;
+
 		virtual void clearData() override;
 
 	private:
@@ -0,0 +1,103 @@
+#include "async_points_writer.h"
+#include "common.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <shared_mutex>
+
+
+namespace Piston {
+
+AsyncPointsWriter::UniquePtr AsyncPointsWriter::create() {
+	return AsyncPointsWriter::UniquePtr(new AsyncPointsWriter());
+}
+
+AsyncPointsWriter::~AsyncPointsWriter() {
+	flush();
+}
+
+void AsyncPointsWriter::copyPoints(const PointsList& src, std::unique_ptr<PointsList>& pDst) {
+	if(!pDst) {
+		pDst = std::make_unique<PointsList>(src.size());
+	} else {
+		pDst->resize(src.size());
+	}
+	std::copy(src.data(), src.data() + src.size(), pDst->data());
+}
+
+bool AsyncPointsWriter::waitBuffer(Buffer& buffer) {
+	if(!buffer.pending.valid()) return true;
+
+	const bool result = buffer.pending.get();
+	buffer.pending = std::shared_future<bool>();
+	if(!result) {
+		mFailed = true;
+	}
+	return result;
+}
+
+bool AsyncPointsWriter::write(const pxr::UsdAttribute& points_attr, const PointsList& points, const pxr::UsdAttribute& velocities_attr, const PointsList* pVelocities, pxr::UsdTimeCode time_code) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Buffer& buffer = mBuffers[mCurrentBuffer];
+	mCurrentBuffer = (mCurrentBuffer + 1) % mBuffers.size();
+
+	// Previous write. Waited for inside the task to keep authoring order
+	std::shared_future<bool> previous = mBuffers[mCurrentBuffer].pending;
+
+	// Buffer might still be in use by the write issued two frames ago
+	const bool result = waitBuffer(buffer);
+
+	copyPoints(points, buffer.pPoints);
+
+	const bool write_velocities = pVelocities && velocities_attr;
+	if(write_velocities) {
+		copyPoints(*pVelocities, buffer.pVelocities);
+	}
+
+	const PointsList* pPointsData = buffer.pPoints.get();
+	const PointsList* pVelocitiesData = write_velocities ? buffer.pVelocities.get() : nullptr;
+
+	buffer.pending = std::async(std::launch::async, [points_attr, velocities_attr, pPointsData, pVelocitiesData, time_code, previous]() {
+		if(previous.valid()) previous.wait();
+
+		std::unique_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
+
+		if(pVelocitiesData && !velocities_attr.Set(pVelocitiesData->getVtArray(), time_code)) {
+			LOG_ERR << "Error setting velocities attribute to " << velocities_attr.GetPath() << " at " << time_code << " !";
+			return false;
+		}
+
+		if(!points_attr.Set(pPointsData->getVtArray(), time_code)) {
+			LOG_ERR << "Error setting deformed points to " << points_attr.GetPath() << " at " << time_code << " !";
+			return false;
+		}
+		return true;
+	}).share();
+
+	return result;
+}
+
+bool AsyncPointsWriter::flush() {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for(auto& buffer: mBuffers) {
+		waitBuffer(buffer);
+	}
+
+	const bool result = !mFailed;
+	mFailed = false;
+	return result;
+}
+
+bool AsyncPointsWriter::hasPendingWrites() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for(const auto& buffer: mBuffers) {
+		if(buffer.pending.valid() && buffer.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return true;
+	}
+	return false;
+}
+
+} // namespace Piston
@@ -0,0 +1,60 @@
+#ifndef PISTON_LIB_ASYNC_POINTS_WRITER_H_
+#define PISTON_LIB_ASYNC_POINTS_WRITER_H_
+
+#include "framework.h"
+#include "points_list.h"
+
+#include <pxr/usd/usd/attribute.h>
+
+#include <array>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace Piston {
+
+/*
+ * Double buffered deformed points output stage. Data is copied into one of two buffers and authored to USD
+ * on a background thread, so the next frame could be computed while previous one is still being written.
+ * Write blocks only when the buffer it's going to use is still in flight. Writes are authored in submission order.
+ */
+class AsyncPointsWriter {
+	public:
+		using UniquePtr = std::unique_ptr<AsyncPointsWriter>;
+
+		static UniquePtr create();
+
+		~AsyncPointsWriter();
+
+		// Queue points (and optional velocities) to be set at time_code. Returns false if the write that used the same buffer before failed
+		bool write(const pxr::UsdAttribute& points_attr, const PointsList& points, const pxr::UsdAttribute& velocities_attr, const PointsList* pVelocities, pxr::UsdTimeCode time_code);
+
+		// Wait for all pending writes. Returns false if any write failed since last flush
+		bool flush();
+
+		bool hasPendingWrites() const;
+
+	private:
+		AsyncPointsWriter() = default;
+
+		struct Buffer {
+			std::unique_ptr<PointsList> pPoints;
+			std::unique_ptr<PointsList> pVelocities;
+			std::shared_future<bool>    pending;
+		};
+
+		bool waitBuffer(Buffer& buffer);
+
+		static void copyPoints(const PointsList& src, std::unique_ptr<PointsList>& pDst);
+
+	private:
+		std::array<Buffer, 2>   mBuffers;
+		size_t                  mCurrentBuffer = 0;
+		bool                    mFailed = false;
+
+		mutable std::mutex      mMutex;
+};
+
+} // namespace Piston
+
+#endif // PISTON_LIB_ASYNC_POINTS_WRITER_H_
@@ -8,15 +8,19 @@
 
 #include <thread>
 #include <atomic>
+#include <future>
+#include <mutex>
+#include <cmath>
 
 static std::string gLRUCacheStatsLastUsageStr = "-";
+static std::mutex gLRUCacheStatsMutex;
 
 namespace Piston {
 
 BaseCurvesDeformer::BaseCurvesDeformer(const BaseCurvesDeformer::Type t, const std::string& name): 
 	mDirty(true), 
 	mDeformerDataWritten(false), 
-	mPool(std::max(2u, std::thread::hardware_concurrency()) - 1), 
+	mPool(SharedThreadPool::getInstance()), 
 	mType(t), 
 	mName(name), 
 	mID(current_id++),
@@ -190,7 +194,15 @@ bool BaseCurvesDeformer::writeJsonDataToPrim(pxr::UsdTimeCode time_code) {
 		return false;
 	}
 
-	mDeformerDataWritten = writeJsonDataToPrimImpl();
+	std::vector<UsdPrimHandle::DataRequest> requests;
+	collectDataToWrite(requests);
+
+	mDeformerDataWritten = UsdPrimHandle::writeDataToBson(getDataPrimPath(), requests);
+	if(!mDeformerDataWritten) {
+		for(const auto& request: requests) {
+			if(!request.result) DLOG_ERR << "Error writing " << request.pData->typeName() << " deformer data to json !";
+		}
+	}
 	return mDeformerDataWritten;
 }
 
@@ -303,52 +315,173 @@ bool BaseCurvesDeformer::getPointsCacheUsageState() const {
 	return mUsePointsCache && conf.getPointsCacheUsageState();
 }
 
+void BaseCurvesDeformer::setAsyncOutputState(bool state) {
+	if(getAsyncOutputState() == state) return;
+
+	if(state) {
+		mpAsyncPointsWriter = AsyncPointsWriter::create();
+	} else {
+		flush();
+		mpAsyncPointsWriter = nullptr;
+	}
+}
+
+bool BaseCurvesDeformer::flush() {
+	const std::lock_guard<std::recursive_mutex> lock(mDeformMutex);
+	if(!mpAsyncPointsWriter) return true;
+
+	if(!mpAsyncPointsWriter->flush()) {
+		DLOG_ERR << "Error writing " << getName() << " asynchronous output !";
+		return false;
+	}
+	return true;
+}
+
 bool BaseCurvesDeformer::deform_dbg(pxr::UsdTimeCode time_code, bool ignoreVelocities) {	
 	return deform(time_code, false, ignoreVelocities);
 }
 
 bool BaseCurvesDeformer::deform(pxr::UsdTimeCode time_code, bool multi_threaded, bool ignoreVelocities) {
 	DLOG_TRC << "Deform at time code: " << time_code.GetValue();
-		
+	const std::lock_guard<std::recursive_mutex> lock(mDeformMutex);
+
 	const pxr::UsdTimeCode bind_time_code = getRestTimeCode();
 	if(!buildDeformerData(bind_time_code, multi_threaded)) {
 		return false;
 	}
 
-	assert(mpDeformerMeshContainer);
-	if(!mpDeformerMeshContainer || mpDeformerMeshContainer->getRestPositions().empty()) {
+	if(!mpEvalContext) {
+		mpEvalContext = createEvalContext();
+	}
+
+	if(!initEvalContext(*mpEvalContext, false)) {
+		return false;
+	}
+
+	return evaluate(*mpEvalContext, time_code, multi_threaded, ignoreVelocities);
+}
+
+bool BaseCurvesDeformer::deformRange(double start, double end, double step, bool ignoreVelocities) {
+	if(step <= 0.0 || end < start) {
+		DLOG_ERR << "Invalid time range [" << start << ", " << end << "] with step " << step << " !";
 		return false;
 	}
 
-	assert(mpCurvesContainer);	
-	if(!mpCurvesContainer || mpCurvesContainer->empty()) {
+	const std::lock_guard<std::recursive_mutex> lock(mDeformMutex);
+
+	std::vector<pxr::UsdTimeCode> time_codes;
+	const size_t frames_count = static_cast<size_t>(std::floor((end - start) / step + 1e-6)) + 1;
+	time_codes.reserve(frames_count);
+	for(size_t i = 0; i < frames_count; ++i) {
+		time_codes.push_back(pxr::UsdTimeCode(start + static_cast<double>(i) * step));
+	}
+
+	if(!buildDeformerData(getRestTimeCode(), true)) {
 		return false;
 	}
 
-	DLOG_TRC << "Curves in " << to_string(mpCurvesContainer->getSpace()) << " space";
+	if(frames_count == 1 || !canEvaluateConcurrently()) {
+		DLOG_DBG << getName() << " can't be evaluated concurrently. Deforming range sequentially.";
+		for(const auto& time_code: time_codes) {
+			if(!deform(time_code, true, ignoreVelocities)) return false;
+		}
+		return flush();
+	}
+
+	// Each worker is a separate thread that evaluates frames one by one using its own context. Frame inner loops
+	// are still executed by the shared pool, so workers never block pool threads.
+	const size_t workers_count = std::min(frames_count, std::max(size_t(1), mPool.get_thread_count()));
 
-	auto deformPoints = [this](bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
-		if(!mpDeformerMeshContainer->update(mDeformerGeoPrimHandle, time_code, isDirty())) {
+	std::vector<EvalContext::UniquePtr> contexts(workers_count);
+	for(auto& pCtx: contexts) {
+		pCtx = createEvalContext();
+		if(!initEvalContext(*pCtx, true /* make unique */)) {
+			DLOG_ERR << "Error initializing " << getName() << " evaluation context !";
 			return false;
 		}
+	}
+
+	std::atomic<size_t> next_frame = 0;
+	std::atomic<bool> failed = false;
+
+	auto worker_func = [&](EvalContext* pCtx) {
+		for(size_t i = next_frame++; (i < frames_count) && !failed; i = next_frame++) {
+			if(!evaluate(*pCtx, time_codes[i], true, ignoreVelocities)) {
+				DLOG_ERR << "Error deforming " << getName() << " at " << time_codes[i];
+				failed = true;
+			}
+		}
+	};
 
-		if(mpCurvesContainer && !mpCurvesContainer->update(mCurvesGeoPrimHandle, time_code, isDirty())) {
+	std::vector<std::future<void>> workers;
+	workers.reserve(workers_count);
+	for(auto& pCtx: contexts) {
+		workers.push_back(std::async(std::launch::async, worker_func, pCtx.get()));
+	}
+
+	for(auto& worker: workers) {
+		worker.wait();
+	}
+
+	return !failed;
+}
+
+bool BaseCurvesDeformer::initEvalContext(EvalContext& ctx, bool make_unique) const {
+	if(!mpDeformerMeshContainer || !mpCurvesContainer) return false;
+
+	if(!make_unique) {
+		ctx.pDeformerMeshContainer = mpDeformerMeshContainer.get();
+		ctx.pCurvesContainer = mpCurvesContainer.get();
+		return true;
+	}
+
+	ctx.pOwnDeformerMeshContainer = mpDeformerMeshContainer->clone();
+	ctx.pOwnCurvesContainer = mpCurvesContainer->clone();
+	ctx.pDeformerMeshContainer = ctx.pOwnDeformerMeshContainer.get();
+	ctx.pCurvesContainer = ctx.pOwnCurvesContainer.get();
+	return true;
+}
+
+bool BaseCurvesDeformer::canEvaluateConcurrently() const {
+	// Upstream deformer and mesh refiner both keep a single live state
+	return !mDeformerGeoPrimHandle.isDeformerOutput() && (mDeformerGeoPrimHandle.getSubdivLevel() == 0);
+}
+
+bool BaseCurvesDeformer::evaluate(EvalContext& ctx, pxr::UsdTimeCode time_code, bool multi_threaded, bool ignoreVelocities) {
+	assert(ctx.pDeformerMeshContainer);
+	if(!ctx.pDeformerMeshContainer || ctx.pDeformerMeshContainer->getRestPositions().empty()) {
+		return false;
+	}
+
+	assert(ctx.pCurvesContainer);	
+	if(!ctx.pCurvesContainer || ctx.pCurvesContainer->empty()) {
+		return false;
+	}
+
+	DLOG_TRC << "Curves in " << to_string(ctx.pCurvesContainer->getSpace()) << " space";
+
+	auto deformPoints = [this, &ctx](bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+		if(!ctx.pDeformerMeshContainer->update(mDeformerGeoPrimHandle, time_code, isDirty())) {
+			return false;
+		}
+
+		if(!ctx.pCurvesContainer->update(mCurvesGeoPrimHandle, time_code, isDirty())) {
 			return false;
 		}
 		
-		if(multi_threaded) { return deformMtImpl(points, time_code); }
+		if(multi_threaded) { return deformMtImpl(ctx, points, time_code); }
 
-		return deformImpl(points, time_code);
+		return deformImpl(ctx, points, time_code);
 	};
 
-	auto getTempVelocitiesList = [this](size_t list_size) {
-		if(!mpTempVelocitiesList) {
-			mpTempVelocitiesList = std::make_unique<PointsList>(list_size);
+	auto getTempVelocitiesList = [&ctx](size_t list_size) {
+		if(!ctx.pTempVelocitiesList) {
+			ctx.pTempVelocitiesList = std::make_unique<PointsList>(list_size);
 		} else {
-			mpTempVelocitiesList->resize(list_size);
+			ctx.pTempVelocitiesList->resize(list_size);
 		}
 
-		return (PointsList*)mpTempVelocitiesList.get();
+		return (PointsList*)ctx.pTempVelocitiesList.get();
 	};
 
 
@@ -394,11 +527,11 @@ bool BaseCurvesDeformer::deform(pxr::UsdTimeCode time_code, bool multi_threaded,
 		return sNull;
 	};
 
-	const PxrPointsLRUCache::CompositeKey curr_key = {uniqueName(), time_code};
+	const PxrPointsLRUCache::CompositeKey curr_key = {mID, PxrPointsLRUCache::Channel::POINTS, time_code};
 	PxrPointsLRUCache* pPointsLRUCache = mUsePointsCache ? CurvesDeformerFactory::getInstance().getPxrPointsLRUCachePtr() : nullptr;
 
-	const PxrPointsLRUCache::CompositeKey key_from = {uniqueName(), (mMotionBlurDirection != MotionBlurDirection::LEADING) ? pxr::UsdTimeCode(time_code.GetValue() - 1.0) : time_code};
-	const PxrPointsLRUCache::CompositeKey key_to = {uniqueName(), (mMotionBlurDirection != MotionBlurDirection::TRAILING) ? pxr::UsdTimeCode(time_code.GetValue() + 1.0) : time_code};
+	const PxrPointsLRUCache::CompositeKey key_from = {mID, PxrPointsLRUCache::Channel::POINTS, (mMotionBlurDirection != MotionBlurDirection::LEADING) ? pxr::UsdTimeCode(time_code.GetValue() - 1.0) : time_code};
+	const PxrPointsLRUCache::CompositeKey key_to = {mID, PxrPointsLRUCache::Channel::POINTS, (mMotionBlurDirection != MotionBlurDirection::TRAILING) ? pxr::UsdTimeCode(time_code.GetValue() + 1.0) : time_code};
 
 	PxrPointsLRUCacheShrinkLock cache_shrink_lock(pPointsLRUCache); // avoid cache shrinking during deformation stage
 	if(cache_shrink_lock.isValid()) {
@@ -411,23 +544,23 @@ bool BaseCurvesDeformer::deform(pxr::UsdTimeCode time_code, bool multi_threaded,
 	const PointsList* pPointsVBlurFrom = nullptr;
 	const PointsList* pPointsVBlurTo = nullptr;
 
-	const PxrPointsLRUCache::CompositeKey velocity_key = {velocityKeyName(), time_code};
+	const PxrPointsLRUCache::CompositeKey velocity_key = {mID, PxrPointsLRUCache::Channel::VELOCITIES, time_code};
 	const PointsList* veolcities_list_ptr = pPointsLRUCache ? pPointsLRUCache->get(velocity_key) : nullptr;
 	bool output_motion_vectors = false;
 
 	if(!ignoreVelocities && mCalcMotionVectors && mDeformerGeoPrimHandle.hasPositionsTimeSamples(key_from.time, key_to.time)) {
 		if(!veolcities_list_ptr) {
 			pPointsVBlurFrom = (mMotionBlurDirection == MotionBlurDirection::LEADING) ? nullptr :
-				(pPointsLRUCache ? getDeformedPointsLRU(multi_threaded, mpCurvesContainer.get(), pPointsLRUCache, key_from) : getDeformedPoints(mpDeformedPointsListStep, multi_threaded, mpCurvesContainer.get(), key_from));
+				(pPointsLRUCache ? getDeformedPointsLRU(multi_threaded, ctx.pCurvesContainer, pPointsLRUCache, key_from) : getDeformedPoints(ctx.pDeformedPointsListStep, multi_threaded, ctx.pCurvesContainer, key_from));
 			
 			pPointsVBlurTo = (mMotionBlurDirection == MotionBlurDirection::TRAILING) ? nullptr : 
-				(pPointsLRUCache ? getDeformedPointsLRU(multi_threaded, mpCurvesContainer.get(), pPointsLRUCache, key_to) : getDeformedPoints(mpDeformedPointsListStep, multi_threaded, mpCurvesContainer.get(), key_to));
+				(pPointsLRUCache ? getDeformedPointsLRU(multi_threaded, ctx.pCurvesContainer, pPointsLRUCache, key_to) : getDeformedPoints(ctx.pDeformedPointsListStep, multi_threaded, ctx.pCurvesContainer, key_to));
 		}
 
 		output_motion_vectors = true;
 	}
 
-	const PointsList* deformed_points_list_ptr = pPointsLRUCache ? getDeformedPointsLRU(multi_threaded, mpCurvesContainer.get(), pPointsLRUCache, curr_key) : getDeformedPoints(mpDeformedPointsList, multi_threaded, mpCurvesContainer.get(), curr_key);
+	const PointsList* deformed_points_list_ptr = pPointsLRUCache ? getDeformedPointsLRU(multi_threaded, ctx.pCurvesContainer, pPointsLRUCache, curr_key) : getDeformedPoints(ctx.pDeformedPointsList, multi_threaded, ctx.pCurvesContainer, curr_key);
 	assert(deformed_points_list_ptr);
 	if(!deformed_points_list_ptr) {
 		DLOG_ERR << "Error getting deformed points list!";
@@ -437,68 +570,80 @@ bool BaseCurvesDeformer::deform(pxr::UsdTimeCode time_code, bool multi_threaded,
 	pxr::UsdGeomCurves curves(mCurvesGeoPrimHandle.getPrim());
 	pxr::UsdAttribute attr_v = curves.GetVelocitiesAttr();
 
-	if(output_motion_vectors && attr_v) {
+	if(output_motion_vectors && attr_v && !veolcities_list_ptr) {
+		DLOG_TRC << "Calc velocities from " <<  std::to_string(key_from.time.GetValue()) << " to " <<  std::to_string(key_to.time.GetValue());
+		
+		assert(pPointsVBlurFrom || pPointsVBlurTo);
+		const pxr::GfVec3f* p_pts_from_ptr = pPointsVBlurFrom ?  pPointsVBlurFrom->data() : deformed_points_list_ptr->data();
+		const pxr::GfVec3f* p_pts_to_ptr = pPointsVBlurTo ? pPointsVBlurTo->data() : deformed_points_list_ptr->data();
 
-		if(!veolcities_list_ptr) {
-			DLOG_TRC << "Calc velocities from " <<  std::to_string(key_from.time.GetValue()) << " to " <<  std::to_string(key_to.time.GetValue());
-			
-			assert(pPointsVBlurFrom || pPointsVBlurTo);
-			const pxr::GfVec3f* p_pts_from_ptr = pPointsVBlurFrom ?  pPointsVBlurFrom->data() : deformed_points_list_ptr->data();
-			const pxr::GfVec3f* p_pts_to_ptr = pPointsVBlurTo ? pPointsVBlurTo->data() : deformed_points_list_ptr->data();
-
-			assert(p_pts_from_ptr != p_pts_to_ptr);
-
-			const float k = ((mMotionBlurDirection == MotionBlurDirection::CENTERED) ? .5f : 1.0f) * static_cast<float>(mDeformerGeoPrimHandle.getStageTimeCodesPerSecond());
-
-			PointsList* tmp_velicities_list_ptr = pPointsLRUCache ? pPointsLRUCache->put(velocity_key, mpCurvesContainer->getTotalVertexCount()) : getTempVelocitiesList(mpCurvesContainer->getTotalVertexCount());
-			assert(tmp_velicities_list_ptr);
-
-			auto calcVectorsFunc = [&](const std::size_t start, const std::size_t end) {
-				if(p_pts_from_ptr == p_pts_to_ptr) {
-					for(size_t i = start; i < end; ++i) {
-						(*tmp_velicities_list_ptr)[i] = {0.0, 0.0, 0.0};
-					}
-				} else {
-					for(size_t i = start; i < end; ++i) {
-						(*tmp_velicities_list_ptr)[i] = (p_pts_to_ptr[i] - p_pts_from_ptr[i]) * k;
-					}
-				}
-			};
+		assert(p_pts_from_ptr != p_pts_to_ptr);
+
+		const float k = ((mMotionBlurDirection == MotionBlurDirection::CENTERED) ? .5f : 1.0f) * static_cast<float>(mDeformerGeoPrimHandle.getStageTimeCodesPerSecond());
 
-			if(multi_threaded) {
-				BS::multi_future<void> blocks = mPool.submit_blocks(0u, tmp_velicities_list_ptr->size(), calcVectorsFunc);
-				blocks.wait();
+		PointsList* tmp_velicities_list_ptr = pPointsLRUCache ? pPointsLRUCache->put(velocity_key, ctx.pCurvesContainer->getTotalVertexCount()) : getTempVelocitiesList(ctx.pCurvesContainer->getTotalVertexCount());
+		assert(tmp_velicities_list_ptr);
+
+		auto calcVectorsFunc = [&](const std::size_t start, const std::size_t end) {
+			if(p_pts_from_ptr == p_pts_to_ptr) {
+				for(size_t i = start; i < end; ++i) {
+					(*tmp_velicities_list_ptr)[i] = {0.0, 0.0, 0.0};
+				}
 			} else {
-				calcVectorsFunc(0u, tmp_velicities_list_ptr->size());
+				for(size_t i = start; i < end; ++i) {
+					(*tmp_velicities_list_ptr)[i] = (p_pts_to_ptr[i] - p_pts_from_ptr[i]) * k;
+				}
 			}
+		};
 
-			veolcities_list_ptr = (const PointsList*)tmp_velicities_list_ptr;
-			
-			assert(veolcities_list_ptr);
+		if(multi_threaded) {
+			BS::multi_future<void> blocks = mPool.submit_blocks(0u, tmp_velicities_list_ptr->size(), calcVectorsFunc);
+			blocks.wait();
+		} else {
+			calcVectorsFunc(0u, tmp_velicities_list_ptr->size());
 		}
 
-		if(!attr_v.Set(veolcities_list_ptr->getVtArray(), time_code)) {
-			DLOG_ERR << "Error setting velocities attribute !";
+		veolcities_list_ptr = (const PointsList*)tmp_velicities_list_ptr;
+		
+		assert(veolcities_list_ptr);
+	}
+
+	const PointsList* output_velocities_list_ptr = (output_motion_vectors && attr_v) ? veolcities_list_ptr : nullptr;
+
+	if(mpAsyncPointsWriter && (&ctx == mpEvalContext.get())) {
+		// Output data is copied to writer own buffers, so cache entries and context lists are free to be reused
+		if(!mpAsyncPointsWriter->write(curves.GetPointsAttr(), *deformed_points_list_ptr, attr_v, output_velocities_list_ptr, time_code)) {
+			DLOG_ERR << "Error writing deformed points to " << mCurvesGeoPrimHandle << " asynchronously !";
 			return false;
 		}
-	}
+	} else {
+		std::unique_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
 
-	if(!curves.GetPointsAttr().Set(deformed_points_list_ptr->getVtArray(), time_code)) {
-		DLOG_ERR << "Error setting deformerd points to " << mCurvesGeoPrimHandle << " !";
-		return false;
+		if(output_velocities_list_ptr) {
+			if(!attr_v.Set(output_velocities_list_ptr->getVtArray(), time_code)) {
+				DLOG_ERR << "Error setting velocities attribute !";
+				return false;
+			}
+		}
+
+		if(!curves.GetPointsAttr().Set(deformed_points_list_ptr->getVtArray(), time_code)) {
+			DLOG_ERR << "Error setting deformerd points to " << mCurvesGeoPrimHandle << " !";
+			return false;
+		}
 	}
 
 	if(pPointsLRUCache) {
 		const std::string current_usage_str = pPointsLRUCache->getCacheUtilizationString();
+		std::lock_guard<std::mutex> lock(gLRUCacheStatsMutex);
 		if(gLRUCacheStatsLastUsageStr != current_usage_str) {
 			DLOG_DBG << "Points cache utilization: " << current_usage_str << "%";
 			gLRUCacheStatsLastUsageStr = current_usage_str;
 		}
 	}
 
-	if(mShowDebugGeometry) {
+	if(mShowDebugGeometry && (&ctx == mpEvalContext.get())) {
 		drawDebugSubdivDeformerGeometry(time_code);
-		drawDebugGeometry(time_code, deformed_points_list_ptr);
+		drawDebugGeometry(ctx, time_code, deformed_points_list_ptr);
 	}
 
 	return true;
@@ -558,10 +703,35 @@ void BaseCurvesDeformer::setSkinPrimAttrName(const std::string& name) {
 }
 
 
+std::vector<pxr::SdfPath> BaseCurvesDeformer::getInputPrimPaths() const {
+	std::vector<pxr::SdfPath> paths;
+	if(mDeformerGeoPrimHandle.isValid()) {
+		paths.push_back(mDeformerGeoPrimHandle.getPath());
+	}
+	return paths;
+}
+
+bool BaseCurvesDeformer::isOutputReady(pxr::UsdTimeCode time_code) const {
+	const std::lock_guard<std::mutex> lock(mOutputReadyMutex);
+	return mOutputReady && (mOutputReadyTimeCode == time_code);
+}
+
+void BaseCurvesDeformer::setOutputReady(pxr::UsdTimeCode time_code) {
+	const std::lock_guard<std::mutex> lock(mOutputReadyMutex);
+	mOutputReady = true;
+	mOutputReadyTimeCode = time_code;
+}
+
+void BaseCurvesDeformer::clearOutputReady() {
+	const std::lock_guard<std::mutex> lock(mOutputReadyMutex);
+	mOutputReady = false;
+}
+
 void BaseCurvesDeformer::makeDirty() {
 	if(mDirty) return;
 
 	DLOG_TRC << "BaseCurvesDeformer::makeDirty()";
+	flush();
 	mStats.clear();
 	mDirty = true;
 	mDeformerDataWritten = false;
@@ -573,8 +743,7 @@ void BaseCurvesDeformer::makeDirty() {
 
 void BaseCurvesDeformer::clearLRUCaches() {
 	if(PxrPointsLRUCache* pPointsLRUCache = CurvesDeformerFactory::getInstance().getPxrPointsLRUCachePtr()) {
-		pPointsLRUCache->removeByName(uniqueName());
-		pPointsLRUCache->removeByName(velocityKeyName());
+		pPointsLRUCache->removeByDeformer(mID);
 	}
 }
 
@@ -11,8 +11,8 @@
 #include "deformer_data_cache.h"
 #include "serializable_data.h"
 #include "simple_profiler.h"
-
-#include "BS_thread_pool.hpp" // BS::multi_future, BS::thread_pool
+#include "thread_pool.h"
+#include "async_points_writer.h"
 
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usdGeom/mesh.h>
@@ -22,6 +22,7 @@
 #include <memory>
 #include <string>
 #include <mutex>
+#include <vector>
 
 
 namespace Piston {
@@ -48,6 +49,26 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 			LEADING
 		};
 		
+		// Per evaluation state. Everything that changes from frame to frame lives here so several time codes
+		// can be evaluated at once on top of the shared and read only deformer (bind) data.
+		struct EvalContext {
+			using UniquePtr = std::unique_ptr<EvalContext>;
+
+			virtual ~EvalContext() {}
+
+			const MeshContainer*			pDeformerMeshContainer = nullptr;
+			PxrCurvesContainer*				pCurvesContainer = nullptr;
+
+			// we use these containers to store deformed points data when LRU cache is disabled
+			std::unique_ptr<PointsList> 	pDeformedPointsList;
+			std::unique_ptr<PointsList> 	pDeformedPointsListStep;
+			std::unique_ptr<PointsList> 	pTempVelocitiesList;
+
+			// Context own live data containers. Used by frame-parallel evaluation only.
+			MeshContainer::UniquePtr 		pOwnDeformerMeshContainer;
+			PxrCurvesContainer::UniquePtr 	pOwnCurvesContainer;
+		};
+		
 	public:
 		virtual ~BaseCurvesDeformer() {}
 
@@ -74,6 +95,21 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 		void setPointsCacheUsageState(bool state);
 		bool getPointsCacheUsageState() const;
 
+		// DocString: setAsyncOutputState
+		/**
+		 * @brief Enables asynchronous double buffered output. Deformed points are written to USD in background while next frame is computed.
+		 * @param state Asynchronous output state.
+		 */
+		void setAsyncOutputState(bool state);
+		bool getAsyncOutputState() const { return mpAsyncPointsWriter != nullptr; }
+
+		// DocString: flush
+		/**
+		 * @brief Waits until all pending asynchronous output writes are authored to USD.
+		 * @return false if any pending write failed
+		 */
+		bool flush();
+
 		void setInstancingState(bool state);
 		bool getInstancingState() const;
 		
@@ -109,6 +145,16 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 		bool deform(pxr::UsdTimeCode time_code = pxr::UsdTimeCode::Default(), bool multi_threaded = true, bool ignoreVelocities = false);
 		bool deform_dbg(pxr::UsdTimeCode time_code = pxr::UsdTimeCode::Default(), bool ignoreVelocities = false);
 
+		// DocString: deformRange
+		/**
+		 * @brief Deforms curves for every time code in [start, end] range. Several frames are evaluated concurrently.
+		 * @param start First time code.
+		 * @param end Last time code (inclusive).
+		 * @param step Time codes step.
+		 * @return true on success
+		 */
+		bool deformRange(double start, double end, double step = 1.0, bool ignoreVelocities = false);
+
 		const std::string& getName() const { return mName; }
 
 		std::string repr() const;
@@ -126,13 +172,24 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 
 		uint32_t getUniqueID() const { return mID; }
 
+		// Paths of the prims this deformer reads from. Used to build deformers dependency graph.
+		virtual std::vector<pxr::SdfPath> getInputPrimPaths() const;
+
 	protected:
 		BaseCurvesDeformer(const Type type, const std::string& name);
 
 		virtual bool validateDeformerGeoPrim(const pxr::UsdPrim& geoPrim) = 0;
 
-		virtual bool deformImpl(PointsList& points, pxr::UsdTimeCode time_code) = 0;
-		virtual bool deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) = 0;
+		virtual bool deformImpl(EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) = 0;
+		virtual bool deformMtImpl(EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) = 0;
+
+		virtual EvalContext::UniquePtr createEvalContext() const { return std::make_unique<EvalContext>(); }
+		
+		// Points context to deformer live data containers. With make_unique set context gets own containers copies.
+		virtual bool initEvalContext(EvalContext& ctx, bool make_unique) const;
+		
+		// Whether this deformer could be safely evaluated at several time codes at once
+		virtual bool canEvaluateConcurrently() const;
 
 		virtual void invalidateData(DeformerDataCache& cache) = 0;
 
@@ -164,21 +221,24 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 		PxrCurvesContainer::UniquePtr 	mpCurvesContainer;
 		MeshContainer::UniquePtr   		mpDeformerMeshContainer;
 
-		BS::thread_pool<BS::tp::none> mPool;
+		ThreadPool&     mPool; // process wide shared pool
 		DeformerStats mStats;
 
 		std::mutex      mPrmMutex;
+		// Serializes deform(), deformRange() and flush(). Downstream deformers evaluated concurrently may pull this
+		// deformer output at the same (motion blur) time codes. Recursive as deformRange() calls deform() and flush()
+		std::recursive_mutex mDeformMutex;
+
+		EvalContext::UniquePtr mpEvalContext; // context used by deform()
 
-		// we use these containers to store deformed points data when LRU cache is disabled
-		std::unique_ptr<PointsList> mpDeformedPointsList;
-		std::unique_ptr<PointsList> mpDeformedPointsListStep;
-		std::unique_ptr<PointsList> mpTempVelocitiesList;
+		AsyncPointsWriter::UniquePtr mpAsyncPointsWriter; // set when asynchronous output is enabled
 
 	protected:
 		virtual bool buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded = false) = 0;
-		virtual bool writeJsonDataToPrimImpl() const = 0;
+		// Deformer data objects written by writeJsonDataToPrim(). They are serialized concurrently
+		virtual void collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const = 0;
 
-		virtual void drawDebugGeometry(pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) {};
+		virtual void drawDebugGeometry(const EvalContext& ctx, pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) {};
 
 		bool canProduceOutputTimeSamples(pxr::UsdTimeCode time_from, pxr::UsdTimeCode time_to) const {
 			return mDeformerGeoPrimHandle.hasPositionsTimeSamples(time_from, time_to);
@@ -186,8 +246,8 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 
 	private:
 		bool buildDeformerData(pxr::UsdTimeCode rest_time_code, bool multi_threaded = false);
+		bool evaluate(EvalContext& ctx, pxr::UsdTimeCode time_code, bool multi_threaded, bool ignoreVelocities);
 		const std::string& uniqueName() const { return mUniqueName; }
-		std::string velocityKeyName() const { return uniqueName() + "_vel"; }
 
 		static std::atomic_uint32_t current_id;
 
@@ -209,7 +269,17 @@ class BaseCurvesDeformer : public std::enable_shared_from_this<BaseCurvesDeforme
 
 		DebugGeo::UniquePtr mpSubdivDebugGeo;
 
+		// Set during CurvesDeformerFactory::deformAll() once output is written, so downstream deformers don't evaluate it again
+		mutable std::mutex  mOutputReadyMutex;
+		bool                mOutputReady = false;
+		pxr::UsdTimeCode    mOutputReadyTimeCode;
+
+		bool isOutputReady(pxr::UsdTimeCode time_code) const;
+		void setOutputReady(pxr::UsdTimeCode time_code);
+		void clearOutputReady();
+
 		friend class UsdPrimHandle;
+		friend class CurvesDeformerFactory;
 };
 
 } // namespace Piston
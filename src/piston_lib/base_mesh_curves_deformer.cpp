@@ -18,17 +18,9 @@ bool BaseMeshCurvesDeformer::validateDeformerGeoPrim(const pxr::UsdPrim& geoPrim
 	return isMeshGeoPrim(geoPrim);
 }
 
-bool BaseMeshCurvesDeformer::writeJsonDataToPrimImpl() const {
-	if(mpAdjacencyData && !mDeformerGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpAdjacencyData.get())) {
-		DLOG_ERR << "Error writing " << mpAdjacencyData->typeName() << " deformer data to json !";
-		return false;
-	}
-
-	if(mpPhantomTrimeshData && !mCurvesGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpPhantomTrimeshData.get())) {
-		DLOG_ERR << "Error writing " << mpPhantomTrimeshData->typeName() << " curves data to json !";
-		return false;
-	}
-	return true;
+void BaseMeshCurvesDeformer::collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const {
+	if(mpAdjacencyData) requests.push_back({&mDeformerGeoPrimHandle, mpAdjacencyData.get()});
+	if(mpPhantomTrimeshData) requests.push_back({&mCurvesGeoPrimHandle, mpPhantomTrimeshData.get()});
 }
 
 bool BaseMeshCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded) {
@@ -39,8 +31,28 @@ bool BaseMeshCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_co
 		mpAdjacencyData = dataCache.getOrCreateData<SerializableUsdGeomMeshFaceAdjacency>(this, mDeformerGeoPrimHandle, rest_time_code, adjacency_data_created);
 	}
 
-	// Get primitive adjacency json data if present
-	if(adjacency_data_created || !getReadJsonDataState() || !mDeformerGeoPrimHandle.getDataFromBson(getDataPrimPath(), mpAdjacencyData.get())) {
+	bool trimesh_data_created = true;
+	if(!mpPhantomTrimeshData) {
+		mpPhantomTrimeshData = dataCache.getOrCreateData<SerializablePhantomTrimesh>(this, {&mDeformerGeoPrimHandle, &mCurvesGeoPrimHandle}, rest_time_code, trimesh_data_created);
+	}
+
+	// Get primitive adjacency and phantom mesh json data if present. Both are decoded concurrently
+	bool adjacency_data_read = false;
+	bool trimesh_data_read = false;
+	if(getReadJsonDataState() && (!adjacency_data_created || !trimesh_data_created)) {
+		std::vector<UsdPrimHandle::DataRequest> requests;
+		if(!adjacency_data_created) requests.push_back({&mDeformerGeoPrimHandle, mpAdjacencyData.get()});
+		if(!trimesh_data_created) requests.push_back({&mCurvesGeoPrimHandle, mpPhantomTrimeshData.get()});
+
+		UsdPrimHandle::getDataFromBson(getDataPrimPath(), requests);
+
+		for(const auto& request: requests) {
+			if(request.pData == mpAdjacencyData.get()) adjacency_data_read = request.result;
+			if(request.pData == mpPhantomTrimeshData.get()) trimesh_data_read = request.result;
+		}
+	}
+
+	if(!adjacency_data_read) {
 		// Build in place if no json data present or not needed
 		if(!mpAdjacencyData->buildInPlace(mDeformerGeoPrimHandle)) {
 			DLOG_ERR << "Error building mesh adjacency data!";
@@ -53,13 +65,7 @@ bool BaseMeshCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_co
 		return false;
 	}
 
-	bool trimesh_data_created = true;
-	if(!mpPhantomTrimeshData) {
-		mpPhantomTrimeshData = dataCache.getOrCreateData<SerializablePhantomTrimesh>(this, {&mDeformerGeoPrimHandle, &mCurvesGeoPrimHandle}, rest_time_code, trimesh_data_created);
-	}
-
-	// Get phantom mesh json data if present
-	if(trimesh_data_created || !getReadJsonDataState() || !mCurvesGeoPrimHandle.getDataFromBson(getDataPrimPath(), mpPhantomTrimeshData.get())) {
+	if(!trimesh_data_read) {
 		// Build in place if no json data present or not needed
 		if(!mpPhantomTrimeshData->buildInPlace(mDeformerGeoPrimHandle)) {
 			DLOG_ERR << "Error building phantom mesh data!";
@@ -33,7 +33,7 @@ class BaseMeshCurvesDeformer : public BaseCurvesDeformer {
 		
 	protected:
 		virtual bool buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded = false);
-		virtual bool writeJsonDataToPrimImpl() const;
+		virtual void collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const override;
 
 		virtual void invalidateData(DeformerDataCache& cache) override;
 };
@@ -0,0 +1,579 @@
+#include "binary_data_container.h"
+#include "thread_pool.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace Piston {
+
+using namespace BinaryData;
+
+// Smaller payloads are assembled on the calling thread
+static constexpr size_t kParallelWriteSize = 4 * 1024 * 1024;
+
+// Runs func(t) for every task. In parallel on the shared pool for big enough data unless we are on a pool worker already
+template<typename F>
+static void runTasks(size_t data_size, size_t tasks_count, F&& func) {
+	if(data_size >= kParallelWriteSize && tasks_count > 1 && !SharedThreadPool::isWorkerThread()) {
+		BS::multi_future<void> tasks = SharedThreadPool::getInstance().submit_sequence(size_t(0), tasks_count, func);
+		tasks.wait();
+		return;
+	}
+
+	for(size_t t = 0; t < tasks_count; ++t) {
+		func(t);
+	}
+}
+
+static inline void putVarint(std::vector<uint8_t>& out, size_t value) {
+	while(value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+static inline bool getVarint(const uint8_t*& pData, const uint8_t* pEnd, size_t& value) {
+	value = 0;
+	for(unsigned shift = 0; shift < 64; shift += 7) {
+		if(pData == pEnd) return false;
+		const uint8_t byte = *pData++;
+		value |= static_cast<size_t>(byte & 0x7F) << shift;
+		if(!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+static inline void copyName(char* dst, size_t max_length, const std::string& src) {
+	const size_t length = std::min(src.size(), max_length);
+	std::memset(dst, 0, max_length + 1);
+	std::memcpy(dst, src.data(), length);
+}
+
+// FNV-1a over 64 bit words. Cheap enough to run on every chunk decode
+uint32_t BinaryData::checksum(const uint8_t* pData, size_t size) {
+	static constexpr uint64_t kPrime = 0x100000001b3ull;
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	size_t i = 0;
+	for(; (i + sizeof(uint64_t)) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, pData + i, sizeof(uint64_t));
+		hash = (hash ^ word) * kPrime;
+	}
+	for(; i < size; ++i) {
+		hash = (hash ^ pData[i]) * kPrime;
+	}
+
+	return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+bool ChunkedBlockView::decodeChunk(size_t chunk_idx, void* pDst) const {
+	assert(chunk_idx < chunks_count);
+	const ChunkEntry& chunk = pChunks[chunk_idx];
+	const uint8_t* pChunkData = pData + chunk.offset;
+
+	if(checksum(pChunkData, static_cast<size_t>(chunk.size)) != chunk.checksum) {
+		return false;
+	}
+
+	uint8_t* pChunkDst = static_cast<uint8_t*>(pDst) + chunk_idx * static_cast<size_t>(elements_per_chunk) * element_size;
+	const size_t raw_size = static_cast<size_t>(chunk.count) * element_size;
+	if(chunk.size < raw_size) {
+		return decompressChunk(pChunkData, static_cast<size_t>(chunk.size), element_size, chunk.count, pChunkDst);
+	}
+
+	std::memcpy(pChunkDst, pChunkData, raw_size);
+	return true;
+}
+
+// Elements are seen as columns of 32 bit words. Each column is delta coded along the chunk and zigzag mapped, so sorted ids and
+// slowly changing values turn into small numbers. Delta bytes are shuffled into 4 planes (all low bytes first, high bytes last)
+// and planes are stored as [varint zeros][varint literals][literal bytes] runs, which eats the mostly zero high planes.
+bool BinaryData::compressChunk(const uint8_t* pSrc, size_t element_size, size_t count, std::vector<uint8_t>& out) {
+	out.clear();
+	if(count == 0 || element_size == 0 || (element_size % sizeof(uint32_t)) != 0) return false;
+
+	const size_t raw_size = element_size * count;
+	const size_t words_count = element_size / sizeof(uint32_t);
+	const size_t plane_size = words_count * count;
+
+	std::vector<uint8_t> planes(raw_size);
+	for(size_t w = 0; w < words_count; ++w) {
+		uint32_t prev = 0;
+		for(size_t i = 0; i < count; ++i) {
+			uint32_t word;
+			std::memcpy(&word, pSrc + i * element_size + w * sizeof(uint32_t), sizeof(uint32_t));
+			const int32_t delta = static_cast<int32_t>(word - prev);
+			const uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+			prev = word;
+
+			const size_t idx = w * count + i;
+			planes[idx] = static_cast<uint8_t>(zigzag);
+			planes[plane_size + idx] = static_cast<uint8_t>(zigzag >> 8);
+			planes[plane_size * 2 + idx] = static_cast<uint8_t>(zigzag >> 16);
+			planes[plane_size * 3 + idx] = static_cast<uint8_t>(zigzag >> 24);
+		}
+	}
+
+	out.reserve(raw_size / 2);
+	size_t pos = 0;
+	while(pos < raw_size) {
+		size_t zeros_end = pos;
+		while(zeros_end < raw_size && planes[zeros_end] == 0) ++zeros_end;
+
+		// single zeros are cheaper as literals than as a new run
+		size_t literals_end = zeros_end;
+		while(literals_end < raw_size && (planes[literals_end] != 0 || ((literals_end + 1) < raw_size && planes[literals_end + 1] != 0))) ++literals_end;
+
+		putVarint(out, zeros_end - pos);
+		putVarint(out, literals_end - zeros_end);
+		out.insert(out.end(), planes.begin() + zeros_end, planes.begin() + literals_end);
+		pos = literals_end;
+
+		if(out.size() >= raw_size) break;
+	}
+
+	if(out.size() >= raw_size) {
+		out.clear();
+		return false;
+	}
+	return true;
+}
+
+bool BinaryData::decompressChunk(const uint8_t* pSrc, size_t size, size_t element_size, size_t count, uint8_t* pDst) {
+	if(element_size == 0 || (element_size % sizeof(uint32_t)) != 0) return false;
+
+	const size_t raw_size = element_size * count;
+	const size_t words_count = element_size / sizeof(uint32_t);
+	const size_t plane_size = words_count * count;
+
+	std::vector<uint8_t> planes(raw_size);
+	const uint8_t* pData = pSrc;
+	const uint8_t* pEnd = pSrc + size;
+	size_t pos = 0;
+	while(pData < pEnd) {
+		size_t zeros, literals;
+		if(!getVarint(pData, pEnd, zeros) || !getVarint(pData, pEnd, literals)) return false;
+		if(zeros > (raw_size - pos)) return false;
+		pos += zeros;
+
+		if(literals > (raw_size - pos) || literals > static_cast<size_t>(pEnd - pData)) return false;
+		std::memcpy(planes.data() + pos, pData, literals);
+		pData += literals;
+		pos += literals;
+	}
+
+	if(pos != raw_size) return false;
+
+	for(size_t w = 0; w < words_count; ++w) {
+		uint32_t prev = 0;
+		for(size_t i = 0; i < count; ++i) {
+			const size_t idx = w * count + i;
+			const uint32_t zigzag = static_cast<uint32_t>(planes[idx]) | (static_cast<uint32_t>(planes[plane_size + idx]) << 8) |
+				(static_cast<uint32_t>(planes[plane_size * 2 + idx]) << 16) | (static_cast<uint32_t>(planes[plane_size * 3 + idx]) << 24);
+			const uint32_t word = prev + ((zigzag >> 1) ^ (0u - (zigzag & 1u)));
+			std::memcpy(pDst + i * element_size + w * sizeof(uint32_t), &word, sizeof(uint32_t));
+			prev = word;
+		}
+	}
+
+	return true;
+}
+
+BinaryDataWriter::BinaryDataWriter(const std::string& data_name, uint32_t version_major, uint32_t version_minor, uint32_t version_build)
+	: mDataName(data_name), mVersion{version_major, version_minor, version_build} {
+	assert(data_name.size() <= kMaxDataNameLength);
+}
+
+void BinaryDataWriter::addBlock(const char* name, size_t element_size, size_t count, const void* pData, uint32_t chunk_elements, bool compressed) {
+	assert(name && std::strlen(name) <= kMaxBlockNameLength);
+	assert(count == 0 || pData);
+	assert(!compressed || chunk_elements);
+	mBlocks.push_back({name, static_cast<uint32_t>(element_size), count, pData, chunk_elements, compressed});
+}
+
+std::vector<uint8_t>& BinaryDataWriter::ownStorage(size_t size) {
+	mOwnedStorage.emplace_back(size);
+	return mOwnedStorage.back();
+}
+
+void BinaryDataWriter::addString(const char* name, const std::string& str) {
+	std::vector<uint8_t>& storage = ownStorage(str.size());
+	if(!str.empty()) {
+		std::memcpy(storage.data(), str.data(), str.size());
+	}
+	addBlock(name, 1, storage.size(), storage.data());
+}
+
+bool BinaryDataWriter::write(BSON& out) const {
+	if(!isLittleEndianHost()) {
+		LOG_ERR << "Binary deformer data is supported on little endian hosts only !";
+		return false;
+	}
+
+	// Chunks are compressed first as their sizes drive the layout. Chunks that don't shrink are stored raw (empty encoded vector)
+	struct EncodeTask {
+		size_t block;
+		size_t chunk;
+	};
+
+	std::vector<std::vector<std::vector<uint8_t>>> encoded_chunks(mBlocks.size());
+	std::vector<EncodeTask> encode_tasks;
+	size_t encode_size = 0;
+
+	for(size_t i = 0; i < mBlocks.size(); ++i) {
+		const PendingBlock& block = mBlocks[i];
+		if(!block.compressed) continue;
+
+		encoded_chunks[i].resize((block.count + block.chunk_elements - 1) / block.chunk_elements);
+		for(size_t c = 0; c < encoded_chunks[i].size(); ++c) {
+			encode_tasks.push_back({i, c});
+		}
+		encode_size += static_cast<size_t>(block.element_size) * block.count;
+	}
+
+	runTasks(encode_size, encode_tasks.size(), [&](const size_t t) {
+		const EncodeTask& task = encode_tasks[t];
+		const PendingBlock& block = mBlocks[task.block];
+		const size_t first = task.chunk * block.chunk_elements;
+		const size_t count = std::min(static_cast<size_t>(block.chunk_elements), block.count - first);
+		compressChunk(static_cast<const uint8_t*>(block.pData) + first * block.element_size, block.element_size, count, encoded_chunks[task.block][task.chunk]);
+	});
+
+	// Precompute block and chunk offsets so the output is allocated once and blocks are copied in parallel
+	std::vector<BlockEntry> entries(mBlocks.size());
+	std::vector<std::vector<ChunkEntry>> chunk_tables(mBlocks.size());
+	size_t offset = alignedSize(sizeof(Header) + sizeof(BlockEntry) * mBlocks.size());
+
+	for(size_t i = 0; i < mBlocks.size(); ++i) {
+		const PendingBlock& block = mBlocks[i];
+		BlockEntry& entry = entries[i];
+
+		copyName(entry.name, kMaxBlockNameLength, block.name);
+		entry.element_size = block.element_size;
+		entry.flags = 0;
+		entry.count = block.count;
+		entry.offset = offset;
+		entry.size = static_cast<uint64_t>(block.element_size) * block.count;
+
+		if(block.chunk_elements) {
+			entry.flags |= BLOCK_CHUNKED;
+			if(block.compressed) entry.flags |= BLOCK_COMPRESSED;
+
+			auto& chunks = chunk_tables[i];
+			chunks.resize((block.count + block.chunk_elements - 1) / block.chunk_elements);
+
+			size_t chunk_offset = alignedSize(offset + sizeof(ChunkTableHeader) + sizeof(ChunkEntry) * chunks.size());
+			size_t region_end = offset + sizeof(ChunkTableHeader) + sizeof(ChunkEntry) * chunks.size();
+			for(size_t c = 0; c < chunks.size(); ++c) {
+				ChunkEntry& chunk = chunks[c];
+				chunk.count = static_cast<uint32_t>(std::min(static_cast<size_t>(block.chunk_elements), block.count - c * block.chunk_elements));
+				chunk.offset = chunk_offset;
+				chunk.size = static_cast<uint64_t>(block.element_size) * chunk.count;
+				chunk.checksum = 0;
+				if(block.compressed && !encoded_chunks[i][c].empty()) {
+					chunk.size = encoded_chunks[i][c].size();
+				}
+
+				region_end = chunk_offset + static_cast<size_t>(chunk.size);
+				chunk_offset = alignedSize(region_end);
+			}
+			entry.size = region_end - offset;
+		}
+
+		offset += alignedSize(static_cast<size_t>(entry.size));
+	}
+
+	Header header;
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.format_version = kFormatVersion;
+	header.blocks_count = static_cast<uint32_t>(mBlocks.size());
+	header.data_version_major = mVersion[0];
+	header.data_version_minor = mVersion[1];
+	header.data_version_build = mVersion[2];
+	header.reserved = 0;
+	header.total_size = offset;
+	copyName(header.data_name, kMaxDataNameLength, mDataName);
+
+	// resize() value initializes, so alignment padding is zeroed without another pass
+	out.clear();
+	out.resize(offset);
+	uint8_t* pOut = reinterpret_cast<uint8_t*>(out.data());
+
+	std::memcpy(pOut, &header, sizeof(Header));
+	if(!entries.empty()) {
+		std::memcpy(pOut + sizeof(Header), entries.data(), sizeof(BlockEntry) * entries.size());
+	}
+
+	// Every block and chunk lands at its precomputed offset, so they are copied independently
+	struct CopyTask {
+		uint8_t*    pDst;
+		const void* pSrc;
+		size_t      size;
+		ChunkEntry* pChunk;  // checksum target for chunks
+	};
+
+	std::vector<CopyTask> tasks;
+	tasks.reserve(mBlocks.size());
+
+	for(size_t i = 0; i < mBlocks.size(); ++i) {
+		if(!(entries[i].flags & BLOCK_CHUNKED)) {
+			if(entries[i].size == 0) continue;
+			tasks.push_back({pOut + entries[i].offset, mBlocks[i].pData, static_cast<size_t>(entries[i].size), nullptr});
+			continue;
+		}
+
+		const uint8_t* pSrc = static_cast<const uint8_t*>(mBlocks[i].pData);
+		for(size_t c = 0; c < chunk_tables[i].size(); ++c) {
+			ChunkEntry& chunk = chunk_tables[i][c];
+			const bool encoded = mBlocks[i].compressed && !encoded_chunks[i][c].empty();
+			tasks.push_back({pOut + chunk.offset, encoded ? encoded_chunks[i][c].data() : pSrc, static_cast<size_t>(chunk.size), &chunk});
+			pSrc += static_cast<size_t>(mBlocks[i].element_size) * chunk.count;
+		}
+	}
+
+	auto copyFunc = [&tasks](const size_t t) {
+		const CopyTask& task = tasks[t];
+		std::memcpy(task.pDst, task.pSrc, task.size);
+		if(task.pChunk) {
+			task.pChunk->checksum = checksum(task.pDst, task.size);
+		}
+	};
+
+	runTasks(offset, tasks.size(), copyFunc);
+
+	// Chunk tables go last as checksums are known now
+	for(size_t i = 0; i < mBlocks.size(); ++i) {
+		if(!(entries[i].flags & BLOCK_CHUNKED)) continue;
+
+		const auto& chunks = chunk_tables[i];
+		const ChunkTableHeader table_header = {static_cast<uint32_t>(chunks.size()), mBlocks[i].chunk_elements, 0};
+		std::memcpy(pOut + entries[i].offset, &table_header, sizeof(ChunkTableHeader));
+		if(!chunks.empty()) {
+			std::memcpy(pOut + entries[i].offset + sizeof(ChunkTableHeader), chunks.data(), sizeof(ChunkEntry) * chunks.size());
+		}
+	}
+
+	return true;
+}
+
+bool BinaryDataReader::open(const uint8_t* pData, size_t size, std::shared_ptr<const void> pOwner) {
+	mpData = nullptr;
+	mSize = 0;
+	mpHeader = nullptr;
+	mpBlocks = nullptr;
+	mpOwner.reset();
+
+	if(!hasBinaryHeader(pData, size)) {
+		LOG_ERR << "Not a binary deformer data !";
+		return false;
+	}
+
+	if(!isLittleEndianHost()) {
+		LOG_ERR << "Binary deformer data is supported on little endian hosts only !";
+		return false;
+	}
+
+	const Header* pHeader = reinterpret_cast<const Header*>(pData);
+
+	if(pHeader->format_version == 0 || pHeader->format_version > kFormatVersion) {
+		LOG_ERR << "Unsupported binary deformer data format version " << pHeader->format_version << " !";
+		return false;
+	}
+
+	const size_t table_end = sizeof(Header) + sizeof(BlockEntry) * static_cast<size_t>(pHeader->blocks_count);
+	if(pHeader->total_size > size || table_end > size) {
+		LOG_ERR << "Binary deformer data is truncated !";
+		return false;
+	}
+
+	const BlockEntry* pBlocks = reinterpret_cast<const BlockEntry*>(pData + sizeof(Header));
+	for(uint32_t i = 0; i < pHeader->blocks_count; ++i) {
+		const BlockEntry& entry = pBlocks[i];
+		const bool chunked = (entry.flags & BLOCK_CHUNKED) != 0;
+		if(entry.name[kMaxBlockNameLength] != '\0' || entry.offset < table_end || (entry.offset + entry.size) > size ||
+			(chunked && entry.size < sizeof(ChunkTableHeader)) ||
+			(!chunked && entry.size != static_cast<uint64_t>(entry.element_size) * entry.count)) {
+			LOG_ERR << "Binary deformer data block " << i << " is corrupted !";
+			return false;
+		}
+	}
+
+	mpData = pData;
+	mSize = size;
+	mpHeader = pHeader;
+	mpBlocks = pBlocks;
+	mpOwner = std::move(pOwner);
+	return true;
+}
+
+std::string BinaryDataReader::getDataName() const {
+	if(!mpHeader) return {};
+	return std::string(mpHeader->data_name, strnlen(mpHeader->data_name, kMaxDataNameLength));
+}
+
+const BlockEntry* BinaryDataReader::findBlock(const char* name) const {
+	if(!mpHeader) return nullptr;
+
+	for(uint32_t i = 0; i < mpHeader->blocks_count; ++i) {
+		if(std::strncmp(mpBlocks[i].name, name, kMaxBlockNameLength) == 0) return &mpBlocks[i];
+	}
+	return nullptr;
+}
+
+const BlockEntry* BinaryDataReader::findTypedBlock(const char* name, size_t element_size) const {
+	const BlockEntry* pBlock = findBlock(name);
+	if(!pBlock) {
+		LOG_ERR << "Binary deformer data has no block \"" << name << "\" !";
+		return nullptr;
+	}
+
+	if(pBlock->element_size != element_size) {
+		LOG_ERR << "Binary deformer data block \"" << name << "\" element size " << pBlock->element_size << " mismatch. Expected " << element_size << " !";
+		return nullptr;
+	}
+
+	return pBlock;
+}
+
+bool BinaryDataReader::isChunkedBlock(const char* name) const {
+	const BlockEntry* pBlock = findBlock(name);
+	return pBlock && (pBlock->flags & BLOCK_CHUNKED);
+}
+
+bool BinaryDataReader::isPlainBlock(const BlockEntry* pBlock) const {
+	if(pBlock->flags & BLOCK_CHUNKED) {
+		LOG_ERR << "Binary deformer data block \"" << pBlock->name << "\" is chunked and can't be viewed in place !";
+		return false;
+	}
+	return true;
+}
+
+bool BinaryDataReader::getChunkedBlock(const char* name, size_t element_size, ChunkedBlockView& view) const {
+	const BlockEntry* pBlock = findTypedBlock(name, element_size);
+	if(!pBlock) return false;
+
+	if(!(pBlock->flags & BLOCK_CHUNKED)) {
+		LOG_ERR << "Binary deformer data block \"" << name << "\" is not chunked !";
+		return false;
+	}
+
+	return getChunkedBlock(pBlock, view);
+}
+
+bool BinaryDataReader::getChunkedBlock(const BlockEntry* pBlock, ChunkedBlockView& view) const {
+	ChunkTableHeader table_header;
+	std::memcpy(&table_header, mpData + pBlock->offset, sizeof(ChunkTableHeader));
+
+	const uint64_t region_end = pBlock->offset + pBlock->size;
+	const uint64_t table_end = pBlock->offset + sizeof(ChunkTableHeader) + sizeof(ChunkEntry) * static_cast<uint64_t>(table_header.chunks_count);
+	bool valid = table_end <= region_end && (table_header.elements_per_chunk > 0 || table_header.chunks_count == 0) && 
+		(static_cast<uint64_t>(table_header.chunks_count) * table_header.elements_per_chunk) >= pBlock->count;
+
+	const ChunkEntry* pChunks = reinterpret_cast<const ChunkEntry*>(mpData + pBlock->offset + sizeof(ChunkTableHeader));
+	const bool compressed = (pBlock->flags & BLOCK_COMPRESSED) != 0;
+	uint64_t elements_count = 0;
+	for(uint32_t c = 0; valid && c < table_header.chunks_count; ++c) {
+		const ChunkEntry& chunk = pChunks[c];
+		const bool last = (c + 1) == table_header.chunks_count;
+		const uint64_t raw_size = static_cast<uint64_t>(chunk.count) * pBlock->element_size;
+		valid = chunk.offset >= table_end && (chunk.offset + chunk.size) <= region_end &&
+			(last ? chunk.count <= table_header.elements_per_chunk : chunk.count == table_header.elements_per_chunk) &&
+			(chunk.size == raw_size || (compressed && chunk.size < raw_size));
+		elements_count += chunk.count;
+	}
+
+	if(!valid || elements_count != pBlock->count) {
+		LOG_ERR << "Binary deformer data block \"" << pBlock->name << "\" chunk table is corrupted !";
+		return false;
+	}
+
+	view.pData = mpData;
+	view.pChunks = pChunks;
+	view.element_size = pBlock->element_size;
+	view.elements_per_chunk = table_header.elements_per_chunk;
+	view.chunks_count = table_header.chunks_count;
+	view.count = static_cast<size_t>(pBlock->count);
+	return true;
+}
+
+bool BinaryDataReader::readBlockData(const BlockEntry* pBlock, void* pDst) const {
+	if(!(pBlock->flags & BLOCK_CHUNKED)) {
+		if(pBlock->size) {
+			std::memcpy(pDst, mpData + pBlock->offset, static_cast<size_t>(pBlock->size));
+		}
+		return true;
+	}
+
+	ChunkedBlockView view;
+	if(!getChunkedBlock(pBlock, view)) return false;
+
+	for(size_t c = 0; c < view.chunks_count; ++c) {
+		if(!view.decodeChunk(c, pDst)) {
+			LOG_ERR << "Binary deformer data block \"" << pBlock->name << "\" chunk " << c << " is corrupted !";
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BinaryDataReader::readString(const char* name, std::string& str) const {
+	const BlockEntry* pBlock = findTypedBlock(name, 1);
+	if(!pBlock) return false;
+
+	str.assign(reinterpret_cast<const char*>(mpData + pBlock->offset), static_cast<size_t>(pBlock->count));
+	return true;
+}
+
+void LazyChunkedBlock::attach(const BinaryDataReader& reader, const ChunkedBlockView& view, void* pTarget) {
+	mView = view;
+	mpTarget = pTarget;
+	mpOwner = reader.getOwner();
+	mpChunkFlags.reset(new std::once_flag[mView.chunks_count]);
+	mPendingChunks.store(mView.chunks_count, std::memory_order_release);
+
+	// Nothing keeps the payload alive after the read call, so decode now
+	if(!mpOwner) decodeAll();
+}
+
+void LazyChunkedBlock::reset() {
+	// NOTE: not safe against concurrent ensureAll() calls
+	mPendingChunks.store(0, std::memory_order_release);
+	mpChunkFlags.reset();
+	mpOwner.reset();
+	mpTarget = nullptr;
+	mView = ChunkedBlockView();
+}
+
+void LazyChunkedBlock::decodeChunk(size_t chunk_idx) const {
+	std::call_once(mpChunkFlags[chunk_idx], [&]() {
+		if(!mView.decodeChunk(chunk_idx, mpTarget)) {
+			LOG_ERR << "Binary deformer data chunk " << chunk_idx << " is corrupted ! Chunk elements are left invalid.";
+		}
+
+		if(mPendingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			mpOwner.reset();
+		}
+	});
+}
+
+void LazyChunkedBlock::decodeAll() const {
+	// Pool tasks must not wait for other tasks of the same pool
+	if(mView.chunks_count < 2 || SharedThreadPool::isWorkerThread()) {
+		for(size_t c = 0; c < mView.chunks_count; ++c) {
+			decodeChunk(c);
+		}
+		return;
+	}
+
+	ThreadPool& pool = SharedThreadPool::getInstance();
+	BS::multi_future<void> chunks = pool.submit_sequence(size_t(0), static_cast<size_t>(mView.chunks_count), [this](const size_t c) {
+		decodeChunk(c);
+	});
+	chunks.wait();
+}
+
+} // namespace Piston
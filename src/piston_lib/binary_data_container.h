@@ -0,0 +1,320 @@
+#ifndef PISTON_LIB_BINARY_DATA_CONTAINER_H_
+#define PISTON_LIB_BINARY_DATA_CONTAINER_H_
+
+#include "framework.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace Piston {
+
+// Versioned binary container for serialized deformer data.
+// Layout: Header | BlockEntry[blocks_count] | block data. Every block starts at kBlockAlignment boundary.
+// All values are little endian. Each block is a column of trivially copyable elements, so writing and reading
+// are plain memcpy's and readers can also view blocks in place.
+// Chunked blocks (large per point/per curve arrays) are split into fixed size chunks:
+// ChunkTableHeader | ChunkEntry[chunks_count] | chunk data. Every chunk is aligned and has its own checksum,
+// so chunks can be decoded independently, in parallel and only when needed. Chunks of compressed blocks are stored
+// compressed (see compressChunk()) unless compression doesn't make them smaller.
+namespace BinaryData {
+
+static constexpr char     kMagic[8] = {'P', 'S', 'T', 'N', 'B', 'I', 'N', '\0'};
+static constexpr uint32_t kFormatVersion = 3;       // 1: no chunked blocks, 2: no compressed blocks
+static constexpr size_t   kBlockAlignment = 64;
+static constexpr size_t   kMaxDataNameLength = 63;
+static constexpr size_t   kMaxBlockNameLength = 31;
+static constexpr uint32_t kDefaultChunkElements = 65536;
+
+enum BlockFlags: uint32_t {
+	BLOCK_CHUNKED       = 1u << 0,
+	BLOCK_COMPRESSED    = 1u << 1   // chunked blocks only
+};
+
+struct Header {
+	char     magic[8];
+	uint32_t format_version;
+	uint32_t blocks_count;
+	uint32_t data_version_major;
+	uint32_t data_version_minor;
+	uint32_t data_version_build;
+	uint32_t reserved;
+	uint64_t total_size;
+	char     data_name[kMaxDataNameLength + 1];
+};
+
+struct BlockEntry {
+	char     name[kMaxBlockNameLength + 1];
+	uint32_t element_size;
+	uint32_t flags;
+	uint64_t count;
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct ChunkTableHeader {
+	uint32_t chunks_count;
+	uint32_t elements_per_chunk;
+	uint64_t reserved;
+};
+
+struct ChunkEntry {
+	uint64_t offset;    // from the payload start
+	uint64_t size;      // stored bytes. Less than count * element_size if compressed
+	uint32_t count;     // elements
+	uint32_t checksum;  // of stored bytes
+};
+
+static_assert(sizeof(Header) == 104);
+static_assert(sizeof(BlockEntry) == 64);
+static_assert(sizeof(ChunkTableHeader) == 16);
+static_assert(sizeof(ChunkEntry) == 24);
+
+uint32_t checksum(const uint8_t* pData, size_t size);
+
+// Lossless codec for chunks of elements made of 32 bit words (delta, zigzag, byte shuffle, zero runs). Returns false and leaves
+// out empty if encoded data isn't smaller than the source.
+bool compressChunk(const uint8_t* pSrc, size_t element_size, size_t count, std::vector<uint8_t>& out);
+bool decompressChunk(const uint8_t* pSrc, size_t size, size_t element_size, size_t count, uint8_t* pDst);
+
+// Column element types. std::pair is not trivially copyable by the standard, but its layout is
+template<typename T> struct is_column_type: std::is_trivially_copyable<T> {};
+template<typename A, typename B> struct is_column_type<std::pair<A, B>>: std::integral_constant<bool, is_column_type<A>::value && is_column_type<B>::value> {};
+
+inline bool isLittleEndianHost() {
+	const uint16_t v = 0x0001;
+	return *reinterpret_cast<const uint8_t*>(&v) == 0x01;
+}
+
+inline size_t alignedSize(size_t size) {
+	return (size + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+}
+
+// Cheap check used to tell binary payloads from legacy bson ones
+inline bool hasBinaryHeader(const uint8_t* pData, size_t size) {
+	return pData && size >= sizeof(Header) && std::memcmp(pData, kMagic, sizeof(kMagic)) == 0;
+}
+
+template<typename T>
+struct ConstSpan {
+	const T* pData = nullptr;
+	size_t   count = 0;
+
+	const T* begin() const { return pData; }
+	const T* end() const { return pData + count; }
+	const T& operator[](size_t i) const { return pData[i]; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+};
+
+// Validated chunk table of a chunked block. Points into the payload memory
+struct ChunkedBlockView {
+	const uint8_t*      pData = nullptr;    // payload start
+	const ChunkEntry*   pChunks = nullptr;
+	uint32_t            element_size = 0;
+	uint32_t            elements_per_chunk = 0;
+	uint32_t            chunks_count = 0;
+	size_t              count = 0;
+
+	// Decodes chunk to its place in pDst block array. Returns false if chunk is corrupted.
+	bool decodeChunk(size_t chunk_idx, void* pDst) const;
+};
+
+} // namespace BinaryData
+
+
+class BinaryDataWriter {
+	public:
+		BinaryDataWriter(const std::string& data_name, uint32_t version_major, uint32_t version_minor, uint32_t version_build);
+
+		// Block data is referenced, not copied. Source containers must stay alive and unchanged until write() is done.
+		template<typename T>
+		void addBlock(const char* name, const std::vector<T>& vec) {
+			static_assert(BinaryData::is_column_type<T>::value, "Binary data column element must be trivially copyable");
+			addBlock(name, sizeof(T), vec.size(), vec.data());
+		}
+
+		// Block owned by the writer. Returned memory is filled by the caller
+		template<typename T>
+		T* allocBlock(const char* name, size_t count) {
+			static_assert(BinaryData::is_column_type<T>::value, "Binary data column element must be trivially copyable");
+			std::vector<uint8_t>& storage = ownStorage(sizeof(T) * count);
+			addBlock(name, sizeof(T), count, storage.data());
+			return reinterpret_cast<T*>(storage.data());
+		}
+
+		// Block split into chunks of elements_per_chunk elements. Referenced, not copied, same as addBlock().
+		// Compression is skipped for elements not made of 32 bit words.
+		template<typename T>
+		void addChunkedBlock(const char* name, const std::vector<T>& vec, uint32_t elements_per_chunk = BinaryData::kDefaultChunkElements, bool compressed = true) {
+			static_assert(BinaryData::is_column_type<T>::value, "Binary data column element must be trivially copyable");
+			addBlock(name, sizeof(T), vec.size(), vec.data(), elements_per_chunk, compressed && (sizeof(T) % sizeof(uint32_t)) == 0);
+		}
+
+		template<typename T>
+		void addValue(const char* name, const T& value) {
+			static_assert(std::is_trivially_copyable<T>::value, "Binary data value must be trivially copyable");
+			std::vector<uint8_t>& storage = ownStorage(sizeof(T));
+			std::memcpy(storage.data(), &value, sizeof(T));
+			addBlock(name, sizeof(T), 1, storage.data());
+		}
+
+		void addString(const char* name, const std::string& str);
+
+		size_t blocksCount() const { return mBlocks.size(); }
+
+		bool write(BSON& out) const;
+
+	private:
+		struct PendingBlock {
+			std::string name;
+			uint32_t    element_size;
+			size_t      count;
+			const void* pData;
+			uint32_t    chunk_elements;  // 0 for plain blocks
+			bool        compressed;
+		};
+
+		void addBlock(const char* name, size_t element_size, size_t count, const void* pData, uint32_t chunk_elements = 0, bool compressed = false);
+		std::vector<uint8_t>& ownStorage(size_t size);
+
+		std::string                         mDataName;
+		std::array<uint32_t, 3>             mVersion;
+		std::vector<PendingBlock>           mBlocks;
+		std::vector<std::vector<uint8_t>>   mOwnedStorage;  // allocBlock()/addValue()/addString() storage
+};
+
+
+// Reads blocks from binary data. Reader doesn't own the memory, it must outlive the reader and any span taken from it.
+// Optional owner keeps the memory alive for lazily decoded blocks (see LazyChunkedBlock).
+class BinaryDataReader {
+	public:
+		BinaryDataReader() = default;
+
+		// Validates header and block table
+		bool open(const uint8_t* pData, size_t size, std::shared_ptr<const void> pOwner = nullptr);
+
+		bool isOpen() const { return mpHeader != nullptr; }
+		const std::shared_ptr<const void>& getOwner() const { return mpOwner; }
+
+		std::string getDataName() const;
+		uint32_t getDataVersionMajor() const { return mpHeader ? mpHeader->data_version_major : 0; }
+		uint32_t getDataVersionMinor() const { return mpHeader ? mpHeader->data_version_minor : 0; }
+		uint32_t getDataVersionBuild() const { return mpHeader ? mpHeader->data_version_build : 0; }
+
+		bool hasBlock(const char* name) const { return findBlock(name) != nullptr; }
+		bool isChunkedBlock(const char* name) const;
+
+		// In place view of the block memory. Not available for chunked blocks
+		template<typename T>
+		bool getSpan(const char* name, BinaryData::ConstSpan<T>& span) const {
+			static_assert(BinaryData::is_column_type<T>::value, "Binary data column element must be trivially copyable");
+			const BinaryData::BlockEntry* pBlock = findTypedBlock(name, sizeof(T));
+			if(!pBlock || !isPlainBlock(pBlock)) return false;
+
+			span.pData = reinterpret_cast<const T*>(mpData + pBlock->offset);
+			span.count = static_cast<size_t>(pBlock->count);
+			return true;
+		}
+
+		template<typename T>
+		bool readBlock(const char* name, std::vector<T>& vec) const {
+			static_assert(BinaryData::is_column_type<T>::value, "Binary data column element must be trivially copyable");
+			const BinaryData::BlockEntry* pBlock = findTypedBlock(name, sizeof(T));
+			if(!pBlock) return false;
+
+			vec.resize(static_cast<size_t>(pBlock->count));
+			return readBlockData(pBlock, vec.data());
+		}
+
+		// Chunked blocks only
+		bool getChunkedBlock(const char* name, size_t element_size, BinaryData::ChunkedBlockView& view) const;
+
+		template<typename T>
+		bool readValue(const char* name, T& value) const {
+			static_assert(std::is_trivially_copyable<T>::value, "Binary data value must be trivially copyable");
+			const BinaryData::BlockEntry* pBlock = findTypedBlock(name, sizeof(T));
+			if(!pBlock || pBlock->count != 1) return false;
+
+			std::memcpy(&value, mpData + pBlock->offset, sizeof(T));
+			return true;
+		}
+
+		bool readString(const char* name, std::string& str) const;
+
+	private:
+		const BinaryData::BlockEntry* findBlock(const char* name) const;
+		const BinaryData::BlockEntry* findTypedBlock(const char* name, size_t element_size) const;
+		bool isPlainBlock(const BinaryData::BlockEntry* pBlock) const;
+		bool getChunkedBlock(const BinaryData::BlockEntry* pBlock, BinaryData::ChunkedBlockView& view) const;
+		bool readBlockData(const BinaryData::BlockEntry* pBlock, void* pDst) const;
+
+		const uint8_t*                  mpData = nullptr;
+		size_t                          mSize = 0;
+		const BinaryData::Header*       mpHeader = nullptr;
+		const BinaryData::BlockEntry*   mpBlocks = nullptr;
+		std::shared_ptr<const void>     mpOwner;
+};
+
+
+// Chunked block decoded on first access instead of at load time. Each chunk is decoded once, by whichever thread
+// needs it first. Payload owner is kept alive until all chunks are decoded. Without an owner block is decoded in attach().
+// Chunks failing checksum test are left default constructed (invalid binds) and reported. Chunks are decompressed in parallel.
+class LazyChunkedBlock {
+	public:
+		LazyChunkedBlock() = default;
+		LazyChunkedBlock(const LazyChunkedBlock&) = delete;
+		LazyChunkedBlock& operator=(const LazyChunkedBlock&) = delete;
+
+		// Resizes vec to block elements count. Vector must not be resized or written while pending.
+		// Plain blocks are read right away
+		template<typename T>
+		bool attach(const BinaryDataReader& reader, const char* name, std::vector<T>& vec) {
+			static_assert(BinaryData::is_column_type<T>::value, "Binary data column element must be trivially copyable");
+			reset();
+
+			// plain blocks of payloads written before chunking
+			if(!reader.isChunkedBlock(name)) return reader.readBlock(name, vec);
+
+			BinaryData::ChunkedBlockView view;
+			if(!reader.getChunkedBlock(name, sizeof(T), view)) return false;
+
+			vec.clear();
+			vec.resize(view.count);
+			attach(reader, view, vec.data());
+			return true;
+		}
+
+		bool isPending() const { return mPendingChunks.load(std::memory_order_acquire) != 0; }
+
+		// Decodes remaining chunks on the shared thread pool. Called from one of pool workers it decodes inline.
+		void ensureAll() const {
+			if(isPending()) decodeAll();
+		}
+
+		// Forgets pending chunks. Expected to be called before target vector is cleared
+		void reset();
+
+	private:
+		void attach(const BinaryDataReader& reader, const BinaryData::ChunkedBlockView& view, void* pTarget);
+		void decodeAll() const;
+		void decodeChunk(size_t chunk_idx) const;
+
+		BinaryData::ChunkedBlockView            mView;
+		void*                                   mpTarget = nullptr;
+		std::unique_ptr<std::once_flag[]>       mpChunkFlags;
+		mutable std::shared_ptr<const void>     mpOwner;   // released by the thread decoding the last chunk
+		mutable std::atomic<size_t>             mPendingChunks{0};
+};
+
+} // namespace Piston
+
+#endif // PISTON_LIB_BINARY_DATA_CONTAINER_H_
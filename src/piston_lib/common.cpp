@@ -1,14 +1,19 @@
 #include "common.h"
 #include "global_config.h"
+#include "os.h"
 #include "deformer_factory.h"
 #include "topology.h"
 #include "serializable_data.h"
 #include "simple_profiler.h"
 #include "base_curves_deformer.h"
+#include "thread_pool.h"
 #include "logging.h"
 
 #include <pxr/base/tf/token.h>
 #include <pxr/base/tf/pathUtils.h>
+#include <pxr/base/tf/fileUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/usd/sdf/assetPath.h>
 #include <pxr/base/vt/value.h>
 #include <pxr/base/vt/dictionary.h>
 #include <pxr/usd/usd/namespaceEditor.h>
@@ -63,6 +68,35 @@ static inline std::string uniqueDataName(const UsdPrimHandle* pPrim, const Seria
 	return s;
 }
 
+static constexpr const char* kSidecarFileExt = ".pstn";
+
+// Sidecar file goes to "<layer name>.piston" directory next to the edit target layer and is referenced relatively, so it
+// travels with the layer. Layers that are not saved on disk yet use the configured sidecar directory, if any.
+static bool getSidecarFilePaths(const pxr::UsdStageWeakPtr& pStage, const std::string& identifier, std::string& file_path, std::string& asset_path) {
+	const pxr::SdfLayerHandle layer = pStage->GetEditTarget().GetLayer();
+	if(!layer) return false;
+
+	const std::string layer_path = layer->GetRealPath();
+	if(!layer->IsAnonymous() && !layer_path.empty()) {
+		const std::string layer_name = pxr::TfStringGetBeforeSuffix(pxr::TfGetBaseName(layer_path));
+		const std::string relative_path = layer_name + ".piston/" + identifier + kSidecarFileExt;
+		file_path = pxr::TfStringCatPaths(pxr::TfGetPathName(layer_path), relative_path);
+		asset_path = "./" + relative_path;
+		return true;
+	}
+
+	static const auto& conf = GlobalConfig::getInstance();
+	const std::string sidecar_dir = conf.getDataSidecarDir();
+	if(sidecar_dir.empty()) return false;
+
+	// unsaved layers of different stages share this directory
+	std::ostringstream ss;
+	ss << identifier << "_" << std::hex << std::hash<std::string>()(layer->GetIdentifier()) << kSidecarFileExt;
+	file_path = pxr::TfStringCatPaths(sidecar_dir, ss.str());
+	asset_path = file_path;
+	return true;
+}
+
 static inline void bytes_to_hexstr(const BSON& bytes, std::string& hexstr) {
 	static const uint8_t lookup[]= "0123456789abcdef";
 	
@@ -135,8 +169,8 @@ const char *stringifyMemSize(size_t bytes) {
 		}
 	}
 
-	static char output[200];
-	sprintf(output, "%.02lf %s", dblBytes, suffix[i]);
+	static thread_local char output[200]; // returned pointer stays valid until next call on the same thread
+	snprintf(output, sizeof(output), "%.02lf %s", dblBytes, suffix[i]);
 	return output;
 }
 
@@ -228,11 +262,13 @@ void UsdPrimHandle::setSubdivLevel(uint8_t level) {
 }
 
 bool UsdPrimHandle::prepareDataIfNeeded(pxr::UsdTimeCode time_code, bool multi_threaded) const {
-	if(mpDeformer && !mpDeformer->deform(time_code, multi_threaded, true /* ignore velocities */)) {
+	if(!mpDeformer || mpDeformer->isOutputReady(time_code)) return true;
+	if(!mpDeformer->deform(time_code, multi_threaded, true /* ignore velocities */)) {
 		LOG_FTL << "Unable to execute " << mpDeformer->getName() << ".deform(...) for " << getPath() << " !!!";
 		return false;
 	}
-	return true;
+	// upstream output has to be authored before we read it
+	return mpDeformer->flush();
 }
 
 pxr::UsdGeomPrimvarsAPI UsdPrimHandle::getPrimvarsAPI() const { 
@@ -260,6 +296,7 @@ bool UsdPrimHandle::fetchAttributeValues(const std::string& attribute_name, pxr:
 
 	if(!prepareDataIfNeeded(time_code, true /* use threads */)) return false;
 
+	std::shared_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
 	if(!primVar.GetAttr().Get(&array, time_code)) {
 		LOG_ERR << "Error getting " << getPath() << " \"" << attribute_name << "\" values !";
 		return false;
@@ -298,6 +335,7 @@ bool UsdPrimHandle::getPoints(pxr::VtArray<pxr::GfVec3f>& array, pxr::UsdTimeCod
 
 	if(!prepareDataIfNeeded(time_code, true /* use threads */)) return false;
 
+	std::shared_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
 	if(!geom.GetPointsAttr().Get(&array, time_code)) {
 		LOG_ERR << "Error getting points from " << getPath() << " !";
 		return false;
@@ -316,35 +354,100 @@ template bool UsdPrimHandle::fetchAttributeValues(const std::string& attribute_n
 
 bool UsdPrimHandle::getDataFromBson(const pxr::SdfPath& prim_path, SerializableDeformerDataBase* pDeformerData) const {
 	assert(pDeformerData);
-	BSON v_bson;
-	if(!getBsonFromPrim(prim_path, uniqueDataName(this, pDeformerData), v_bson)) {
-		return false;
+	std::vector<DataRequest> requests = {{this, pDeformerData}};
+	getDataFromBson(prim_path, requests);
+	return requests.front().result;
+}
+
+bool UsdPrimHandle::writeDataToBson(const pxr::SdfPath& prim_path, SerializableDeformerDataBase* pDeformerData) const {
+	assert(pDeformerData);
+	std::vector<DataRequest> requests = {{this, pDeformerData}};
+	return writeDataToBson(prim_path, requests);
+}
+
+// Runs func(i) for every request. Concurrently unless there is a single one or we are already on a pool worker
+template<typename F>
+static void runForEachRequest(size_t requests_count, F&& func) {
+	if(requests_count > 1 && !SharedThreadPool::isWorkerThread()) {
+		BS::multi_future<void> tasks = SharedThreadPool::getInstance().submit_sequence(size_t(0), requests_count, func);
+		tasks.wait();
+		return;
 	}
 
-	bool result;
+	for(size_t i = 0; i < requests_count; ++i) {
+		func(i);
+	}
+}
 
-	{
-		ScopedTimeMeasure _t("UsdPrimHandle::getDataFromBson deserialize " + pDeformerData->jsonDataKey());
-		result = pDeformerData->deserialize(v_bson);
+void UsdPrimHandle::getDataFromBson(const pxr::SdfPath& prim_path, std::vector<DataRequest>& requests) {
+	struct Payload {
+		BSON                                v_bson;
+		std::shared_ptr<const MappedFile>   pFile;   // sidecar payload
+		bool                                fetched = false;
+	};
+
+	// Payloads are fetched serially as stage reads are cheap compared to decoding
+	std::vector<Payload> payloads(requests.size());
+	for(size_t i = 0; i < requests.size(); ++i) {
+		DataRequest& request = requests[i];
+		assert(request.pPrimHandle && request.pData);
+		request.result = false;
+
+		const std::string identifier = uniqueDataName(request.pPrimHandle, request.pData);
+		const std::string sidecar_path = request.pPrimHandle->getSidecarPathFromPrim(prim_path, identifier);
+		if(!sidecar_path.empty()) {
+			// file is mapped, not read. Only pages touched by deserialization are loaded. Mapping stays alive until
+			// chunked blocks are decoded
+			payloads[i].pFile = MappedFile::open(sidecar_path);
+			payloads[i].fetched = payloads[i].pFile != nullptr;
+		} else {
+			payloads[i].fetched = request.pPrimHandle->getBsonFromPrim(prim_path, identifier, payloads[i].v_bson);
+		}
 	}
 
-	return result;
+	runForEachRequest(requests.size(), [&requests, &payloads](const size_t i) {
+		const Payload& payload = payloads[i];
+		if(!payload.fetched) return;
+
+		SerializableDeformerDataBase* pDeformerData = requests[i].pData;
+		ScopedTimeMeasure _t("UsdPrimHandle::getDataFromBson deserialize " + pDeformerData->jsonDataKey());
+		if(payload.pFile) {
+			requests[i].result = pDeformerData->deserialize(payload.pFile->data(), payload.pFile->size(), payload.pFile);
+		} else {
+			requests[i].result = pDeformerData->deserialize(payload.v_bson);
+		}
+	});
 }
 
-bool UsdPrimHandle::writeDataToBson(const pxr::SdfPath& prim_path, SerializableDeformerDataBase* pDeformerData) const {
-	assert(pDeformerData);
-	BSON v_bson;
+bool UsdPrimHandle::writeDataToBson(const pxr::SdfPath& prim_path, std::vector<DataRequest>& requests) {
+	std::vector<BSON> payloads(requests.size());
 
-	{
-		ScopedTimeMeasure _t("UsdPrimHandle::writeDataToBson serialize " + pDeformerData->jsonDataKey());
+	runForEachRequest(requests.size(), [&requests, &payloads](const size_t i) {
+		SerializableDeformerDataBase* pDeformerData = requests[i].pData;
+		assert(pDeformerData);
 
-		if(!pDeformerData->serialize(v_bson)) {
+		ScopedTimeMeasure _t("UsdPrimHandle::writeDataToBson serialize " + pDeformerData->jsonDataKey());
+		requests[i].result = pDeformerData->serialize(payloads[i]);
+		if(!requests[i].result) {
 			LOG_ERR << "Error serializing data " << pDeformerData->jsonDataKey() << " !!!";
-			return false;
 		}
+	});
+
+	// Stage writes are exclusive anyway
+	bool result = true;
+	for(size_t i = 0; i < requests.size(); ++i) {
+		DataRequest& request = requests[i];
+		if(!request.result) {
+			result = false;
+			continue;
+		}
+
+		assert(request.pPrimHandle);
+		request.result = request.pPrimHandle->setBsonToPrim(prim_path, uniqueDataName(request.pPrimHandle, request.pData), payloads[i]);
+		result = result && request.result;
 	}
 
-	return setBsonToPrim(prim_path, uniqueDataName(this, pDeformerData), v_bson);
+	return result;
 }
 
 bool UsdPrimHandle::getBsonFromPrim(const pxr::SdfPath& prim_path, const std::string& identifier, BSON& v_bson) const {
@@ -354,6 +457,7 @@ bool UsdPrimHandle::getBsonFromPrim(const pxr::SdfPath& prim_path, const std::st
 		return false;
 	}
 
+	std::shared_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
 	auto pStage = getPrim().GetStage();
 	assert(pStage); 
 
@@ -375,9 +479,27 @@ bool UsdPrimHandle::getBsonFromPrim(const pxr::SdfPath& prim_path, const std::st
 		}
 
 		auto _v = data_prim.GetCustomDataByKey(key_path);
-		hex_string_to_bson(_v.Get<std::string>(), v_bson);
+		if(_v.IsHolding<BSON>()) {
+			v_bson = _v.UncheckedGet<BSON>();
+		} else if(_v.IsHolding<std::string>()) {
+			// legacy hex encoded payload
+			hex_string_to_bson(_v.UncheckedGet<std::string>(), v_bson);
+		} else {
+			LOG_ERR << "Error getting bson from prim " << data_prim << ". Custom data \"" << identifier << "\" type " << _v.GetTypeName() << " is unsupported!";
+			return false;
+		}
 	} else {
-		pxr::UsdAttribute attr = data_prim.HasAttribute(key_path) ? data_prim.GetAttribute(key_path):  data_prim.CreateAttribute(key_path, pxr::SdfValueTypeNames->UCharArray);
+		if(!data_prim.HasAttribute(key_path)) {
+			// attribute creation authors the stage
+			stage_lock.unlock();
+			{
+				std::unique_lock<std::shared_mutex> stage_write_lock(getStageAccessMutex());
+				if(!data_prim.HasAttribute(key_path)) data_prim.CreateAttribute(key_path, pxr::SdfValueTypeNames->UCharArray);
+			}
+			stage_lock.lock();
+		}
+
+		pxr::UsdAttribute attr = data_prim.GetAttribute(key_path);
 		if(attr.GetTypeName() != pxr::SdfValueTypeNames->UCharArray) {
 			LOG_ERR << "Error getting bson data to prim " << data_prim << ". Attribute type " << attr.GetTypeName() << " is unsupported!";
 			return false;
@@ -389,6 +511,30 @@ bool UsdPrimHandle::getBsonFromPrim(const pxr::SdfPath& prim_path, const std::st
 	return true;
 }
 
+std::string UsdPrimHandle::getSidecarPathFromPrim(const pxr::SdfPath& prim_path, const std::string& identifier) const {
+	if(!isValid()) return {};
+
+	std::shared_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
+	auto pStage = getPrim().GetStage();
+	assert(pStage);
+
+	pxr::UsdPrim data_prim = pStage->GetPrimAtPath(prim_path);
+	if(!data_prim.IsValid()) return {};
+
+	pxr::UsdAttribute attr = data_prim.GetAttribute(pxr::TfToken(identifier));
+	if(!attr.IsValid() || attr.GetTypeName() != pxr::SdfValueTypeNames->Asset) return {};
+
+	pxr::SdfAssetPath asset_path;
+	if(!attr.Get(&asset_path) || asset_path.GetAssetPath().empty()) return {};
+
+	if(asset_path.GetResolvedPath().empty()) {
+		LOG_WRN << "Unable to resolve sidecar data file \"" << asset_path.GetAssetPath() << "\" of prim " << data_prim << ". Data will be rebuilt !";
+		return {};
+	}
+
+	return asset_path.GetResolvedPath();
+}
+
 void UsdPrimHandle::clearPrimBson(const pxr::SdfPath& prim_path, const std::string& identifier) const {
 	auto pStage = getPrim().GetStage();
 	assert(pStage); 
@@ -447,6 +593,11 @@ std::string getStageName(pxr::UsdStageRefPtr pStage) {
 	return pxr::TfGetBaseName(identifier);
 }
 
+std::shared_mutex& getStageAccessMutex() {
+	static std::shared_mutex sStageAccessMutex;
+	return sStageAccessMutex;
+}
+
 bool clearPistonDataFromStage(pxr::UsdStageRefPtr pStage) {
 	assert(pStage);
 	if(!pStage) {
@@ -477,6 +628,7 @@ bool UsdPrimHandle::setBsonToPrim(const pxr::SdfPath& prim_path, const std::stri
 		return false;
 	}
 
+	std::unique_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
 	auto pStage = getPrim().GetStage();
 	assert(pStage); 
 
@@ -491,18 +643,54 @@ bool UsdPrimHandle::setBsonToPrim(const pxr::SdfPath& prim_path, const std::stri
 	const pxr::TfToken key_path(identifier);
 
 	static auto const& conf = GlobalConfig::getInstance();
-	const bool storeAsMetadata = conf.getDataStorageMethod() == GlobalConfig::DataToPrimStorageMethod::METADATA;
+	GlobalConfig::DataToPrimStorageMethod storage_method = conf.getDataStorageMethod();
 
-	if( storeAsMetadata) {
+	std::string sidecar_file_path, sidecar_asset_path;
+	if((storage_method == GlobalConfig::DataToPrimStorageMethod::SIDECAR) && !getSidecarFilePaths(pStage, identifier, sidecar_file_path, sidecar_asset_path)) {
+		LOG_WRN << "Layer " << pStage->GetEditTarget().GetLayer()->GetIdentifier() << " is not saved on disk and no sidecar directory is set. Storing \"" << identifier << "\" as attribute.";
+		storage_method = GlobalConfig::DataToPrimStorageMethod::ATTRIBUTE;
+	}
+
+	// attribute written with other storage method has a different type
+	auto remove_attr_of_other_type = [&](const pxr::SdfValueTypeName& type_name) {
+		if(data_prim.HasAttribute(key_path) && (data_prim.GetAttribute(key_path).GetTypeName() != type_name)) {
+			data_prim.RemoveProperty(key_path);
+		}
+	};
+
+	if(storage_method == GlobalConfig::DataToPrimStorageMethod::METADATA) {
 		// store deformer data as metadata
 		if(data_prim.HasCustomDataKey(key_path)) {
 			data_prim.ClearCustomDataByKey(key_path);
 		}
 
+		// sidecar reference takes precedence on read
+		remove_attr_of_other_type(pxr::SdfValueTypeNames->UCharArray);
+
+	#if BSON_USES_PXR_VTARRAY
+		// raw bytes. No need for hex encoding, which doubles the payload size
+		const pxr::VtValue _v(v_bson);
+	#else
 		const pxr::VtValue _v(bson_to_hex_string(v_bson));
+	#endif
 		data_prim.SetCustomDataByKey(key_path, _v);
+	} else if(storage_method == GlobalConfig::DataToPrimStorageMethod::SIDECAR) {
+		// store deformer data in external file referenced by asset path attribute
+		if(!pxr::TfMakeDirs(pxr::TfGetPathName(sidecar_file_path), -1, true /* exist ok */)) {
+			LOG_ERR << "Error creating sidecar data directory for \"" << sidecar_file_path << "\" !";
+			return false;
+		}
+
+		if(!writeFileReplace(sidecar_file_path, reinterpret_cast<const uint8_t*>(v_bson.data()), v_bson.size())) {
+			return false;
+		}
+
+		remove_attr_of_other_type(pxr::SdfValueTypeNames->Asset);
+		pxr::UsdAttribute attr = data_prim.HasAttribute(key_path) ? data_prim.GetAttribute(key_path) : data_prim.CreateAttribute(key_path, pxr::SdfValueTypeNames->Asset);
+		attr.Set(pxr::SdfAssetPath(sidecar_asset_path));
 	} else {
 		// store deformer data as attribute
+		remove_attr_of_other_type(pxr::SdfValueTypeNames->UCharArray);
 		pxr::UsdAttribute attr = data_prim.HasAttribute(key_path) ? data_prim.GetAttribute(key_path):  data_prim.CreateAttribute(key_path, pxr::SdfValueTypeNames->UCharArray);
 		if(attr.GetTypeName() != pxr::SdfValueTypeNames->UCharArray) {
 			LOG_ERR << "Error writing bson data to prim " << data_prim << ". Attribute type " << attr.GetTypeName() << "is unsupported!";
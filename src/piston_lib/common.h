@@ -22,6 +22,7 @@
 #include <iostream>
 #include <vector>
 #include <type_traits>
+#include <shared_mutex>
 
 
 using json = nlohmann::json;
@@ -103,6 +104,9 @@ inline bool isSameType(const pxr::UsdPrim& prim_l, const pxr::UsdPrim& prim_r) {
 }
 
 bool clearPistonDataFromStage(pxr::UsdStageRefPtr pStage);
+
+// Guards USD stage reads (shared) and writes (exclusive) when several deformers are evaluated concurrently
+std::shared_mutex& getStageAccessMutex();
 bool clearPistonDataFromPrim(pxr::UsdStageRefPtr pStage, const pxr::SdfPath& prim_path);
 
 class SerializableDeformerDataBase;
@@ -123,6 +127,9 @@ class UsdPrimHandle {
 		bool isMeshGeoPrim() const { return Piston::isMeshGeoPrim(getPrim()); }
 		bool isBasisCurvesGeoPrim() const { return Piston::isBasisCurvesGeoPrim(getPrim()); }
 
+		// Handle data is produced by an upstream deformer
+		bool isDeformerOutput() const { return mpDeformer != nullptr; }
+
 		void setSubdivLevel(uint8_t level);
 		uint8_t getSubdivLevel() const { return mSubdivLevel; }
 
@@ -135,13 +142,29 @@ class UsdPrimHandle {
 		const std::string& getRestAttrName() const { return mRestAttrName; }
 
 
+		// Deformer data stored on the data prim under the identifier of pPrimHandle
+		struct DataRequest {
+			const UsdPrimHandle*            pPrimHandle;
+			SerializableDeformerDataBase*   pData;
+			bool                            result = false;
+		};
+
 		bool getDataFromBson(const pxr::SdfPath& prim_path, SerializableDeformerDataBase* pDeformerData) const;
 		bool writeDataToBson(const pxr::SdfPath& prim_path, SerializableDeformerDataBase* pDeformerData) const;
 
+		// Independent data objects are decoded/encoded concurrently on the shared thread pool. Stage access stays serial.
+		// Sets result of every request.
+		static void getDataFromBson(const pxr::SdfPath& prim_path, std::vector<DataRequest>& requests);
+		static bool writeDataToBson(const pxr::SdfPath& prim_path, std::vector<DataRequest>& requests);
+
 		bool getBsonFromPrim(const pxr::SdfPath& prim_path, const std::string& identifier, BSON& v_bson) const;
 		bool setBsonToPrim(const pxr::SdfPath& prim_path, const std::string& identifier, const BSON& v_bson) const;
 		void clearPrimBson(const pxr::SdfPath& prim_path, const std::string& identifier) const;
 
+		// Resolved path of the sidecar data file referenced by data prim. Empty if the data isn't stored in a sidecar file
+		// or the file can't be resolved, so the data gets rebuilt
+		std::string getSidecarPathFromPrim(const pxr::SdfPath& prim_path, const std::string& identifier) const;
+
 		bool positionsMightBeTimeVarying() const;
 		bool hasPositionsTimeSamples(pxr::UsdTimeCode time_from, pxr::UsdTimeCode time_to) const;
 
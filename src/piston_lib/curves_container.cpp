@@ -11,15 +11,22 @@ PxrCurvesContainer::PxrCurvesContainer():mSpace(PxrCurvesContainer::Space::UNKNO
 
 }
 
-PxrCurvesContainer::PxrCurvesContainer(PxrCurvesContainer& other) {
+PxrCurvesContainer::PxrCurvesContainer(const PxrCurvesContainer& other) {
 	mSpace = other.mSpace;
 	mCurvesCount = other.mCurvesCount;
+	mCurveVertexCounts = other.mCurveVertexCounts;
 	mCurveOffsets = other.mCurveOffsets;
 	mCurveRootPositions = other.mCurveRootPositions;
 	mCurveVectors = other.mCurveVectors;
+	mTempCurvePoints = other.mTempCurvePoints;
+	mRestCurvePoints = other.mRestCurvePoints;
 	mLastUpdateTimeCode = other.mLastUpdateTimeCode;
 }
 
+PxrCurvesContainer::UniquePtr PxrCurvesContainer::clone() const {
+	return PxrCurvesContainer::UniquePtr(new PxrCurvesContainer(*this));
+}
+
 bool PxrCurvesContainer::init(const UsdPrimHandle& prim_handle, const std::string& rest_attr_name, pxr::UsdTimeCode rest_time_code) {
 	mSpace = Space::UNKNOWN;
 
@@ -36,6 +36,9 @@ class PxrCurvesContainer {
 		static UniquePtr create();
 		static UniquePtr create(const UsdPrimHandle& prim_handle, const std::string& rest_attr_name, pxr::UsdTimeCode rest_time_code = pxr::UsdTimeCode::Default());
 
+		// Deep copy. Used to give each concurrent evaluation its own live state
+		UniquePtr clone() const;
+
 		bool init(const UsdPrimHandle& prim_handle, const std::string& rest_attr_name, pxr::UsdTimeCode reference_time_code);
 		bool update(const UsdPrimHandle& prim_handle, pxr::UsdTimeCode time_code, bool force);
 
@@ -61,7 +64,7 @@ class PxrCurvesContainer {
 
 	private:
 		PxrCurvesContainer();
-		PxrCurvesContainer(PxrCurvesContainer& other);
+		PxrCurvesContainer(const PxrCurvesContainer& other);
 	
 	private:
 		Space 									mSpace = Space::UNKNOWN;
@@ -2,62 +2,97 @@
 #include "curves_container_utils.h"
 #include "guide_curves_container.h"
 
+#include <algorithm>
+
 namespace Piston {
 
-bool CurveEnclosureFinder::findEnclosingCurveTriplet( const USDCurveKDTree& kdTree, const pxr::VtArray<pxr::GfVec3f>& allPoints, const pxr::VtArray<int>& curveVertexCounts,
+CurveInfiniteLines::CurveInfiniteLines(const pxr::VtArray<pxr::GfVec3f>& points, const pxr::VtArray<int>& curveVertexCounts, const std::vector<uint32_t>& curveOffsets) {
+    assert(curveOffsets.size() >= curveVertexCounts.size());
+
+    mLines.resize(curveVertexCounts.size());
+    for (size_t cIdx = 0; cIdx < curveVertexCounts.size(); ++cIdx) {
+        const size_t numPoints = static_cast<size_t>(std::max(0, curveVertexCounts[cIdx]));
+        auto& lines = mLines[cIdx];
+
+        if (numPoints == 0) {
+            lines[0] = InfiniteCurveLine{cIdx, pxr::GfVec3f(0.f), pxr::GfVec3f(0, 1, 0)};
+            lines[1] = lines[0];
+            continue;
+        }
+
+        const size_t offset = curveOffsets[cIdx];
+        // Evaluating line at the curve end itself selects that end's line
+        lines[0] = evaluateInfiniteLine(points, offset, numPoints, cIdx, points[offset]);
+        lines[1] = evaluateInfiniteLine(points, offset, numPoints, cIdx, points[offset + numPoints - 1]);
+        if (numPoints < 2) {
+            lines[1] = lines[0];
+        }
+    }
+}
+
+namespace {
+
+// Candidate line projected onto the 2D cutting plane around P
+struct ProjectedLine {
+    size_t curveIndex;
+    Vec2D origin;
+    Vec2D direction;
+};
+
+// Builds an orthonormal projection plane driven by the first candidate line direction and projects all candidates onto it
+void projectCandidateLines(const std::vector<const InfiniteCurveLine*>& candidateLines, const pxr::GfVec3f& P, std::vector<ProjectedLine>& outLines) {
+    pxr::GfVec3f forward = candidateLines[0]->direction;
+    pxr::GfVec3f up = (std::abs(forward[2]) < 0.9f) ? pxr::GfVec3f(0, 0, 1) : pxr::GfVec3f(1, 0, 0);
+    pxr::GfVec3f right = pxr::GfCross(forward, up).GetNormalized();
+    up = pxr::GfCross(right, forward).GetNormalized();
+
+    outLines.resize(candidateLines.size());
+    for (size_t i = 0; i < candidateLines.size(); ++i) {
+        const InfiniteCurveLine* pLine = candidateLines[i];
+        outLines[i].curveIndex = pLine->curveIndex;
+        outLines[i].origin = Vec2D{ pxr::GfDot(pLine->origin - P, right), pxr::GfDot(pLine->origin - P, up) };
+        outLines[i].direction = Vec2D{ pxr::GfDot(pLine->direction, right), pxr::GfDot(pLine->direction, up) };
+    }
+}
+
+}
+
+bool CurveEnclosureFinder::findEnclosingCurveTriplet(const USDCurveKDTree& kdTree, const CurveInfiniteLines& curveLines,
     const pxr::GfVec3f& P, std::vector<size_t>& outCurveIndices, std::optional<size_t> ignore_curve_id) {
 
     // 1. Gather a localized neighborhood of nearby candidate curve segments using your K-D tree.
     // We request a pool of candidates (e.g., K=12) to test combinations.
     auto neighbors = kdTree.findKNearestPoints(P, 12, ignore_curve_id);
     
-    std::vector<InfiniteCurveLine> candidateLines;
-    std::vector<size_t> uniqueCurves;
+    std::vector<const InfiniteCurveLine*> candidateLines;
+    candidateLines.reserve(neighbors.size());
 
-    // Extract the raw tangent vectors for unique nearby curves
+    // Extract the cached tangent lines for unique nearby curves
     for (const auto& neighbor : neighbors) {
         size_t cIdx = neighbor.first.curveIndex;
-        if (std::find(uniqueCurves.begin(), uniqueCurves.end(), cIdx) != uniqueCurves.end()) {
+        if (std::find_if(candidateLines.begin(), candidateLines.end(), [cIdx](const InfiniteCurveLine* pLine) { return pLine->curveIndex == cIdx; }) != candidateLines.end()) {
             continue; // Skip duplicates
         }
-        uniqueCurves.push_back(cIdx);
-
-        // Reconstruct the start offset of this specific curve in the flat OpenUSD array
-        size_t offset = 0;
-        for (size_t i = 0; i < cIdx; ++i) offset += curveVertexCounts[i];
-
-        candidateLines.push_back(evaluateInfiniteLine(allPoints, offset, curveVertexCounts[cIdx], cIdx, P));
+        candidateLines.push_back(&curveLines.getLine(cIdx, P));
     }
 
     if (candidateLines.size() < 3) return false;
 
-    // 2. Determine a dynamic projection plane based on the primary direction of our first candidate
-    pxr::GfVec3f forward = candidateLines[0].direction;
-    pxr::GfVec3f up = (std::abs(forward[2]) < 0.9f) ? pxr::GfVec3f(0, 0, 1) : pxr::GfVec3f(1, 0, 0);
-    pxr::GfVec3f right = pxr::GfCross(forward, up).GetNormalized();
-    up = pxr::GfCross(right, forward).GetNormalized();
-
-    // Project 3D positions into a local 2D coordinate system relative to P
-    auto project2D = [&](const pxr::GfVec3f& point3D) -> Vec2D {
-        return Vec2D{ pxr::GfDot(point3D - P, right), pxr::GfDot(point3D - P, up) };
-    };
+    // 2. Project candidates into a local 2D coordinate system relative to P. In our local space, point P is the origin
+    std::vector<ProjectedLine> lines;
+    projectCandidateLines(candidateLines, P, lines);
 
-    Vec2D p2D = { 0.0f, 0.0f }; // In our local space, point P is the origin
+    Vec2D p2D = { 0.0f, 0.0f };
 
     // 3. Permute triplets of unique curves to see which combination encloses P
-    for (size_t i = 0; i < candidateLines.size(); ++i) {
-        for (size_t j = i + 1; j < candidateLines.size(); ++j) {
-            for (size_t k = j + 1; k < candidateLines.size(); ++k) {
-                
-                std::vector<Vec2D> lineOrigins = { project2D(candidateLines[i].origin), project2D(candidateLines[j].origin), project2D(candidateLines[k].origin) };
-                std::vector<Vec2D> lineDirs = { 
-                    Vec2D{ pxr::GfDot(candidateLines[i].direction, right), pxr::GfDot(candidateLines[i].direction, up) },
-                    Vec2D{ pxr::GfDot(candidateLines[j].direction, right), pxr::GfDot(candidateLines[j].direction, up) },
-                    Vec2D{ pxr::GfDot(candidateLines[k].direction, right), pxr::GfDot(candidateLines[k].direction, up) }
-                };
+    for (size_t i = 0; i < lines.size(); ++i) {
+        for (size_t j = i + 1; j < lines.size(); ++j) {
+            for (size_t k = j + 1; k < lines.size(); ++k) {
+                const std::array<Vec2D, 3> lineOrigins = { lines[i].origin, lines[j].origin, lines[k].origin };
+                const std::array<Vec2D, 3> lineDirs = { lines[i].direction, lines[j].direction, lines[k].direction };
 
                 if (isPointInsideTriangleLines(p2D, lineOrigins, lineDirs)) {
-                    outCurveIndices = { candidateLines[i].curveIndex, candidateLines[j].curveIndex, candidateLines[k].curveIndex };
+                    outCurveIndices = { lines[i].curveIndex, lines[j].curveIndex, lines[k].curveIndex };
                     return true; // Match found!
                 }
             }
@@ -68,69 +103,48 @@ bool CurveEnclosureFinder::findEnclosingCurveTriplet( const USDCurveKDTree& kdTr
 }
 
 
-bool CurveEnclosureFinder::findEnclosingTripletWithTarget(const USDCurveKDTree& kdTree, const pxr::VtArray<pxr::GfVec3f>& allPoints, const pxr::VtArray<int>& curveVertexCounts,
+bool CurveEnclosureFinder::findEnclosingTripletWithTarget(const USDCurveKDTree& kdTree, const CurveInfiniteLines& curveLines,
     const pxr::GfVec3f& P, size_t targetCurveIndex, std::vector<size_t>& outCurveIndices, std::optional<size_t> ignore_curve_id) {
         
     // 1. Safety Check: Ensure target index is valid and not explicitly ignored
-    if (targetCurveIndex >= curveVertexCounts.size()) return false;
+    if (targetCurveIndex >= curveLines.getCurvesCount()) return false;
     if (ignore_curve_id.has_value() && targetCurveIndex == *ignore_curve_id) return false;
 
-    std::vector<InfiniteCurveLine> candidateLines;
-    std::vector<size_t> uniqueCurves;
+    std::vector<const InfiniteCurveLine*> candidateLines;
 
     // 2. Lock the required target curve as our absolute first candidate slot
-    uniqueCurves.push_back(targetCurveIndex);
-    size_t targetOffset = calculateCurveOffset(curveVertexCounts, targetCurveIndex);
-    candidateLines.push_back(evaluateInfiniteLine(allPoints, targetOffset, curveVertexCounts[targetCurveIndex], targetCurveIndex, P));
+    candidateLines.push_back(&curveLines.getLine(targetCurveIndex, P));
 
     // 3. Gather localized neighboring curves using K-D Tree
     auto neighbors = kdTree.findKNearestPoints(P, 15, ignore_curve_id);
+    candidateLines.reserve(neighbors.size() + 1);
     
     for (const auto& neighbor : neighbors) {
         size_t cIdx = neighbor.first.curveIndex;
         
         // Skip the target curve (already added) and duplicates
-        if (std::find(uniqueCurves.begin(), uniqueCurves.end(), cIdx) != uniqueCurves.end()) {
+        if (std::find_if(candidateLines.begin(), candidateLines.end(), [cIdx](const InfiniteCurveLine* pLine) { return pLine->curveIndex == cIdx; }) != candidateLines.end()) {
             continue; 
         }
-        uniqueCurves.push_back(cIdx);
-
-        size_t offset = calculateCurveOffset(curveVertexCounts, cIdx);
-        candidateLines.push_back(evaluateInfiniteLine(allPoints, offset, curveVertexCounts[cIdx], cIdx, P));
+        candidateLines.push_back(&curveLines.getLine(cIdx, P));
     }
 
     if (candidateLines.size() < 3) return false;
 
-    // 4. Calculate an orthonormal projection plane driven by our locked target curve's tangent alignment
-    pxr::GfVec3f forward = candidateLines[0].direction; 
-    pxr::GfVec3f up = (std::abs(forward[2]) < 0.9f) ? pxr::GfVec3f(0, 0, 1) : pxr::GfVec3f(1, 0, 0);
-    pxr::GfVec3f right = pxr::GfCross(forward, up).GetNormalized();
-    up = pxr::GfCross(right, forward).GetNormalized();
+    // 4. Project onto a plane driven by our locked target curve's tangent alignment. Point P acts as origin on the projected cutting plane
+    std::vector<ProjectedLine> lines;
+    projectCandidateLines(candidateLines, P, lines);
 
-    auto project2D = [&](const pxr::GfVec3f& point3D) -> Vec2D {
-        return Vec2D{ pxr::GfDot(point3D - P, right), pxr::GfDot(point3D - P, up) };
-    };
-
-    Vec2D p2D = { 0.0f, 0.0f }; // Point P acts as origin on the projected cutting plane
+    Vec2D p2D = { 0.0f, 0.0f };
 
     // 5. Permute pairs of secondary neighbor lines to close the triangle with the target line at index 0
-    for (size_t j = 1; j < candidateLines.size(); ++j) {
-        for (size_t k = j + 1; k < candidateLines.size(); ++k) {
-            
-            std::vector<Vec2D> lineOrigins = { 
-                project2D(candidateLines[0].origin), 
-                project2D(candidateLines[j].origin), 
-                project2D(candidateLines[k].origin) 
-            };
-            
-            std::vector<Vec2D> lineDirs = { 
-                Vec2D{ pxr::GfDot(candidateLines[0].direction, right), pxr::GfDot(candidateLines[0].direction, up) },
-                Vec2D{ pxr::GfDot(candidateLines[j].direction, right), pxr::GfDot(candidateLines[j].direction, up) },
-                Vec2D{ pxr::GfDot(candidateLines[k].direction, right), pxr::GfDot(candidateLines[k].direction, up) }
-            };
+    for (size_t j = 1; j < lines.size(); ++j) {
+        for (size_t k = j + 1; k < lines.size(); ++k) {
+            const std::array<Vec2D, 3> lineOrigins = { lines[0].origin, lines[j].origin, lines[k].origin };
+            const std::array<Vec2D, 3> lineDirs = { lines[0].direction, lines[j].direction, lines[k].direction };
 
             if (isPointInsideTriangleLines(p2D, lineOrigins, lineDirs)) {
-                outCurveIndices = { candidateLines[0].curveIndex, candidateLines[j].curveIndex, candidateLines[k].curveIndex };
+                outCurveIndices = { lines[0].curveIndex, lines[j].curveIndex, lines[k].curveIndex };
                 return true; // Enclosure containing target verified successfully
             }
         }
@@ -139,21 +153,19 @@ bool CurveEnclosureFinder::findEnclosingTripletWithTarget(const USDCurveKDTree&
     return false; // No valid pairing enclosing P could be completed using this specific target curve
 }
 
-CurveBarycentricCoords AdvancedCurveBarycentricSolver::computeWeightsAndUFromTriplet(const pxr::GfVec3f& P, const std::array<size_t, 3>& curveTriplet, const pxr::VtArray<pxr::GfVec3f>& allPoints, const pxr::VtArray<int>& curveVertexCounts)  {
+CurveBarycentricCoords AdvancedCurveBarycentricSolver::computeWeightsAndUFromTriplet(const pxr::GfVec3f& P, const std::array<size_t, 3>& curveTriplet, const CurveInfiniteLines& curveLines)  {
     CurveBarycentricCoords output;
     output.curveIndices = curveTriplet;
 
     // 1. Safety Check: Verify indices exist within bounds
     for (size_t cIdx : curveTriplet) {
-        if (cIdx >= curveVertexCounts.size()) return output;
+        if (cIdx >= curveLines.getCurvesCount()) return output;
     }
 
-    // 2. Dynamically extract geometry data and construct the 3D infinite lines
+    // 2. Fetch the cached 3D infinite lines
     std::array<InfiniteCurveLine, 3> chosenCurves;
     for (int i = 0; i < 3; ++i) {
-        size_t cIdx = curveTriplet[i];
-        size_t offset = calculateCurveOffset(curveVertexCounts, cIdx);
-        chosenCurves[i] = evaluateInfiniteLine(allPoints, offset, curveVertexCounts[cIdx], cIdx, P);
+        chosenCurves[i] = curveLines.getLine(curveTriplet[i], P);
     }
 
     // 3. Dynamically generate the projection plane based on the first curve's trajectory vector
@@ -196,12 +208,8 @@ CurveBarycentricCoords AdvancedCurveBarycentricSolver::computeWeightsAndUFromTri
 
     // 6. Compute the Longitudinal U Coordinate Mapping
     for (int i = 0; i < 3; ++i) {
-        size_t cIdx = curveTriplet[i];
-        size_t offset = calculateCurveOffset(curveVertexCounts, cIdx);
-        int numPoints = curveVertexCounts[cIdx];
-
-        pxr::GfVec3f usdRoot = allPoints[offset];
-        pxr::GfVec3f usdTip = allPoints[offset + numPoints - 1];
+        const pxr::GfVec3f& usdRoot = curveLines.getRootPoint(curveTriplet[i]);
+        const pxr::GfVec3f& usdTip = curveLines.getTipPoint(curveTriplet[i]);
         
         float totalCurveLength = (usdTip - usdRoot).GetLength();
         if (totalCurveLength < 1e-6f) totalCurveLength = 1.0f;
@@ -53,16 +53,30 @@ inline InfiniteCurveLine evaluateInfiniteLine(const pxr::VtArray<pxr::GfVec3f>&
     return line;
 }
 
-// Helper to calculate the flat memory offset of a given curve index
-inline size_t calculateCurveOffset(const pxr::VtArray<int>& curveVertexCounts, size_t targetIndex) {
-    size_t offset = 0;
-    for (size_t i = 0; i < targetIndex; ++i) {
-        offset += curveVertexCounts[i];
-    }
-    return offset;
 }
 
-}
+// Per curve root and tip infinite lines. Built once from curves prefix offsets so enclosure queries don't need to
+// re-evaluate curve lines (or curve offsets) for every tested point.
+// Note: CurveEnclosureFinder and AdvancedCurveBarycentricSolver are not used by any deformer binder yet. LHS mode
+// binds against own guide plus two nearest guide roots (see GuideCurvesDeformer::buildDeformerDataLHSMode)
+class CurveInfiniteLines {
+    public:
+        CurveInfiniteLines(const pxr::VtArray<pxr::GfVec3f>& points, const pxr::VtArray<int>& curveVertexCounts, const std::vector<uint32_t>& curveOffsets);
+
+        size_t getCurvesCount() const { return mLines.size(); }
+
+        // Same as evaluateInfiniteLine(): line at curve end (root or tip) closest to P
+        const InfiniteCurveLine& getLine(size_t curveIndex, const pxr::GfVec3f& P) const {
+            const auto& lines = mLines[curveIndex];
+            return ((lines[0].origin - P).GetLengthSq() <= (lines[1].origin - P).GetLengthSq()) ? lines[0] : lines[1];
+        }
+
+        const pxr::GfVec3f& getRootPoint(size_t curveIndex) const { return mLines[curveIndex][0].origin; }
+        const pxr::GfVec3f& getTipPoint(size_t curveIndex) const { return mLines[curveIndex][1].origin; }
+
+    private:
+        std::vector<std::array<InfiniteCurveLine, 2>> mLines; // <root line, tip line> pairs
+};
 
 class USDCurveKDTree;
 
@@ -76,8 +90,7 @@ class CurveEnclosureFinder {
         // Main solver: Finds a triplet of curves that enclose point P inside their volume
         static bool findEnclosingCurveTriplet(
             const USDCurveKDTree& kdTree,
-            const pxr::VtArray<pxr::GfVec3f>& allPoints,
-            const pxr::VtArray<int>& curveVertexCounts,
+            const CurveInfiniteLines& curveLines,
             const pxr::GfVec3f& P,
             std::vector<size_t>& outCurveIndices,
             std::optional<size_t> ignore_curve_id = std::nullopt);
@@ -85,8 +98,7 @@ class CurveEnclosureFinder {
         // Main Solver: Enforces targetCurveIndex to be one of the three enclosing items
         static bool findEnclosingTripletWithTarget(
             const USDCurveKDTree& kdTree,
-            const pxr::VtArray<pxr::GfVec3f>& allPoints,
-            const pxr::VtArray<int>& curveVertexCounts,
+            const CurveInfiniteLines& curveLines,
             const pxr::GfVec3f& P,
             size_t targetCurveIndex,
             std::vector<size_t>& outCurveIndices,
@@ -103,7 +115,7 @@ class CurveEnclosureFinder {
         }
 
         // Checks if point P is strictly inside the region bounded by 3 intersecting infinite lines
-        static inline bool isPointInsideTriangleLines(const Vec2D& p, const std::vector<Vec2D>& origins, const std::vector<Vec2D>& dirs) {
+        static inline bool isPointInsideTriangleLines(const Vec2D& p, const std::array<Vec2D, 3>& origins, const std::array<Vec2D, 3>& dirs) {
             // Calculate which side of each line the point sits on
             float d1 = getSign(p, origins[0], dirs[0]);
             float d2 = getSign(p, origins[1], dirs[1]);
@@ -129,7 +141,7 @@ struct CurveBarycentricCoords {
 class AdvancedCurveBarycentricSolver {
     public:
         // Computes dual-line weights and infinite-extension U parameters purely from curve indices
-        static CurveBarycentricCoords computeWeightsAndUFromTriplet( const pxr::GfVec3f& P, const std::array<size_t, 3>& curveTriplet, const pxr::VtArray<pxr::GfVec3f>& allPoints, const pxr::VtArray<int>& curveVertexCounts);
+        static CurveBarycentricCoords computeWeightsAndUFromTriplet( const pxr::GfVec3f& P, const std::array<size_t, 3>& curveTriplet, const CurveInfiniteLines& curveLines);
 
     private:
         static inline float computePerpendicularDistance(const Vec2D& p, const Vec2D& lineOrigin, const Vec2D& lineDir) {
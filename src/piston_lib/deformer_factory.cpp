@@ -5,6 +5,8 @@
 
 #include <algorithm>
 #include <cctype>
+#include <future>
+#include <unordered_map>
 
 
 namespace Piston {
@@ -116,6 +118,132 @@ void CurvesDeformerFactory::clear() {
 	}
 }
 
+bool CurvesDeformerFactory::deformAll(pxr::UsdTimeCode time_code, bool multi_threaded) {
+	PROFILE("CurvesDeformerFactory::deformAll");
+
+	std::vector<BaseCurvesDeformer::SharedPtr> nodes;
+	{
+		CurvesDeformerFactory& factory = getInstance();
+		const std::lock_guard<std::mutex> lock(factory.mMutex);
+		nodes.reserve(factory.mDeformers.size());
+		for(const auto& entry: factory.mDeformers) {
+			if(entry.second) nodes.push_back(entry.second);
+		}
+	}
+
+	if(nodes.empty()) return true;
+
+	// Build dependency graph. Deformer depends on another deformer if it reads that deformer output prim.
+	std::vector<std::vector<size_t>> upstream(nodes.size());
+	std::vector<std::vector<size_t>> downstream(nodes.size());
+	auto addEdge = [&](size_t from, size_t to) {
+		if(from == to || std::find(upstream[to].begin(), upstream[to].end(), from) != upstream[to].end()) return;
+		upstream[to].push_back(from);
+		downstream[from].push_back(to);
+	};
+
+	// Deformers writing the same prim are chained in factory order, so they never run concurrently. Readers depend on the last one.
+	std::unordered_map<pxr::SdfPath, std::vector<size_t>, pxr::SdfPath::Hash> producers;
+	for(size_t i = 0; i < nodes.size(); ++i) {
+		const pxr::UsdPrim& output_prim = nodes[i]->getCurvesGeoPrim();
+		if(!output_prim.IsValid()) continue;
+
+		auto& prim_producers = producers[output_prim.GetPath()];
+		if(!prim_producers.empty()) {
+			LOG_WRN << "Deformers " << nodes[prim_producers.back()]->getName() << " and " << nodes[i]->getName() << " write the same prim "
+				<< output_prim.GetPath() << ". Evaluating them one after another.";
+			addEdge(prim_producers.back(), i);
+		}
+		prim_producers.push_back(i);
+	}
+
+	for(size_t i = 0; i < nodes.size(); ++i) {
+		for(const auto& path: nodes[i]->getInputPrimPaths()) {
+			auto it = producers.find(path);
+			if(it == producers.end()) continue;
+			// producers of this prim are already ordered by the chain above
+			if(std::find(it->second.begin(), it->second.end(), i) != it->second.end()) continue;
+			addEdge(it->second.back(), i);
+		}
+	}
+
+	// Topological order (Kahn's algorithm)
+	std::vector<size_t> order;
+	order.reserve(nodes.size());
+	std::vector<size_t> in_degree(nodes.size());
+	for(size_t i = 0; i < nodes.size(); ++i) {
+		in_degree[i] = upstream[i].size();
+		if(in_degree[i] == 0) order.push_back(i);
+	}
+	for(size_t n = 0; n < order.size(); ++n) {
+		for(size_t d: downstream[order[n]]) {
+			if(--in_degree[d] == 0) order.push_back(d);
+		}
+	}
+
+	if(order.size() != nodes.size()) {
+		LOG_ERR << "Cyclic dependency detected between deformers! Unable to evaluate deformers graph.";
+		return false;
+	}
+
+	// Bind data is built serially in dependency order. Building reads stored data and may author the stage, and instanced
+	// deformers share data objects that are not safe to build concurrently
+	for(size_t i: order) {
+		if(!nodes[i]->buildDeformerData(nodes[i]->getRestTimeCode(), multi_threaded)) {
+			LOG_ERR << "Error building " << nodes[i]->getName() << " deformer data !";
+			return false;
+		}
+	}
+
+	for(auto& pDeformer: nodes) {
+		pDeformer->clearOutputReady();
+	}
+
+	// Each deformer gets its own task thread that only waits for upstream results and drives its stages on the shared pool.
+	// Running these tasks on the shared pool itself would block pool workers on nested waits.
+	std::vector<std::shared_future<bool>> futures(nodes.size());
+	for(size_t i: order) {
+		std::vector<std::shared_future<bool>> deps;
+		deps.reserve(upstream[i].size());
+		for(size_t u: upstream[i]) {
+			deps.push_back(futures[u]);
+		}
+
+		BaseCurvesDeformer::SharedPtr pDeformer = nodes[i];
+		const bool has_downstream = !downstream[i].empty();
+		futures[i] = std::async(std::launch::async, [pDeformer, deps, time_code, multi_threaded, has_downstream]() {
+			for(const auto& dep: deps) {
+				if(!dep.get()) {
+					LOG_ERR << "Upstream deformer failed. Skipping " << pDeformer->getName() << " evaluation at " << time_code;
+					return false;
+				}
+			}
+
+			if(!pDeformer->deform(time_code, multi_threaded)) {
+				LOG_ERR << "Error evaluating deformer " << pDeformer->getName() << " at " << time_code;
+				return false;
+			}
+			// downstream deformers read our output from the stage
+			if(has_downstream && !pDeformer->flush()) {
+				return false;
+			}
+			pDeformer->setOutputReady(time_code);
+			return true;
+		}).share();
+	}
+
+	bool result = true;
+	for(auto& future: futures) {
+		result = future.get() && result;
+	}
+
+	for(auto& pDeformer: nodes) {
+		pDeformer->clearOutputReady();
+	}
+
+	return result;
+}
+
 PxrPointsLRUCache*  CurvesDeformerFactory::getPxrPointsLRUCachePtr() {
 	const bool cache_enabled = CurvesDeformerFactory::getPointsCacheUsageState();
 
@@ -125,6 +253,12 @@ PxrPointsLRUCache*  CurvesDeformerFactory::getPxrPointsLRUCachePtr() {
 	
 		if(cache_enabled && !mpPxrPointsLRUCache) {
 			mpPxrPointsLRUCache = PxrPointsLRUCache::create(kDefaultPxrPointsLRUCacheMaxSize);
+
+			const auto& conf = GlobalConfig::getInstance();
+			const size_t spill_budget = conf.getPointsCacheSpillBudget();
+			if(spill_budget > 0 && !mpPxrPointsLRUCache->enableSpillStore(conf.getPointsCacheSpillDir(), spill_budget)) {
+				LOG_WRN << "Points cache spill store is disabled !";
+			}
 		} else if(!cache_enabled && mpPxrPointsLRUCache ) {
 			mpPxrPointsLRUCache = nullptr;
 		}
@@ -58,6 +58,17 @@ class CurvesDeformerFactory {
 
 	    static void clear();
 
+	    // DocString: deformAll
+		/**
+		 * @brief Evaluates all deformers at given time code. Deformers are ordered by their data dependencies (one's output prim
+		 * is another one's input). Independent deformers are evaluated concurrently and downstream ones start as soon as
+		 * all their upstream deformers are done.
+		 * @param time_code Time code to evaluate deformers at.
+		 * @param multi_threaded Use shared thread pool inside each deformer.
+		 * @return true if all deformers succeeded.
+		 */
+	    static bool deformAll(pxr::UsdTimeCode time_code = pxr::UsdTimeCode::Default(), bool multi_threaded = true);
+
 	    PxrPointsLRUCache* getPxrPointsLRUCachePtr();
 
 	    const DeformersMap& getDeformers() const { return mDeformers; }
@@ -3,8 +3,8 @@
 
 #include "common.h"
 #include "logging.h"
-#include "kdtree.hpp"
 #include "geometry_tools.h"
+#include "trimesh_bvh.h"
 //#include "simple_profiler.h"
 
 #include <pxr/base/gf/matrix4f.h>
@@ -43,17 +43,17 @@ void FastCurvesDeformer::invalidateData(DeformerDataCache& cache) {
 }
 
 
-bool FastCurvesDeformer::deformImpl(PointsList& points, pxr::UsdTimeCode time_code) {
+bool FastCurvesDeformer::deformImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) {
 	PROFILE("FastCurvesDeformer::deformImpl");
-	return __deform__(points, false, time_code);
+	return __deform__(static_cast<EvalContext&>(ctx), points, false, time_code);
 }
 
-bool FastCurvesDeformer::deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) {
+bool FastCurvesDeformer::deformMtImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) {
 	PROFILE("FastCurvesDeformer::deformMtImpl");
-	return __deform__(points, true, time_code);
+	return __deform__(static_cast<EvalContext&>(ctx), points, true, time_code);
 }
 
-bool FastCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code) {
+bool FastCurvesDeformer::__deform__(EvalContext& ctx, PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code) {
 	assert(mpPhantomTrimeshData);
 	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
 
@@ -71,46 +71,72 @@ bool FastCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, pxr
 		return false;
 	}
 
-	const MeshContainer* pDeformerMeshContainer = mpDeformerMeshContainer.get();
+	const MeshContainer* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
+	const PxrCurvesContainer* pCurvesContainer = ctx.pCurvesContainer;
 
-	const bool build_live = true; // build using live data
-	std::vector<pxr::GfVec3f>& vertex_normals = build_live ? mLiveVertexNormals : mpFastCurvesDeformerData->mRestVertexNormals;
-	const MeshContainer::ContainerType& pt_positions = build_live ? mpDeformerMeshContainer->getLivePositions() : mpDeformerMeshContainer->getRestPositions();
+	const auto& curveBinds = mpFastCurvesDeformerData->mCurveBinds;
 
-	buildVertexNormals(pAdjacency, pPhantomTrimesh, vertex_normals, pt_positions, (multi_threaded ? &mPool : nullptr));
-	calcPerBindNormals(pAdjacency, pPhantomTrimesh, vertex_normals, build_live, (multi_threaded ? &mPool : nullptr));
-	calcPerBindTangentsAndBiNormals(pPhantomTrimesh, build_live, (multi_threaded ? &mPool : nullptr));
+	ctx.perBindLiveNormals.resize(curveBinds.size());
+	ctx.perBindLiveTBs.resize(curveBinds.size());
 
-	if(mpCurvesContainer->getSpace() == PxrCurvesContainer::Space::LOCAL) {
-		DLOG_TRC << "Curves updated. Transform to NTB.";
-		transformCurvesToNTB(multi_threaded);
-	}
+	const MeshContainer::ContainerType& pt_positions = pDeformerMeshContainer->getLivePositions();
 
-	const auto& curveBinds = mpFastCurvesDeformerData->mCurveBinds;
+	// Only normals of the vertices that belong to bound faces are needed
+	buildVertexNormals(pAdjacency, mBoundVertices, ctx.liveVertexNormals, pt_positions, (multi_threaded ? &mPool : nullptr));
 
-	assert(curveBinds.size() == mpCurvesContainer->getCurvesCount());
+	assert(curveBinds.size() == pCurvesContainer->getCurvesCount());
 
+	static constexpr float kF = 1.f / 3.f;
+
+	const auto& vertex_normals = ctx.liveVertexNormals;
+	const auto& perBindRestInvNTBs = mpFastCurvesDeformerData->getPerBindRestInvNTBs();
+	auto& perBindLiveNormals = ctx.perBindLiveNormals;
+	auto& perBindLiveTBs = ctx.perBindLiveTBs;
+
+	// Single pass. Live bind frame is built and immediately used to deform the curve. Curve vectors are taken from rest (inverted NTB) to
+	// live frame with one combined matrix, so no separate curves space conversion is needed
 	auto func = [&](const std::size_t start, const std::size_t end) {
 		for(size_t i = start; i < end; ++i) {
 			const auto& bind = curveBinds[i];
 			if(bind.face_id == CurveBindData::kInvalidFaceID) continue;
 
-			const pxr::GfVec3f& N = mPerBindLiveNormals[i];
-			const pxr::GfVec3f& T = mPerBindLiveTBs[i].first;
-			const pxr::GfVec3f& B = mPerBindLiveTBs[i].second;
+			const auto& face = pPhantomTrimesh->getFace(bind.face_id);
+			const pxr::GfVec3f& p0 = pt_positions[face.indices[0]];
+			const pxr::GfVec3f& p1 = pt_positions[face.indices[1]];
+			const pxr::GfVec3f& p2 = pt_positions[face.indices[2]];
 
-			const pxr::GfMatrix3f m = {
+			float u = bind.u;
+			float v = bind.v;
+			float w = 1.f - u - v;
+			barycentrics_clamp_to_triangle(u, v, w);
+
+			const pxr::GfVec3f N = pxr::GfGetNormalized(
+				u * vertex_normals[face.indices[1]] + v * vertex_normals[face.indices[2]] + w * vertex_normals[face.indices[0]]
+				, MIN_VECTOR_LENGTH_F
+			);
+
+			const pxr::GfVec3f root_proj_pos = bind.u * p0 + bind.v * p2 + (1.f - bind.u - bind.v) * p1;
+			const pxr::GfVec3f tmp_binormal = (p0 + p1 + p2) * kF - root_proj_pos;
+			const pxr::GfVec3f T = pxr::GfGetNormalized(pxr::GfCross(N, tmp_binormal), MIN_VECTOR_LENGTH_F);
+			const pxr::GfVec3f B = pxr::GfGetNormalized(pxr::GfCross(N, T), MIN_VECTOR_LENGTH_F);
+
+			perBindLiveNormals[i] = N;
+			perBindLiveTBs[i] = {T, B};
+
+			const pxr::GfMatrix3f m = pxr::GfMatrix3f(
 				N[0], T[0], B[0], 
 				N[1], T[1], B[1],
 				N[2], T[2], B[2]
-			};
+			) * perBindRestInvNTBs[i];
 
-			auto curve_bind_pos = pDeformerMeshContainer->getInterpolatedLivePosition(pPhantomTrimesh->getFace(bind.face_id), bind.u, bind.v);
-			uint32_t vertex_offset = mpCurvesContainer->getCurveVertexOffset(i);
-			PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(i);
+			const auto root_pos_offset = pCurvesContainer->getCurveRootPoint(i) - pDeformerMeshContainer->getInterpolatedRestPosition(face, bind.u, bind.v);
+			const auto curve_origin = pDeformerMeshContainer->getInterpolatedLivePosition(face, bind.u, bind.v) + m * root_pos_offset;
+
+			uint32_t vertex_offset = pCurvesContainer->getCurveVertexOffset(i);
+			PxrCurvesContainer::CurveDataConstPtr curve_data_ptr = pCurvesContainer->getCurveDataPtr(i);
 
 			for(size_t j = 0; j < curve_data_ptr.first; ++j) {
-				points[vertex_offset++] = curve_bind_pos + m * (*(curve_data_ptr.second + j));
+				points[vertex_offset++] = curve_origin + m * (*(curve_data_ptr.second + j));
 			}
 		}
 	};
@@ -126,24 +152,19 @@ bool FastCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, pxr
 	return true;
 }
 
-bool FastCurvesDeformer::writeJsonDataToPrimImpl() const {
-	if(!BaseMeshCurvesDeformer::writeJsonDataToPrimImpl()) {
-		return false;
-	}
+void FastCurvesDeformer::collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const {
+	BaseMeshCurvesDeformer::collectDataToWrite(requests);
 
-	if(mpFastCurvesDeformerData && !mCurvesGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpFastCurvesDeformerData.get())) {
-		DLOG_ERR << "Error writing " << mpFastCurvesDeformerData->typeName() << " deformer data to json !";	
-		return false;
-	}
-	return true;
+	if(mpFastCurvesDeformerData) requests.push_back({&mCurvesGeoPrimHandle, mpFastCurvesDeformerData.get()});
 }
 
-void FastCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) {
+void FastCurvesDeformer::drawDebugGeometry(const BaseCurvesDeformer::EvalContext& base_ctx, pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) {
 	assert(mpPhantomTrimeshData);
 	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
 	assert(pPhantomTrimesh);
 
-	const MeshContainer* pDeformerMeshContainer = mpDeformerMeshContainer.get();
+	const EvalContext& ctx = static_cast<const EvalContext&>(base_ctx);
+	const MeshContainer* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
 
 	if(!mpDebugGeo) {
 		mpDebugGeo = DebugGeo::create(getName());
@@ -153,28 +174,21 @@ void FastCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const Poi
 
 	const MeshContainer::ContainerType& positions = pDeformerMeshContainer->getLivePositions();
 
-	for(const auto face: pPhantomTrimesh->getFaces()) {
-		DebugGeo::Line lA(positions[face.indices[0]], positions[face.indices[0]] + mLiveVertexNormals[face.indices[0]]*mDebugGeometryMult);
-		lA.setColor({1.0, 0.0, 0.0}, {0.0, 0.0, 1.0});
-		lA.setWidth(0.05);
-		DebugGeo::Line lB(positions[face.indices[1]], positions[face.indices[1]] + mLiveVertexNormals[face.indices[1]]*mDebugGeometryMult);
-		lB.setColor({1.0, 0.0, 0.0}, {0.0, 0.0, 1.0});
-		lB.setWidth(0.05);
-		DebugGeo::Line lC(positions[face.indices[2]], positions[face.indices[2]] + mLiveVertexNormals[face.indices[2]]*mDebugGeometryMult);
-		lC.setColor({1.0, 0.0, 0.0}, {0.0, 0.0, 1.0});
-		lC.setWidth(0.05);
-
-		mpDebugGeo->addLine(lA);
-		mpDebugGeo->addLine(lB);
-		mpDebugGeo->addLine(lC);
+	// live normals are only built for bound faces vertices
+	for(const uint32_t vtx: mBoundVertices) {
+		DebugGeo::Line l(positions[vtx], positions[vtx] + ctx.liveVertexNormals[vtx]*mDebugGeometryMult);
+		l.setColor({1.0, 0.0, 0.0}, {0.0, 0.0, 1.0});
+		l.setWidth(0.05);
+
+		mpDebugGeo->addLine(l);
 	}
 
 	const auto& curveBinds = mpFastCurvesDeformerData->mCurveBinds;
 	for(size_t i = 0; i < curveBinds.size(); ++i) {
 		
-		const pxr::GfVec3f& N = mPerBindLiveNormals[i];
-		const pxr::GfVec3f& T = mPerBindLiveTBs[i].first;
-		const pxr::GfVec3f& B = mPerBindLiveTBs[i].second;
+		const pxr::GfVec3f& N = ctx.perBindLiveNormals[i];
+		const pxr::GfVec3f& T = ctx.perBindLiveTBs[i].first;
+		const pxr::GfVec3f& B = ctx.perBindLiveTBs[i].second;
 
 		const auto& bind = curveBinds[i];
 		auto curve_bind_pos = pDeformerMeshContainer->getInterpolatedLivePosition(pPhantomTrimesh->getFace(bind.face_id), bind.u, bind.v);
@@ -224,36 +238,48 @@ bool FastCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code,
 			mpFastCurvesDeformerData->mPerBindRestTBs.resize(binds_count);
 
 			// Additional per-bind rest normals if needed
-			const bool build_live = false; // build using rest data
-			std::vector<pxr::GfVec3f>& vertex_normals = build_live ? mLiveVertexNormals : mpFastCurvesDeformerData->mRestVertexNormals;
-			const auto& pt_positions = build_live ? mpDeformerMeshContainer->getLivePositions() : mpDeformerMeshContainer->getRestPositions();
+			std::vector<pxr::GfVec3f>& vertex_normals = mpFastCurvesDeformerData->mRestVertexNormals;
+			const auto& pt_positions = mpDeformerMeshContainer->getRestPositions();
 
 			buildVertexNormals(pAdjacency, pPhantomTrimesh, vertex_normals, pt_positions, (multi_threaded ? &mPool : nullptr));
-			calcPerBindNormals(pAdjacency, pPhantomTrimesh, vertex_normals, build_live, (multi_threaded ? &mPool : nullptr));
-			calcPerBindTangentsAndBiNormals(pPhantomTrimesh, build_live, (multi_threaded ? &mPool : nullptr));
+			calcPerBindNormals(pAdjacency, pPhantomTrimesh, vertex_normals, mpFastCurvesDeformerData->mPerBindRestNormals, (multi_threaded ? &mPool : nullptr));
+			calcPerBindTangentsAndBiNormals(pPhantomTrimesh, pt_positions, mpFastCurvesDeformerData->mPerBindRestNormals, mpFastCurvesDeformerData->mPerBindRestTBs, (multi_threaded ? &mPool : nullptr));
+			calcPerBindRestInvNTBs(mpFastCurvesDeformerData->mPerBindRestNormals, mpFastCurvesDeformerData->mPerBindRestTBs, mpFastCurvesDeformerData->mPerBindRestInvNTBs, (multi_threaded ? &mPool : nullptr));
 			
 			mpFastCurvesDeformerData->setValid(true);
 		}
 	}
 
-	mLiveVertexNormals.resize(mpFastCurvesDeformerData->getRestVertexNormals().size());
-	mPerBindLiveNormals.resize(mpFastCurvesDeformerData->getPerBindRestNormals().size());
-	mPerBindLiveTBs.resize(mpFastCurvesDeformerData->getPerBindRestTBs().size());
+	buildBoundVertices(pPhantomTrimesh);
 
-	// transform curves to NTB spaces
-	if(mpCurvesContainer->getSpace() == PxrCurvesContainer::Space::LOCAL) {
-		transformCurvesToNTB(multi_threaded);
-	}
-	
 	return mpFastCurvesDeformerData->isValid(); 
 }
 
-void FastCurvesDeformer::calcPerBindNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pPhantomTrimesh, const std::vector<pxr::GfVec3f>& vertex_normals, bool build_live, BS::thread_pool<BS::tp::none>* pThreadPool) {
+void FastCurvesDeformer::buildBoundVertices(const PhantomTrimesh* pPhantomTrimesh) {
+	assert(pPhantomTrimesh);
+
+	mBoundVertices.clear();
+
+	const auto& curveBinds = mpFastCurvesDeformerData->getCurveBinds();
+	for(const auto& bind: curveBinds) {
+		if(bind.face_id == CurveBindData::kInvalidFaceID) continue;
+		const auto& face = pPhantomTrimesh->getFace(bind.face_id);
+		for(const auto vtx: face.indices) {
+			mBoundVertices.push_back(static_cast<uint32_t>(vtx));
+		}
+	}
+
+	std::sort(mBoundVertices.begin(), mBoundVertices.end());
+	mBoundVertices.erase(std::unique(mBoundVertices.begin(), mBoundVertices.end()), mBoundVertices.end());
+
+	DLOG_DBG << mBoundVertices.size() << " deformer mesh vertices are referenced by curve binds";
+}
+
+void FastCurvesDeformer::calcPerBindNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pPhantomTrimesh, const std::vector<pxr::GfVec3f>& vertex_normals, std::vector<pxr::GfVec3f>& perBindNormals, ThreadPool* pThreadPool) const {
 	assert(pAdjacency);
 	assert(pPhantomTrimesh);
 
 	// Build per bind normals
-	auto& perBindNormals = build_live ? mPerBindLiveNormals : mpFastCurvesDeformerData->mPerBindRestNormals;
 	const auto& curveBinds = mpFastCurvesDeformerData->getCurveBinds();
 	assert(perBindNormals.size() == curveBinds.size());
 
@@ -284,21 +310,16 @@ void FastCurvesDeformer::calcPerBindNormals(const UsdGeomMeshFaceAdjacency* pAdj
     }
 }
 
-void FastCurvesDeformer::calcPerBindTangentsAndBiNormals(const PhantomTrimesh* pPhantomTrimesh, bool build_live, BS::thread_pool<BS::tp::none>* pThreadPool) {
+void FastCurvesDeformer::calcPerBindTangentsAndBiNormals(const PhantomTrimesh* pPhantomTrimesh, const MeshContainer::ContainerType& pt_positions, const std::vector<pxr::GfVec3f>& perBindNormals, 
+	std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>& perBindTBs, ThreadPool* pThreadPool) const {
 	static constexpr float kF = 1.f / 3.f;
 
 	assert(pPhantomTrimesh);
-	assert(mpDeformerMeshContainer);
-
-	auto& perBindNormals = build_live ? mPerBindLiveNormals : mpFastCurvesDeformerData->mPerBindRestNormals;
 
 	const auto& curveBinds = mpFastCurvesDeformerData->getCurveBinds();
 	assert(perBindNormals.size() == curveBinds.size());
+	assert(perBindTBs.size() == curveBinds.size());
 
-	auto& mPerBindTBs = build_live ? mPerBindLiveTBs : mpFastCurvesDeformerData->mPerBindRestTBs;
-	assert(mPerBindTBs.size() == curveBinds.size());
-
-	const auto& pt_positions = build_live ? mpDeformerMeshContainer->getLivePositions() : mpDeformerMeshContainer->getRestPositions();
 	const std::vector<PhantomTrimesh::TriFace>& faces = pPhantomTrimesh->getFaces(); 
 
 	pxr::VtArray<pxr::GfVec3f> face_center_points(faces.size());
@@ -316,8 +337,8 @@ void FastCurvesDeformer::calcPerBindTangentsAndBiNormals(const PhantomTrimesh* p
 			const pxr::GfVec3f root_proj_pos = bind.u * pt_positions[face.indices[0]] + bind.v * pt_positions[face.indices[2]] + (1.f - bind.u - bind.v) * pt_positions[face.indices[1]];			
 			const pxr::GfVec3f tmp_binormal = face_center_points[bind.face_id] - root_proj_pos;
 
-			mPerBindTBs[i].first = pxr::GfGetNormalized(pxr::GfCross(perBindNormals[i], tmp_binormal), MIN_VECTOR_LENGTH_F); // tangent
-			mPerBindTBs[i].second = pxr::GfGetNormalized(pxr::GfCross(perBindNormals[i], mPerBindTBs[i].first), MIN_VECTOR_LENGTH_F); //binormal
+			perBindTBs[i].first = pxr::GfGetNormalized(pxr::GfCross(perBindNormals[i], tmp_binormal), MIN_VECTOR_LENGTH_F); // tangent
+			perBindTBs[i].second = pxr::GfGetNormalized(pxr::GfCross(perBindNormals[i], perBindTBs[i].first), MIN_VECTOR_LENGTH_F); //binormal
     	}
     };
 
@@ -331,65 +352,42 @@ void FastCurvesDeformer::calcPerBindTangentsAndBiNormals(const PhantomTrimesh* p
     }
 }
 
-void FastCurvesDeformer::transformCurvesToNTB(bool multi_threaded) {
-	assert(mpCurvesContainer);
-	assert(mpCurvesContainer->getCurvesCount() > 0);
-
-	if(mpCurvesContainer->getSpace() != PxrCurvesContainer::Space::LOCAL) {
-		// curves already in NTB space
-		LOG_WRN << "Trying to transformCurvesToNTB while curves in " << to_string(mpCurvesContainer->getSpace()) << " space!";
-		return;
-	}
+void FastCurvesDeformer::calcPerBindRestInvNTBs(const std::vector<pxr::GfVec3f>& perBindNormals, const std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>& perBindTBs, 
+	std::vector<pxr::GfMatrix3f>& perBindInvNTBs, ThreadPool* pThreadPool) const {
+	assert(perBindNormals.size() == perBindTBs.size());
 
 	const auto& curveBinds = mpFastCurvesDeformerData->getCurveBinds();
-	assert(curveBinds.size() == mpCurvesContainer->getCurvesCount());
-
-	assert(mpPhantomTrimeshData);
-	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
-	assert(pPhantomTrimesh);
+	assert(curveBinds.size() == perBindNormals.size());
 
-	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
-
-	const auto& perBindRestNormals = mpFastCurvesDeformerData->getPerBindRestNormals();
-	const auto& perBindRestTBs = mpFastCurvesDeformerData->getPerBindRestTBs();
+	perBindInvNTBs.resize(curveBinds.size());
 
 	auto func = [&](const size_t start, const size_t end) {
-		for(uint32_t curve_index = start; curve_index < end; ++curve_index) {
-			PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(curve_index);
-			const auto& bind = curveBinds[curve_index];
-			if(bind.face_id == CurveBindData::kInvalidFaceID) continue;
+		for(size_t i = start; i < end; ++i) {
+			if(curveBinds[i].face_id == CurveBindData::kInvalidFaceID) {
+				perBindInvNTBs[i].SetIdentity();
+				continue;
+			}
 
-			const auto root_pos_offset = mpCurvesContainer->getCurveRootPoint(curve_index) - pDeformerMeshContainer->getInterpolatedRestPosition(pPhantomTrimesh->getFace(bind.face_id), bind.u, bind.v);
-			const pxr::GfVec3f& N = perBindRestNormals[curve_index];
-			const pxr::GfVec3f& T = perBindRestTBs[curve_index].first;
-			const pxr::GfVec3f& B = perBindRestTBs[curve_index].second;
-			const pxr::GfMatrix3f m = pxr::GfMatrix3f(
+			const pxr::GfVec3f& N = perBindNormals[i];
+			const pxr::GfVec3f& T = perBindTBs[i].first;
+			const pxr::GfVec3f& B = perBindTBs[i].second;
+			perBindInvNTBs[i] = pxr::GfMatrix3f(
 				N[0], T[0], B[0],
 				N[1], T[1], B[1],
 				N[2], T[2], B[2]
 			).GetInverse();
-
-			for(size_t j = 0; j < curve_data_ptr.first; ++j) {
-				*(curve_data_ptr.second + j) = m * (*(curve_data_ptr.second + j) + root_pos_offset);
-			}
 		}
 	};
 
-	if(multi_threaded) {
-		BS::multi_future<void> blocks = mPool.submit_blocks(0u, mpCurvesContainer->getCurvesCount(), func);
-        blocks.wait();
+	if(pThreadPool) {
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(0u, curveBinds.size(), func);
+		blocks.wait();
 	} else {
-		func(0u, mpCurvesContainer->getCurvesCount());
+		func(0u, curveBinds.size());
 	}
-
-	mpCurvesContainer->setSpace(PxrCurvesContainer::Space::DEFORMER);
 }
 
-bool FastCurvesDeformer::bindCurveToTriface(uint32_t curve_index, uint32_t face_id, CurveBindData& bind, bool ignore_face_boundaries) {
-	assert(mpPhantomTrimeshData);
-	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
-	assert(pPhantomTrimesh);
-
+bool FastCurvesDeformer::bindCurveToTriface(uint32_t curve_index, const PhantomTrimesh::TriFace& face, CurveBindData& bind, bool ignore_face_boundaries) {
 	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
 
 	PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(curve_index);
@@ -398,8 +396,6 @@ bool FastCurvesDeformer::bindCurveToTriface(uint32_t curve_index, uint32_t face_
 
 	const pxr::GfVec3f& curve_root_pt = mpCurvesContainer->getCurveRootPoint(curve_index);
 
-	const auto& face = pPhantomTrimesh->getFace(face_id);
-
 	for(uint32_t ptr_offset = 0; ptr_offset < static_cast<uint32_t>(curve_data_ptr.first - 1); ++ptr_offset) {
 		const pxr::GfVec3f orig = curve_root_pt + *(curve_data_ptr.second + ptr_offset);
 		const pxr::GfVec3f dir  = *(curve_data_ptr.second + ptr_offset + 1) - *(curve_data_ptr.second + ptr_offset); 
@@ -407,7 +403,6 @@ bool FastCurvesDeformer::bindCurveToTriface(uint32_t curve_index, uint32_t face_
 		if(pDeformerMeshContainer->intersectRay(orig, dir, face, bind.u, bind.v, isect_dist)) {
 			// check we've intersected within curve segment
 			if((isect_dist*isect_dist) <= lengthSquared(dir)) {
-				bind.face_id = face_id;
 				return true;
 			}
 		}
@@ -421,7 +416,6 @@ bool FastCurvesDeformer::bindCurveToTriface(uint32_t curve_index, uint32_t face_
 		float dist = FLT_MAX;
 		bool bound = pDeformerMeshContainer->projectPoint(pt, face, bind.u, bind.v, dist);
 		if(bound) {
-			bind.face_id = face_id;
 			return true;
 		} else {
 			distance_coords_pairs[ptr_offset] = {dist, {bind.u, bind.v}};
@@ -434,7 +428,6 @@ bool FastCurvesDeformer::bindCurveToTriface(uint32_t curve_index, uint32_t face_
 			return p1.first < p2.first;
 		});
 
-		bind.face_id = face_id;
 		bind.u = distance_coords_pairs[0].second[0];
 		bind.v = distance_coords_pairs[0].second[1];
 		return true;
@@ -455,8 +448,7 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 
 	curveBinds.resize(total_curves_count);
 	std::atomic<uint32_t> skin_bound_curves_count = 0;
-	std::atomic<uint32_t> kdtree_bound_curves_count = 0;
-	std::atomic<uint32_t> bforce_bound_curves_count = 0;
+	std::atomic<uint32_t> bvh_bound_curves_count = 0;
 
 
 	// Clear all possible previous binds
@@ -478,7 +470,18 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 
 	const MeshContainer::ContainerType& rest_positions = pDeformerMeshContainer->getRestPositions();
 
-	auto bindCurveToPrim = [&] (uint32_t curve_index, CurveBindData& bind, uint32_t prim_id, std::vector<float>& _tmp_sq_distances, bool ignore_face_boundaries, std::pair<float, uint32_t>* p_best_candidate = nullptr) {
+	// Per curve candidate faces. Binding threads don't touch trimesh, face ids are created after all curves are bound
+	std::vector<PhantomTrimesh::TriFace::IndicesList> bind_faces(total_curves_count, PhantomTrimesh::TriFace::kInvalidIndices);
+
+	auto bindCurveToFace = [&] (uint32_t curve_index, CurveBindData& bind, const PhantomTrimesh::TriFace& face, bool ignore_face_boundaries) {
+		if(!bindCurveToTriface(curve_index, face, bind, ignore_face_boundaries)) return false;
+
+		bind_faces[curve_index] = face.indices;
+		bind.face_id = curve_index; // pending. resolved to trimesh face id once binding is done
+		return true;
+	};
+
+	auto bindCurveToPrim = [&] (uint32_t curve_index, CurveBindData& bind, uint32_t prim_id, std::vector<float>& _tmp_sq_distances, bool ignore_face_boundaries, std::pair<float, PhantomTrimesh::TriFace>* p_best_candidate = nullptr) {
 		bool isBound = false;
 		const uint32_t prim_vertex_count = pAdjacency->getFaceVertexCount(prim_id);
 		const uint32_t prim_vertex_offset = pAdjacency->getFaceVertexOffset(prim_id);
@@ -509,13 +512,13 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 			
 			for(uint32_t i = 1; i < (prim_vertex_count - 1); ++i) {
 				// try using fan method
-				uint32_t face_id = pPhantomTrimesh->getOrCreateFaceID(
+				const auto face = PhantomTrimesh::makeFace(
 					pAdjacency->getFaceVertex(prim_id, local_index), 
 					pAdjacency->getFaceVertex(prim_id, (local_index + i) % prim_vertex_count),
 					pAdjacency->getFaceVertex(prim_id, (local_index + i + 1) % prim_vertex_count)
 				);
 
-				if(bindCurveToTriface(curve_index, face_id, bind, false /* respect face boundaries */)) {
+				if(bindCurveToFace(curve_index, bind, face, false /* respect face boundaries */)) {
 					isBound = true;
 					break;
 				} 
@@ -524,33 +527,33 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 			if(!isBound) {
 				// if ignore boundaries and we are still somewhere oustide
 				// ear triangle
-				uint32_t face_id = pPhantomTrimesh->getOrCreateFaceID(
+				const auto face = PhantomTrimesh::makeFace(
 					pAdjacency->getFaceVertex(prim_id, (local_index - 1) % prim_vertex_count), 
 					pAdjacency->getFaceVertex(prim_id, local_index),
 					pAdjacency->getFaceVertex(prim_id, (local_index + 1) % prim_vertex_count)
 				);
 
 				if(ignore_face_boundaries) {
-					bindCurveToTriface(curve_index, face_id, bind, true /* ignore face boundaries */);
+					bindCurveToFace(curve_index, bind, face, true /* ignore face boundaries */);
 				 	return true;
 				} else if(p_best_candidate) {
 					p_best_candidate->first = _tmp_sq_distances[local_index];
-					p_best_candidate->second = face_id;
+					p_best_candidate->second = face;
 				}
 			}
 
 		} else {
-			const uint32_t face_id = pPhantomTrimesh->getOrCreateFaceID(
+			const auto face = PhantomTrimesh::makeFace(
 				pAdjacency->getFaceVertex(prim_id, 0), 
 				pAdjacency->getFaceVertex(prim_id, 1),
 				pAdjacency->getFaceVertex(prim_id, 2)
 			);
-			isBound = bindCurveToTriface(curve_index, face_id, bind, ignore_face_boundaries);
+			isBound = bindCurveToFace(curve_index, bind, face, ignore_face_boundaries);
 
 			if(!isBound && p_best_candidate) {
 				uint32_t local_index = calcSquaredDistances();
 				p_best_candidate->first = _tmp_sq_distances[local_index];
-				p_best_candidate->second = face_id;
+				p_best_candidate->second = face;
 			}
 		}
 
@@ -569,8 +572,35 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 	
 	DLOG_INF << "Binding curves to mesh" << (has_skin_prim_attr ? " using skin prim attribute." : ".");
 
-	std::mutex kdtree_mutex;  // protects kdree initialisation
-	std::unique_ptr<neighbour_search::KDTree<float, 3>> pKDTree;
+	// Fan triangulated final mesh prims with their source prim ids. Used for closest face and curve segments ray queries
+	std::vector<TrimeshBVH::TriangleIndices> bvh_triangles;
+	std::vector<uint32_t> bvh_triangle_prims;
+	TrimeshBVH::UniquePtr pFacesBVH;
+	std::mutex bvh_mutex;  // protects lazy bvh initialisation
+
+	auto buildFacesBVH = [&](ThreadPool* pThreadPool) {
+		bvh_triangles.reserve(pAdjacency->getFaceCount() * 2);
+		bvh_triangle_prims.reserve(pAdjacency->getFaceCount() * 2);
+
+		for(uint32_t prim_id = 0; prim_id < pAdjacency->getFaceCount(); ++prim_id) {
+			const uint32_t prim_vertex_count = pAdjacency->getFaceVertexCount(prim_id);
+			for(uint32_t i = 1; (i + 1) < prim_vertex_count; ++i) {
+				bvh_triangles.push_back(PhantomTrimesh::makeFace(
+					pAdjacency->getFaceVertex(prim_id, 0),
+					pAdjacency->getFaceVertex(prim_id, i),
+					pAdjacency->getFaceVertex(prim_id, i + 1)
+				).indices);
+				bvh_triangle_prims.push_back(prim_id);
+			}
+		}
+
+		pFacesBVH = TrimeshBVH::create(bvh_triangles, rest_positions, pThreadPool);
+	};
+
+	// With skin prim attribute most curves never need the bvh, so it's built lazily from binding threads
+	if(!has_skin_prim_attr) {
+		buildFacesBVH(multi_threaded ? &mPool : nullptr);
+	}
 
 	auto func = [&](const std::size_t start, const std::size_t end) {
 		const auto* pAdjacencySource = mpAdjacencyData->getAdjacency();
@@ -590,10 +620,10 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 
 				if(has_subdiv_mesh) {
 					// Subd 
-					std::vector<int> outFaceIds;
-					pRefiner->getSubdividedPrimsFromSource(skin_prim_indices[curve_index], outFaceIds);
+					const auto faces_ptr = pRefiner->getSubdividedPrimsPtrFromSource(skin_prim_indices[curve_index]);
 
-					for(int subdivided_prim_id: outFaceIds) {
+					for(uint32_t i = 0; i < faces_ptr.first; ++i) {
+						const int subdivided_prim_id = *(faces_ptr.second + i);
 						if(subdivided_prim_id >= 0) {
 							prim_indices.push_back(static_cast<uint32_t>(subdivided_prim_id));
 						}
@@ -605,80 +635,76 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 
 				const auto& pt = mpCurvesContainer->getCurveRootPoint(curve_index);
 				
-				std::pair<float, uint32_t> min_dist(FLT_MAX, PhantomTrimesh::kInvalidTriFaceID);
+				std::pair<float, PhantomTrimesh::TriFace> min_dist(FLT_MAX, PhantomTrimesh::TriFace());
 
 				for(uint32_t prim_id: prim_indices) {
 					
-					std::pair<float, uint32_t> curr_min_dist;
+					std::pair<float, PhantomTrimesh::TriFace> curr_min_dist;
 
 					if(bindCurveToPrim(curve_index, bind, prim_id, tmp_squared_distances, false /* respect face boundaries */, &curr_min_dist)) {
 						skin_bound_curves_count++;
 						continue;
 					}
 
-					assert(curr_min_dist.second != PhantomTrimesh::kInvalidTriFaceID);
+					assert(curr_min_dist.second.isValid());
 					if(curr_min_dist.first < min_dist.first) {
-						min_dist.second = curr_min_dist.second;
+						min_dist = curr_min_dist;
 					}
 				}
 
 				// now bind to closeset if exact match failed
 				if(bind.face_id == PhantomTrimesh::kInvalidTriFaceID) {
-					assert(min_dist.second != PhantomTrimesh::kInvalidTriFaceID);
-					bindCurveToTriface(curve_index, min_dist.second, bind, true /* ignore face boundaries */);
+					assert(min_dist.second.isValid());
+					bindCurveToFace(curve_index, bind, min_dist.second, true /* ignore face boundaries */);
 					skin_bound_curves_count++;
 				}
 			}
 
 			if(bind.face_id != CurveBindData::kInvalidFaceID) continue; // bound already
-			// Strategy: 2. Bind remaining curves using nearest point
-
-			// Build guide kdtree if needed
+			// Strategy: 2. Bind remaining curves using closest mesh triangle
 			{
-        		const std::lock_guard<std::mutex> lock(kdtree_mutex);
-        		if(!pKDTree) {
-        			pKDTree = std::make_unique<neighbour_search::KDTree<float, 3>>(rest_positions, false /* no threads */);
-        		}
-        	}
-
-			//std::vector<neighbour_search::KDTree<float, 3>::ReturnType> nearest_points;
+				const std::lock_guard<std::mutex> lock(bvh_mutex);
+				if(!pFacesBVH) {
+					buildFacesBVH(nullptr /* no threads */);
+				}
+			}
 
 			const pxr::GfVec3f& curve_root_pt = mpCurvesContainer->getCurveRootPoint(curve_index);
-			const neighbour_search::KDTree<float, 3>::ReturnType nearest_pt = pKDTree->findNearestNeighbour(curve_root_pt);
-
-			const auto nearest_vtx = nearest_pt.first;
-			const uint32_t neighbors_count = pAdjacency->getNeighborsCount(nearest_vtx);
-			if(neighbors_count > 0) {
-				const uint32_t neighbors_offset = pAdjacency->getNeighborsOffset(nearest_vtx);
-				for(uint32_t prim_offset = neighbors_offset; prim_offset < (neighbors_offset + neighbors_count); ++prim_offset){
-					const auto prim_id = pAdjacency->getNeighborPrim(prim_offset);
-					if(bindCurveToPrim(curve_index, bind, prim_id, tmp_squared_distances, false /* respect face boundaries */)) {
-						kdtree_bound_curves_count++;
-						break;
-					}
-				}
+			float closest_sq_dist;
+			const uint32_t closest_tri = pFacesBVH->findClosestFace(curve_root_pt, closest_sq_dist);
+			if(closest_tri == TrimeshBVH::kInvalidFaceID) continue;
 
-				if(bind.face_id == CurveBindData::kInvalidFaceID) {
-					for(uint32_t prim_offset = neighbors_offset; prim_offset < (neighbors_offset + neighbors_count); ++prim_offset){
-						const auto prim_id = pAdjacency->getNeighborPrim(prim_offset);
-						if(bindCurveToPrim(curve_index, bind, prim_id, tmp_squared_distances, true /* ignore face boundaries */)) {
-							kdtree_bound_curves_count++;
-							break;
-						}
-					}
-				}
+			const PhantomTrimesh::TriFace closest_face(bvh_triangles[closest_tri]);
 
+			if(bindCurveToFace(curve_index, bind, closest_face, false /* respect face boundaries */) || 
+				bindCurveToPrim(curve_index, bind, bvh_triangle_prims[closest_tri], tmp_squared_distances, false /* respect face boundaries */)) {
+				bvh_bound_curves_count++;
+				continue;
 			}
-			// Strategy: 3. Brute force binding
 
-			if(bind.face_id == CurveBindData::kInvalidFaceID) {
-				for(const auto& prim_id: pAdjacency->getPrimData()) {
-					if(bindCurveToPrim(curve_index, bind, prim_id, tmp_squared_distances, false /* respect face boundaries */)) {
-						bforce_bound_curves_count++;
-						break;
-					}
+			// Then try triangles hit by curve segments
+			const PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(curve_index);
+			for(uint32_t ptr_offset = 0; (ptr_offset + 1) < static_cast<uint32_t>(curve_data_ptr.first); ++ptr_offset) {
+				const pxr::GfVec3f orig = curve_root_pt + *(curve_data_ptr.second + ptr_offset);
+				const pxr::GfVec3f dir  = *(curve_data_ptr.second + ptr_offset + 1) - *(curve_data_ptr.second + ptr_offset);
+
+				uint32_t hit_tri;
+				float hit_u, hit_v, hit_t;
+				if(!pFacesBVH->intersectRay(orig, dir, 1.f /* segment end */, hit_tri, hit_u, hit_v, hit_t)) continue;
+
+				if(bindCurveToFace(curve_index, bind, PhantomTrimesh::TriFace(bvh_triangles[hit_tri]), false /* respect face boundaries */)) {
+					break;
 				}
 			}
+
+			// Finally bind to closest triangle plane
+			if(bind.face_id == CurveBindData::kInvalidFaceID) {
+				bindCurveToFace(curve_index, bind, closest_face, true /* ignore face boundaries */);
+			}
+
+			if(bind.face_id != CurveBindData::kInvalidFaceID) {
+				bvh_bound_curves_count++;
+			}
 		}
 	};
 
@@ -689,10 +715,17 @@ bool FastCurvesDeformer::buildCurvesBindingData(pxr::UsdTimeCode rest_time_code,
 		func(0u, total_curves_count);
 	}
 
+	// Create trimesh faces for all bound curves at once
+	std::vector<uint32_t> bind_face_ids;
+	pPhantomTrimesh->createFaceIDs(bind_faces, bind_face_ids, (multi_threaded ? &mPool : nullptr));
+
+	for(size_t curve_index = 0; curve_index < total_curves_count; ++curve_index) {
+		curveBinds[curve_index].face_id = bind_face_ids[curve_index];
+	}
+
 	DLOG_DBG << "Total curves count to bind: " << size_t(total_curves_count);
 	DLOG_DBG << "Skin bound curves count: " << size_t(skin_bound_curves_count.load());
-	DLOG_DBG << "KDtree bound curves count: " << size_t(kdtree_bound_curves_count.load());
-	DLOG_DBG << "Brute force bound curves count: " << size_t(bforce_bound_curves_count.load());
+	DLOG_DBG << "BVH bound curves count: " << size_t(bvh_bound_curves_count.load());
 
 	mpPhantomTrimeshData->setValid(true);
 	return true;
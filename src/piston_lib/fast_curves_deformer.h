@@ -35,34 +35,43 @@ class FastCurvesDeformer : public BaseMeshCurvesDeformer, public inherit_shared_
 		static SharedPtr create(const std::string& name);
 		virtual const std::string& toString() const override;
 
+		struct EvalContext : public BaseCurvesDeformer::EvalContext {
+			std::vector<pxr::GfVec3f> 							liveVertexNormals;
+			std::vector<pxr::GfVec3f>               			perBindLiveNormals; // we keep memory to save on per-frame reallocations
+			std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>   perBindLiveTBs; // we keep memory to save on per-frame reallocations
+		};
+
 	protected:
 		FastCurvesDeformer(const std::string& name);
-		virtual bool deformImpl(PointsList& points, pxr::UsdTimeCode time_code) override;
-		virtual bool deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) override;
+		virtual bool deformImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) override;
+		virtual bool deformMtImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) override;
+
+		virtual BaseCurvesDeformer::EvalContext::UniquePtr createEvalContext() const override { return std::make_unique<EvalContext>(); }
 
-		virtual void drawDebugGeometry(pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) override;
+		virtual void drawDebugGeometry(const BaseCurvesDeformer::EvalContext& ctx, pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) override;
 
 		virtual void invalidateData(DeformerDataCache& cache) override;
 
 	private:
-		bool __deform__(PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code);
+		bool __deform__(EvalContext& ctx, PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code);
 
 		virtual bool buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded = false);
-		virtual bool writeJsonDataToPrimImpl() const;
+		virtual void collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const override;
 
 		bool buildCurvesBindingData(pxr::UsdTimeCode rest_time_code, bool multi_threaded);
-		void calcPerBindNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pPhantomTrimesh, const std::vector<pxr::GfVec3f>& vertex_normals, bool build_live, BS::thread_pool<BS::tp::none>* pThreadPool = nullptr);
-		void calcPerBindTangentsAndBiNormals(const PhantomTrimesh* pPhantomTrimesh, bool build_live, BS::thread_pool<BS::tp::none>* pThreadPool = nullptr);
+		void calcPerBindNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pPhantomTrimesh, const std::vector<pxr::GfVec3f>& vertex_normals, std::vector<pxr::GfVec3f>& perBindNormals, ThreadPool* pThreadPool = nullptr) const;
+		void calcPerBindTangentsAndBiNormals(const PhantomTrimesh* pPhantomTrimesh, const MeshContainer::ContainerType& pt_positions, const std::vector<pxr::GfVec3f>& perBindNormals, 
+			std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>& perBindTBs, ThreadPool* pThreadPool = nullptr) const;
 
-		void transformCurvesToNTB(bool multi_threaded);
+		void calcPerBindRestInvNTBs(const std::vector<pxr::GfVec3f>& perBindNormals, const std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>& perBindTBs, 
+			std::vector<pxr::GfMatrix3f>& perBindInvNTBs, ThreadPool* pThreadPool = nullptr) const;
 
-		bool bindCurveToTriface(uint32_t curve_index, uint32_t face_id, CurveBindData& bind, bool ignore_face_boundaries);
+		void buildBoundVertices(const PhantomTrimesh* pPhantomTrimesh);
 
-		std::shared_ptr<FastCurvesDeformerData>             mpFastCurvesDeformerData;
+		bool bindCurveToTriface(uint32_t curve_index, const PhantomTrimesh::TriFace& face, CurveBindData& bind, bool ignore_face_boundaries);
 
-		std::vector<pxr::GfVec3f> 							mLiveVertexNormals;
-		std::vector<pxr::GfVec3f>               			mPerBindLiveNormals; // we keep memory to save on per-frame reallocations
-		std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>   mPerBindLiveTBs; // we keep memory to save on per-frame reallocations
+		std::shared_ptr<FastCurvesDeformerData>             mpFastCurvesDeformerData;
+		std::vector<uint32_t>                               mBoundVertices; // unique mesh vertices of the faces curves are bound to
 
 		DebugGeo::UniquePtr                                 mpDebugGeo;
 };
@@ -5,7 +5,7 @@
 
 namespace Piston {
 
-static const SerializableDeformerDataBase::DataVersion kFastBindingDataVersion( 0u, 0u, 1u);
+static const SerializableDeformerDataBase::DataVersion kFastBindingDataVersion( 0u, 0u, 2u);
 
 void FastCurvesDeformerData::clearData() {
 	const std::lock_guard<std::mutex> lock(mMutex);
@@ -14,6 +14,7 @@ void FastCurvesDeformerData::clearData() {
 	mRestVertexNormals.clear();
 	mPerBindRestNormals.clear();
 	mPerBindRestTBs.clear();
+	mPerBindRestInvNTBs.clear();
 	mIsValid = false;
 }
 
@@ -40,6 +41,11 @@ size_t FastCurvesDeformerData::calcHash() const {
 	}
 	hash += mPerBindRestTBs.size();
 
+	for(const auto& m: mPerBindRestInvNTBs) {
+		hash += static_cast<size_t>(m[0][0] + m[1][1] + m[2][2]);
+	}
+	hash += mPerBindRestInvNTBs.size();
+
 	return hash;
 }
 
@@ -47,6 +53,7 @@ static constexpr const char* kJCurveBinds = "curvebinds";
 static constexpr const char* kJRestVertexNormals = "restvtxnormals";
 static constexpr const char* kPerBindRestNormals = "perbindvtxnormals";
 static constexpr const char* kPerBindrBindRestTBs = "perbindtbs";
+static constexpr const char* kPerBindRestInvNTBs = "perbindinvntbs";
 
 static constexpr const char* kJDataHash = "data_hash";
 
@@ -59,6 +66,7 @@ bool FastCurvesDeformerData::dumpToJSON(json& j) const {
 	to_json(j[kJRestVertexNormals], mRestVertexNormals);
 	to_json(j[kPerBindRestNormals], mPerBindRestNormals);
 	to_json(j[kPerBindrBindRestTBs], mPerBindRestTBs);
+	to_json(j[kPerBindRestInvNTBs], mPerBindRestInvNTBs);
 
 	j[kJDataHash] = calcHash();
 
@@ -74,6 +82,7 @@ bool FastCurvesDeformerData::readFromJSON(const json& j) {
 	from_json(j[kJRestVertexNormals], mRestVertexNormals);
 	from_json(j[kPerBindRestNormals], mPerBindRestNormals);
 	from_json(j[kPerBindrBindRestTBs], mPerBindRestTBs);
+	from_json(j[kPerBindRestInvNTBs], mPerBindRestInvNTBs);
 
 	if(j[kJDataHash].template get<size_t>() != calcHash()) {
 		LOG_ERR << typeName() << " json data hash mismatch !";
@@ -86,6 +95,41 @@ bool FastCurvesDeformerData::readFromJSON(const json& j) {
 	return true;
 }
 
+bool FastCurvesDeformerData::dumpToBinary(BinaryDataWriter& writer) const {
+	writer.addBlock(kJCurveBinds, mCurveBinds);
+	writer.addBlock(kJRestVertexNormals, mRestVertexNormals);
+	writer.addBlock(kPerBindRestNormals, mPerBindRestNormals);
+	writer.addBlock(kPerBindrBindRestTBs, mPerBindRestTBs);
+	writer.addBlock(kPerBindRestInvNTBs, mPerBindRestInvNTBs);
+	writer.addValue(kJDataHash, static_cast<uint64_t>(calcHash()));
+
+	return true;
+}
+
+bool FastCurvesDeformerData::readFromBinary(const BinaryDataReader& reader) {
+	mIsValid = false;
+
+	uint64_t data_hash;
+	if(!reader.readBlock(kJCurveBinds, mCurveBinds) ||
+		!reader.readBlock(kJRestVertexNormals, mRestVertexNormals) ||
+		!reader.readBlock(kPerBindRestNormals, mPerBindRestNormals) ||
+		!reader.readBlock(kPerBindrBindRestTBs, mPerBindRestTBs) ||
+		!reader.readBlock(kPerBindRestInvNTBs, mPerBindRestInvNTBs) ||
+		!reader.readValue(kJDataHash, data_hash)) {
+		return false;
+	}
+
+	if(data_hash != calcHash()) {
+		LOG_ERR << typeName() << " binary data hash mismatch !";
+		return false;
+	}
+
+	LOG_DBG << "FastCurvesDeformerData data read from binary payload !";
+
+	mIsValid = true;
+	return true;
+}
+
 const std::string& FastCurvesDeformerData::typeName() const {
 	static const std::string kTypeName = "FastCurvesDeformerData";
 	return kTypeName;
@@ -8,6 +8,7 @@
 #include <string>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usdGeom/curves.h>
+#include <pxr/base/gf/matrix3f.h>
 
 #include <glm/vec3.hpp> // glm::vec3
 
@@ -29,6 +30,7 @@ class FastCurvesDeformerData : public SerializableDeformerDataBase {
 		const std::vector<pxr::GfVec3f>&        					getRestVertexNormals() const { return mRestVertexNormals; }
 		const std::vector<pxr::GfVec3f>&        					getPerBindRestNormals() const { return mPerBindRestNormals; }
 		const std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>& 	getPerBindRestTBs()	const { return mPerBindRestTBs; }
+		const std::vector<pxr::GfMatrix3f>&							getPerBindRestInvNTBs() const { return mPerBindRestInvNTBs; }
 
 		virtual bool isValid() const override { const std::lock_guard<std::mutex> lock(mMutex); return mIsValid; }
 
@@ -42,6 +44,10 @@ class FastCurvesDeformerData : public SerializableDeformerDataBase {
 		virtual bool dumpToJSON(json& j) const override;
 		virtual bool readFromJSON(const json& j) override;
 
+		virtual bool hasBinaryLayout() const override { return true; }
+		virtual bool dumpToBinary(BinaryDataWriter& writer) const override;
+		virtual bool readFromBinary(const BinaryDataReader& reader) override;
+
 		virtual void clearData() override;
 
 	private:
@@ -52,6 +58,7 @@ class FastCurvesDeformerData : public SerializableDeformerDataBase {
 		std::vector<pxr::GfVec3f> 							mRestVertexNormals;
 		std::vector<pxr::GfVec3f>               			mPerBindRestNormals;
 		std::vector<std::pair<pxr::GfVec3f,pxr::GfVec3f>>   mPerBindRestTBs; // per curve-bind binormal and bangent vector pairs
+		std::vector<pxr::GfMatrix3f>                        mPerBindRestInvNTBs; // per curve-bind inverted rest NTB matrices
 
 		bool mIsValid;
 
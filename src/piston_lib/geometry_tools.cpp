@@ -5,6 +5,7 @@
 #include <pxr/base/gf/math.h>
 
 #include <limits>
+#include <algorithm>
 
 #define CHECK_PARALLEL
 
@@ -18,6 +19,48 @@ static const pxr::GfMatrix3f kRotMat180 = {
 	0.f, 0.f,-1.f
 };
 
+// Spreads lower 10 bits so there are two zero bits between each
+static inline uint32_t expandMortonBits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+void buildMortonOrder(const std::vector<pxr::GfVec3f>& points, std::vector<uint32_t>& order) {
+    order.resize(points.size());
+    if(points.empty()) return;
+
+    pxr::GfVec3f bmin(std::numeric_limits<float>::max());
+    pxr::GfVec3f bmax(std::numeric_limits<float>::lowest());
+    for (const auto& p : points) {
+        for (int i = 0; i < 3; ++i) {
+            bmin[i] = std::min(bmin[i], p[i]);
+            bmax[i] = std::max(bmax[i], p[i]);
+        }
+    }
+
+    pxr::GfVec3f scale;
+    for (int i = 0; i < 3; ++i) {
+        const float extent = bmax[i] - bmin[i];
+        scale[i] = (extent > 0.f) ? 1023.f / extent : 0.f;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> codes(points.size()); // <morton code, point index>
+    for (size_t i = 0; i < points.size(); ++i) {
+        const pxr::GfVec3f p = points[i] - bmin;
+        auto quantize = [&](int axis) { return std::min(static_cast<uint32_t>(p[axis] * scale[axis]), 1023u); };
+        codes[i].first = (expandMortonBits(quantize(0)) << 2) | (expandMortonBits(quantize(1)) << 1) | expandMortonBits(quantize(2));
+        codes[i].second = static_cast<uint32_t>(i);
+    }
+    std::sort(codes.begin(), codes.end());
+
+    for (size_t i = 0; i < codes.size(); ++i) {
+        order[i] = codes[i].second;
+    }
+}
+
 pxr::GfMatrix3f rotateAlign(const pxr::GfVec3f& n1, const pxr::GfVec3f& n2) {
     const float cosA = pxr::GfDot(n1, n2);
     const pxr::GfVec3f axis = pxr::GfCross(n1, n2);
@@ -182,7 +225,24 @@ bool rayTriangleIntersect(const pxr::GfVec3f &orig, const pxr::GfVec3f &dir, con
 }
 
 template <typename T>
-void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const T& pt_positions, BS::thread_pool<BS::tp::none>* pThreadPool) {
+static inline pxr::GfVec3f calcVertexNormal(const UsdGeomMeshFaceAdjacency* pAdjacency, const T& pt_positions, uint32_t vtx) {
+    pxr::GfVec3f vn = {0.f, 0.f, 0.f};
+
+    const uint32_t edges_count = pAdjacency->getNeighborsCount(vtx);
+    const uint32_t vtx_offset = pAdjacency->getNeighborsOffset(vtx);
+    
+    for(uint32_t i = 0; i < edges_count; ++i) {
+        const auto& vtx_pair = pAdjacency->getCornerVertexPair(vtx_offset + i);
+        vn += pxr::GfGetNormalized(pxr::GfCross(pt_positions[vtx_pair.first] - pt_positions[vtx], pt_positions[vtx_pair.second] - pt_positions[vtx])
+            , MIN_VECTOR_LENGTH_F
+        );
+    }
+
+    return pxr::GfGetNormalized(vn, MIN_VECTOR_LENGTH_F);
+}
+
+template <typename T>
+void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const T& pt_positions, ThreadPool* pThreadPool) {
     static_assert(std::is_same_v<T, std::vector<pxr::GfVec3f>> || std::is_same_v<T, pxr::VtArray<pxr::GfVec3f>>, "Only std::vector<pxr::GfVec3f> and pxr::VtArray<pxr::GfVec3f> types are permitted!");    
     assert(pAdjacency);
     assert(pTrimesh);
@@ -191,21 +251,8 @@ void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const Phanto
     const std::vector<PhantomTrimesh::PxrIndexType>& vertices = pTrimesh->getVertices();
     
     auto func = [&](const std::size_t vertex_index) {
-        pxr::GfVec3f vn = {0.f, 0.f, 0.f};
-
         const auto& vtx = vertices[vertex_index];
-
-        const uint32_t edges_count = pAdjacency->getNeighborsCount(vtx);
-        const uint32_t vtx_offset = pAdjacency->getNeighborsOffset(vtx);
-        
-        for(uint32_t i = 0; i < edges_count; ++i) {
-            const auto& vtx_pair = pAdjacency->getCornerVertexPair(vtx_offset + i);
-            vn += pxr::GfGetNormalized(pxr::GfCross(pt_positions[vtx_pair.first] - pt_positions[vtx], pt_positions[vtx_pair.second] - pt_positions[vtx])
-                , MIN_VECTOR_LENGTH_F
-            );
-        }
-
-        vertex_normals[vtx] = pxr::GfGetNormalized(vn, MIN_VECTOR_LENGTH_F);
+        vertex_normals[vtx] = calcVertexNormal(pAdjacency, pt_positions, vtx);
     };
 
     if(pThreadPool) {
@@ -218,6 +265,28 @@ void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const Phanto
     }
 }
 
+template <typename T>
+void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const std::vector<uint32_t>& vertex_indices, std::vector<pxr::GfVec3f>& vertex_normals, const T& pt_positions, ThreadPool* pThreadPool) {
+    static_assert(std::is_same_v<T, std::vector<pxr::GfVec3f>> || std::is_same_v<T, pxr::VtArray<pxr::GfVec3f>>, "Only std::vector<pxr::GfVec3f> and pxr::VtArray<pxr::GfVec3f> types are permitted!");    
+    assert(pAdjacency);
+
+    vertex_normals.resize(pAdjacency->getVertexCount());
+
+    auto func = [&](const std::size_t start, const std::size_t end) {
+        for(size_t i = start; i < end; ++i) {
+            const uint32_t vtx = vertex_indices[i];
+            vertex_normals[vtx] = calcVertexNormal(pAdjacency, pt_positions, vtx);
+        }
+    };
+
+    if(pThreadPool) {
+        BS::multi_future<void> blocks = pThreadPool->submit_blocks(size_t(0), vertex_indices.size(), func);
+        blocks.wait();
+    } else {
+        func(0u, vertex_indices.size());
+    }
+}
+
 void buildRotationMinimizingFrames(const pxr::GfVec3f* pCurveRootPt, size_t curve_points_count, const pxr::GfVec3f& root_tangent, const pxr::GfVec3f& root_up_vector, std::vector<NTBFrame> v) {
     v.resize(curve_points_count);
     buildRotationMinimizingFrames(pCurveRootPt, curve_points_count, root_tangent, root_up_vector, v.begin(), v.end());
@@ -325,7 +394,10 @@ template bool validatePrimIndices(const pxr::VtArray<int>& indices, size_t expec
 template bool validatePrimIndices(const std::vector<int>& indices, size_t expected_attrib_count, int max_prim_id, LoggerStream* pLogger);
 template bool validatePrimIndices(const pxr::VtArray<int>& indices, size_t expected_attrib_count, int max_prim_id, LoggerStream* pLogger);
 
-template void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const std::vector<pxr::GfVec3f>& pt_positions, BS::thread_pool<BS::tp::none>* pThreadPool);
-template void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const pxr::VtArray<pxr::GfVec3f>& pt_positions, BS::thread_pool<BS::tp::none>* pThreadPool);
+template void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const std::vector<pxr::GfVec3f>& pt_positions, ThreadPool* pThreadPool);
+template void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const pxr::VtArray<pxr::GfVec3f>& pt_positions, ThreadPool* pThreadPool);
+
+template void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const std::vector<uint32_t>& vertex_indices, std::vector<pxr::GfVec3f>& vertex_normals, const std::vector<pxr::GfVec3f>& pt_positions, ThreadPool* pThreadPool);
+template void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const std::vector<uint32_t>& vertex_indices, std::vector<pxr::GfVec3f>& vertex_normals, const pxr::VtArray<pxr::GfVec3f>& pt_positions, ThreadPool* pThreadPool);
 
 } // namespace Piston
\ No newline at end of file
@@ -8,7 +8,7 @@
 #include <memory>
 #include <string>
 
-#include "BS_thread_pool.hpp"
+#include "thread_pool.h"
 
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usdGeom/mesh.h>
@@ -206,7 +206,14 @@ bool rayTriangleIntersect(const pxr::GfVec3f &orig, const pxr::GfVec3f &dir, con
 bool rayTriangleIntersect(const pxr::GfVec3f &orig, const pxr::GfVec3f &dir, const pxr::GfVec3f &v0, const pxr::GfVec3f &v1, const pxr::GfVec3f &v2, float &dist, float &u, float &v);
 
 template <typename T>
-void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const T& pt_positions, BS::thread_pool<BS::tp::none>* pThreadPool = nullptr);
+void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const PhantomTrimesh* pTrimesh, std::vector<pxr::GfVec3f>& vertex_normals, const T& pt_positions, ThreadPool* pThreadPool = nullptr);
+
+// Builds normals only for listed vertices. Other vertex_normals elements are left untouched.
+template <typename T>
+void buildVertexNormals(const UsdGeomMeshFaceAdjacency* pAdjacency, const std::vector<uint32_t>& vertex_indices, std::vector<pxr::GfVec3f>& vertex_normals, const T& pt_positions, ThreadPool* pThreadPool = nullptr);
+
+// Indices of points sorted along 30 bit morton curve within points bounds. Used to process spatial queries in coherent order
+void buildMortonOrder(const std::vector<pxr::GfVec3f>& points, std::vector<uint32_t>& order);
 
 void buildRotationMinimizingFrames(const pxr::GfVec3f* pCurveRootPt, size_t curve_points_count, const pxr::GfVec3f& root_tangent, const pxr::GfVec3f& root_up_vector, std::vector<NTBFrame> v);
 void buildRotationMinimizingFrames(const pxr::GfVec3f* pCurveRootPt, size_t curve_points_count, const pxr::GfVec3f& root_tangent, const pxr::GfVec3f& root_up_vector, std::vector<NTBFrame>::iterator it_begin, std::vector<NTBFrame>::iterator it_end);
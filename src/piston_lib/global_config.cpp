@@ -1,18 +1,26 @@
 #include "global_config.h"
+#include "thread_pool.h"
 #include "logging.h"
 #include "version/version.h" // Generated by CMake
 
 #include <algorithm>
 #include <cctype>
+#include <limits>
+#include <thread>
 
 
 namespace Piston {
 
 static const bool sPointCacheDefaultState = false;
 static const bool sDataInstancingDefaultState = true;
+static const size_t sPointCacheSpillDefaultBudget = 0;
 static const pxr::SdfPath sDefaultPrimPath("/__piston_data__");
 static const GlobalConfig::DataToPrimStorageMethod sDefaultDataToPrimStorage(GlobalConfig::DataToPrimStorageMethod::ATTRIBUTE);
 
+static size_t defaultThreadsCount() {
+	return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
 static constexpr size_t kDefaultPxrPointsLRUCacheMaxSize = 1024 * 1024 * 256 * 4; 
 
 static std::string tolower(std::string s) {
@@ -43,6 +51,26 @@ bool GlobalConfig::getPointsCacheUsageState() const {
 	return mPointCacheState;
 }
 
+void GlobalConfig::setPointsCacheSpillBudget(size_t budget_bytes) {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	mPointCacheSpillBudget = budget_bytes;
+}
+
+size_t GlobalConfig::getPointsCacheSpillBudget() const {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	return mPointCacheSpillBudget;
+}
+
+void GlobalConfig::setPointsCacheSpillDir(const std::string& dir_path) {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	mPointCacheSpillDir = dir_path.empty() ? getTempDirPath() : dir_path;
+}
+
+std::string GlobalConfig::getPointsCacheSpillDir() const {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	return mPointCacheSpillDir;
+}
+
 void GlobalConfig::setDataInstancingState(bool state) {
 	const std::lock_guard<std::mutex> lock(mMutex);
 
@@ -85,6 +113,31 @@ GlobalConfig::DataToPrimStorageMethod GlobalConfig::getDataStorageMethod() const
 	return mDataToPrimStorageMethod;
 }
 
+void GlobalConfig::setDataSidecarDir(const std::string& dir_path) {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	mDataSidecarDir = dir_path;
+}
+
+std::string GlobalConfig::getDataSidecarDir() const {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	return mDataSidecarDir;
+}
+
+void GlobalConfig::setThreadsCount(size_t threads_count) {
+	threads_count = (threads_count == 0) ? defaultThreadsCount() : threads_count;
+	{
+		const std::lock_guard<std::mutex> lock(mMutex);
+		if(mThreadsCount == threads_count) return;
+		mThreadsCount = threads_count;
+	}
+	SharedThreadPool::setThreadsCount(threads_count);
+}
+
+size_t GlobalConfig::getThreadsCount() const {
+	const std::lock_guard<std::mutex> lock(mMutex);
+	return mThreadsCount;
+}
+
 GlobalConfig::~GlobalConfig() {
 	//SimpleProfiler::printReport();
 }
@@ -94,7 +147,10 @@ GlobalConfig::GlobalConfig():
 	mDefaultRestTimeCode(pxr::UsdTimeCode::Default()), 
 	mDefaultDataPrimPath(sDefaultPrimPath), 
 	mPointCacheState(sPointCacheDefaultState), 
-	mDataInstancingState(sDataInstancingDefaultState) 
+	mPointCacheSpillBudget(sPointCacheSpillDefaultBudget),
+	mPointCacheSpillDir(getTempDirPath()),
+	mDataInstancingState(sDataInstancingDefaultState),
+	mThreadsCount(defaultThreadsCount())
 	{
 	
 	std::cout << std::endl;
@@ -117,6 +173,31 @@ GlobalConfig::GlobalConfig():
 
 	LOG_INF << "Point cache is " << (mPointCacheState ? "ENABLED" : "DISABLED");
 
+	std::string spill_size_string;
+	if(getEnvVar("PISTON_PTCACHE_SPILL_SIZE", spill_size_string)) {
+		try {
+			const long long spill_size_mb = std::stoll(spill_size_string);
+			if(spill_size_mb >= 0 && static_cast<unsigned long long>(spill_size_mb) <= (std::numeric_limits<size_t>::max() >> 20)) {
+				mPointCacheSpillBudget = static_cast<size_t>(spill_size_mb) << 20;
+			} else {
+				LOG_ERR << "Invalid \"PISTON_PTCACHE_SPILL_SIZE\" environment variable value " << spill_size_mb << " ! Spill is disabled.";
+			}
+		} catch (const std::invalid_argument& e) {
+			LOG_ERR << "Invalid \"PISTON_PTCACHE_SPILL_SIZE\" environment variable: " << e.what();
+		} catch (const std::out_of_range& e) {
+			LOG_ERR << "\"PISTON_PTCACHE_SPILL_SIZE\" environment variable out of range: " << e.what();
+		}
+	}
+
+	std::string spill_dir_string;
+	if(getEnvVar("PISTON_PTCACHE_SPILL_DIR", spill_dir_string) && !spill_dir_string.empty()) {
+		mPointCacheSpillDir = spill_dir_string;
+	}
+
+	if(mPointCacheSpillBudget > 0) {
+		LOG_INF << "Point cache spill budget is " << (mPointCacheSpillBudget / (1024 * 1024)) << "MB in \"" << mPointCacheSpillDir << "\"";
+	}
+
 	std::string data_instancing_var_value;
 	if(getEnvVar("PISTON_DATA_INSTANCING", data_instancing_var_value)) {
 		data_instancing_var_value = tolower(data_instancing_var_value) ;
@@ -128,6 +209,23 @@ GlobalConfig::GlobalConfig():
 	}
 	LOG_INF << "Deformers data instancing is " << (mDataInstancingState ? "ON" : "OFF");
 
+	std::string threads_count_string;
+	if(getEnvVar("PISTON_THREADS", threads_count_string)) {
+		try {
+			const int threads_count = std::stoi(threads_count_string);
+			if(threads_count > 0) {
+				mThreadsCount = static_cast<size_t>(threads_count);
+			} else {
+				LOG_ERR << "Invalid \"PISTON_THREADS\" environment variable value " << threads_count << " ! Using default threads count.";
+			}
+		} catch (const std::invalid_argument& e) {
+			LOG_ERR << "Invalid \"PISTON_THREADS\" environment variable: " << e.what();
+		} catch (const std::out_of_range& e) {
+			LOG_ERR << "\"PISTON_THREADS\" environment variable out of range: " << e.what();
+		}
+	}
+	LOG_INF << "Threads budget is " << mThreadsCount;
+
 	std::string tpose_default_frame_string;
 	if(getEnvVar("PISTON_DEFAULT_TPOSE_FRAME", tpose_default_frame_string)) {
 		try {
@@ -165,6 +263,8 @@ GlobalConfig::GlobalConfig():
 			mDataToPrimStorageMethod = DataToPrimStorageMethod::METADATA;
 		} else if (tolower(data_to_prim_storage_method) == "attribute") {
 			mDataToPrimStorageMethod = DataToPrimStorageMethod::ATTRIBUTE;
+		} else if (tolower(data_to_prim_storage_method) == "sidecar") {
+			mDataToPrimStorageMethod = DataToPrimStorageMethod::SIDECAR;
 		} else {
 			LOG_ERR << "Unknown data storage method \"" << data_to_prim_storage_method << "\" !!! Reverting to default method (" << to_string(default_storage_method) << ").";
 		}
@@ -172,6 +272,11 @@ GlobalConfig::GlobalConfig():
 			LOG_INF << "Data storage method is \"" << to_string(mDataToPrimStorageMethod) << "\"";
 		}
 	}
+
+	getEnvVar("PISTON_DATA_SIDECAR_DIR", mDataSidecarDir);
+	if(!mDataSidecarDir.empty() && (mDataToPrimStorageMethod == DataToPrimStorageMethod::SIDECAR)) {
+		LOG_INF << "Sidecar data directory for unsaved layers is \"" << mDataSidecarDir << "\"";
+	}
 }
 
 } // namespace Piston
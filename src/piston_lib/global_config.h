@@ -10,6 +10,7 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <cstddef>
 
 namespace Piston {
 
@@ -20,7 +21,8 @@ class GlobalConfig {
 	public:
 		enum class DataToPrimStorageMethod {
 			METADATA = 0,
-			ATTRIBUTE = 1
+			ATTRIBUTE = 1,
+			SIDECAR = 2		// external file next to the layer, referenced by asset path attribute
 		};
 
 	public:
@@ -39,6 +41,12 @@ class GlobalConfig {
 		void setPointsCacheUsageState(bool state);
 		bool getPointsCacheUsageState() const;
 
+		// Points cache disk spill tier. Zero budget disables it. Applied when points cache is (re)created
+		void setPointsCacheSpillBudget(size_t budget_bytes);
+		size_t getPointsCacheSpillBudget() const;
+		void setPointsCacheSpillDir(const std::string& dir_path);
+		std::string getPointsCacheSpillDir() const;
+
 		void setDefaultRestTimeCode(pxr::UsdTimeCode time_code);
 		pxr::UsdTimeCode getDefaultRestTimeCode()const ;
 
@@ -48,6 +56,14 @@ class GlobalConfig {
 
 		DataToPrimStorageMethod getDataStorageMethod() const;
 
+		// Directory for sidecar data files of layers that are not saved on disk. Empty means such data is stored as attribute
+		void setDataSidecarDir(const std::string& dir_path);
+		std::string getDataSidecarDir() const;
+
+		// Shared thread pool workers budget. Changing it restarts the shared pool.
+		void setThreadsCount(size_t threads_count);
+		size_t getThreadsCount() const;
+
 	private:
 		// Mutex to ensure thread safety
     	static std::mutex mMutex;
@@ -57,10 +73,14 @@ class GlobalConfig {
 
     private:
     	DataToPrimStorageMethod 	mDataToPrimStorageMethod;
+    	std::string                 mDataSidecarDir;
     	pxr::UsdTimeCode 			mDefaultRestTimeCode;
     	pxr::SdfPath    		 	mDefaultDataPrimPath;
     	bool                        mPointCacheState;
+    	size_t                      mPointCacheSpillBudget;
+    	std::string                 mPointCacheSpillDir;
     	bool                        mDataInstancingState;
+    	size_t                      mThreadsCount;
 
     	GlobalConfig();
 };
@@ -69,6 +89,8 @@ inline std::string to_string(const GlobalConfig::DataToPrimStorageMethod& m) {
 	switch(m) {
 		case GlobalConfig::DataToPrimStorageMethod::METADATA:
 			return "METADATA";
+		case GlobalConfig::DataToPrimStorageMethod::SIDECAR:
+			return "SIDECAR";
 		case GlobalConfig::DataToPrimStorageMethod::ATTRIBUTE:
 		default:
 			return "ATTRIBUTE"; 
@@ -1,4 +1,5 @@
 #include "guide_curves_container.h"
+#include "geometry_tools.h"
 #include "logging.h"
 
 #include <limits>
@@ -223,14 +224,9 @@ pxr::GfVec3f GuideCurvesContainer::getPointAtU(uint32_t curve_index, float u, bo
 
 // KDTree
 
-USDCurveKDTree::USDCurveKDTree(const pxr::UsdGeomCurves& usdCurves, pxr::UsdTimeCode time_code) {
-    pxr::VtArray<pxr::GfVec3f> points;
-    pxr::VtArray<int> curveVertexCounts;
-    
-    usdCurves.GetPointsAttr().Get(&points, time_code);
-    usdCurves.GetCurveVertexCountsAttr().Get(&curveVertexCounts, time_code);
+namespace {
 
-    std::vector<CurvePoint> flatPoints;
+void collectCurvePoints(const pxr::VtArray<pxr::GfVec3f>& points, const pxr::VtArray<int>& curveVertexCounts, std::vector<USDCurveKDTree::CurvePoint>& flatPoints) {
     flatPoints.reserve(points.size());
 
     size_t pointOffset = 0;
@@ -239,247 +235,278 @@ USDCurveKDTree::USDCurveKDTree(const pxr::UsdGeomCurves& usdCurves, pxr::UsdTime
         if (numPoints <= 0) continue;
 
         for (int p = 0; p < numPoints; ++p) {
-            CurvePoint cp;
+            USDCurveKDTree::CurvePoint cp;
             cp.position = points[pointOffset + p];
             cp.curveIndex = c;
             cp.segmentIndex = p;
 
             // Tag structural curve topology positions
             if (p == 0) {
-                cp.positionType = CurvePositionType::Root;
+                cp.positionType = USDCurveKDTree::CurvePositionType::Root;
             } else if (p == numPoints - 1) {
-                cp.positionType = CurvePositionType::Tip;
+                cp.positionType = USDCurveKDTree::CurvePositionType::Tip;
             } else {
-                cp.positionType = CurvePositionType::Internal;
+                cp.positionType = USDCurveKDTree::CurvePositionType::Internal;
             }
 
             flatPoints.push_back(cp);
         }
         pointOffset += numPoints;
     }
-
-    mpRootNode = buildTreeRec(flatPoints, 0, 0, flatPoints.size());
 }
 
-USDCurveKDTree::USDCurveKDTree(const GuideCurvesContainer* pCurvesContainer) {
+} // namespace
 
-	std::vector<CurvePoint> flatPoints;
-	flatPoints.reserve(pCurvesContainer->getTotalVertexCount());
+USDCurveKDTree::USDCurveKDTree(const pxr::UsdGeomCurves& usdCurves, pxr::UsdTimeCode time_code) {
+    pxr::VtArray<pxr::GfVec3f> points;
+    pxr::VtArray<int> curveVertexCounts;
+    
+    usdCurves.GetPointsAttr().Get(&points, time_code);
+    usdCurves.GetCurveVertexCountsAttr().Get(&curveVertexCounts, time_code);
 
-	const auto& points = pCurvesContainer->getRestCurvePoints();
-	const auto& curveVertexCounts = pCurvesContainer->getCurveVertexCounts();
+    std::vector<CurvePoint> flatPoints;
+    collectCurvePoints(points, curveVertexCounts, flatPoints);
+    build(flatPoints);
+}
 
-	size_t pointOffset = 0;
-    for (size_t c = 0; c < curveVertexCounts.size(); ++c) {
-        int numPoints = curveVertexCounts[c];
-        if (numPoints <= 0) continue;
+USDCurveKDTree::USDCurveKDTree(const GuideCurvesContainer* pCurvesContainer) {
+    assert(pCurvesContainer);
 
-        for (int p = 0; p < numPoints; ++p) {
-            CurvePoint cp;
-            cp.position = points[pointOffset + p];
-            cp.curveIndex = c;
-            cp.segmentIndex = p;
+    std::vector<CurvePoint> flatPoints;
+    collectCurvePoints(pCurvesContainer->getRestCurvePoints(), pCurvesContainer->getCurveVertexCounts(), flatPoints);
+    build(flatPoints);
+}
 
-            // Tag structural curve topology positions
-            if (p == 0) {
-                cp.positionType = CurvePositionType::Root;
-            } else if (p == numPoints - 1) {
-                cp.positionType = CurvePositionType::Tip;
-            } else {
-                cp.positionType = CurvePositionType::Internal;
-            }
+void USDCurveKDTree::build(std::vector<CurvePoint>& flatPoints) {
+    std::vector<CurvePoint> rootPoints;
+    std::vector<CurvePoint> tipPoints;
 
-            flatPoints.push_back(cp);
+    for (const auto& cp : flatPoints) {
+        if (cp.positionType == CurvePositionType::Root) {
+            rootPoints.push_back(cp);
+        } else if (cp.positionType == CurvePositionType::Tip) {
+            tipPoints.push_back(cp);
         }
-        pointOffset += numPoints;
     }
 
-	mpRootNode = buildTreeRec(flatPoints, 0, 0, flatPoints.size());
+    buildTree(mAllTree, std::move(flatPoints));
+    buildTree(mRootsTree, std::move(rootPoints));
+    buildTree(mTipsTree, std::move(tipPoints));
 }
 
-std::shared_ptr<USDCurveKDTree::KDNode> USDCurveKDTree::buildTreeRec(std::vector<USDCurveKDTree::CurvePoint>& points, int depth, int start, int end) {
-    if (start >= end) return nullptr;
+void USDCurveKDTree::buildTree(Tree& tree, std::vector<CurvePoint>&& points) {
+    buildTreeRec(points, 0, 0, points.size());
 
-    int axis = depth % 3;
+    tree.points = std::move(points);
+    tree.positions.resize(tree.points.size());
+    for (size_t i = 0; i < tree.points.size(); ++i) {
+        tree.positions[i] = tree.points[i].position;
+    }
+}
 
-    std::sort(points.begin() + start, points.begin() + end, [axis](const CurvePoint& a, const CurvePoint& b) {
-        return a.position[axis] < b.position[axis];
-    });
+void USDCurveKDTree::buildTreeRec(std::vector<CurvePoint>& points, int depth, size_t start, size_t end) {
+    if ((end - start) <= kLeafSize) return;
 
-    int medianIndex = start + (end - start) / 2;
-    auto pNode = std::make_shared<KDNode>(points[medianIndex]);
+    const int axis = depth % 3;
+    const size_t medianIndex = start + (end - start) / 2;
 
-    pNode->left = buildTreeRec(points, depth + 1, start, medianIndex);
-    pNode->right = buildTreeRec(points, depth + 1, medianIndex + 1, end);
+    std::nth_element(points.begin() + start, points.begin() + medianIndex, points.begin() + end, [axis](const CurvePoint& a, const CurvePoint& b) {
+        return a.position[axis] < b.position[axis];
+    });
 
-    return pNode;
+    buildTreeRec(points, depth + 1, start, medianIndex);
+    buildTreeRec(points, depth + 1, medianIndex + 1, end);
 }
 
-void USDCurveKDTree::searchNearestRec(const std::shared_ptr<USDCurveKDTree::KDNode>& pNode, const pxr::GfVec3f& query, int depth,
-	const std::vector<USDCurveKDTree::CurvePositionType>& allowedTypes, const std::optional<size_t>& ignore_curve_id,
-	std::shared_ptr<KDNode>& bestNode, float& bestDistSq) const {
-
-    if (!pNode) return;
-
-    // Structural Filter Checks
-    bool idMatch = ignore_curve_id.has_value() && (pNode->point.curveIndex == *ignore_curve_id);
-    bool typeMatch = true;
-    
-    if (!allowedTypes.empty()) {
-        typeMatch = std::find(allowedTypes.begin(), allowedTypes.end(), pNode->point.positionType) != allowedTypes.end();
+const USDCurveKDTree::Tree& USDCurveKDTree::getTree(TreeType type) const {
+    switch (type) {
+        case TreeType::Roots: return mRootsTree;
+        case TreeType::Tips: return mTipsTree;
+        default: return mAllTree;
     }
+}
 
-    if (!idMatch && typeMatch) {
-        float distSq = (pNode->point.position - query).GetLengthSq();
-        if (distSq < bestDistSq) {
-            bestDistSq = distSq;
-            bestNode = pNode;
-        }
+void USDCurveKDTree::KNNBuffer::insert(uint32_t index, float distSq) {
+    size_t pos;
+    if (size < k) {
+        pos = size++;
+    } else if (distSq < items[k - 1].distSq) {
+        pos = k - 1; // Evict the furthest element out of the current K matches
+    } else {
+        return;
     }
 
-    // Standard spatial tree traversal logic
-    int axis = depth % 3;
-    float diff = query[axis] - pNode->point.position[axis];
-
-    std::shared_ptr<KDNode> nextBranch = (diff < 0) ? pNode->left : pNode->right;
-    std::shared_ptr<KDNode> otherBranch = (diff < 0) ? pNode->right : pNode->left;
-
-    searchNearestRec(nextBranch, query, depth + 1, allowedTypes, ignore_curve_id, bestNode, bestDistSq);
-
-    if ((diff * diff) < bestDistSq) {
-        searchNearestRec(otherBranch, query, depth + 1, allowedTypes, ignore_curve_id, bestNode, bestDistSq);
+    while (pos > 0 && items[pos - 1].distSq > distSq) {
+        items[pos] = items[pos - 1];
+        --pos;
     }
+    items[pos] = {index, distSq};
 }
 
-void USDCurveKDTree::searchKNearestRec(const std::shared_ptr<USDCurveKDTree::KDNode>& pNode, const pxr::GfVec3f& query, int depth, size_t k,
-	const std::vector<USDCurveKDTree::CurvePositionType>& allowedTypes, const std::optional<size_t>& ignore_curve_id, std::priority_queue<USDCurveKDTree::KNNCandidate>& maxHeap) const {
-    
-    if (!pNode) return;
-
-    // 1. Evaluate spatial and structural constraints
-    bool idMatch = ignore_curve_id.has_value() && (pNode->point.curveIndex == *ignore_curve_id);
-    bool typeMatch = true;
-    if (!allowedTypes.empty()) {
-        typeMatch = std::find(allowedTypes.begin(), allowedTypes.end(), pNode->point.positionType) != allowedTypes.end();
-    }
+void USDCurveKDTree::searchKNearestRec(const Tree& tree, const pxr::GfVec3f& query, int depth, size_t start, size_t end, size_t ignore_curve_id, KNNBuffer& buffer) const {
+    auto testPoint = [&](const size_t i) {
+        if (tree.points[i].curveIndex == ignore_curve_id) return;
+        const float distSq = (tree.positions[i] - query).GetLengthSq();
+        if (distSq < buffer.worstDistSq()) {
+            buffer.insert(static_cast<uint32_t>(i), distSq);
+        }
+    };
 
-    if (!idMatch && typeMatch) {
-        float distSq = (pNode->point.position - query).GetLengthSq();
-        
-        if (maxHeap.size() < k) {
-            maxHeap.push({pNode->point, distSq});
-        } else if (distSq < maxHeap.top().distSq) {
-            maxHeap.pop(); // Evict the furthest element out of the current K matches
-            maxHeap.push({pNode->point, distSq});
+    if ((end - start) <= kLeafSize) {
+        for (size_t i = start; i < end; ++i) {
+            testPoint(i);
         }
+        return;
     }
 
-    // 2. Traversal sorting logic
-    int axis = depth % 3;
-    float diff = query[axis] - pNode->point.position[axis];
+    const size_t medianIndex = start + (end - start) / 2;
+    testPoint(medianIndex);
 
-    std::shared_ptr<KDNode> nextBranch = (diff < 0) ? pNode->left : pNode->right;
-    std::shared_ptr<KDNode> otherBranch = (diff < 0) ? pNode->right : pNode->left;
+    const int axis = depth % 3;
+    const float diff = query[axis] - tree.positions[medianIndex][axis];
 
-    searchKNearestRec(nextBranch, query, depth + 1, k, allowedTypes, ignore_curve_id, maxHeap);
-
-    // 3. Dynamic Pruning: Only check the other side if it can beat our worst element in the heap
-    float currentWorstDistSq = (maxHeap.size() < k) ? std::numeric_limits<float>::max() : maxHeap.top().distSq;
-    if ((diff * diff) < currentWorstDistSq) {
-        searchKNearestRec(otherBranch, query, depth + 1, k, allowedTypes, ignore_curve_id, maxHeap);
+    // Visit query side first. Only check the other side if it can beat our worst element in the buffer
+    if (diff < 0.f) {
+        searchKNearestRec(tree, query, depth + 1, start, medianIndex, ignore_curve_id, buffer);
+        if ((diff * diff) < buffer.worstDistSq()) {
+            searchKNearestRec(tree, query, depth + 1, medianIndex + 1, end, ignore_curve_id, buffer);
+        }
+    } else {
+        searchKNearestRec(tree, query, depth + 1, medianIndex + 1, end, ignore_curve_id, buffer);
+        if ((diff * diff) < buffer.worstDistSq()) {
+            searchKNearestRec(tree, query, depth + 1, start, medianIndex, ignore_curve_id, buffer);
+        }
     }
 }
 
-std::vector<std::pair<USDCurveKDTree::CurvePoint, float>> USDCurveKDTree::finalizeKNN(std::priority_queue<USDCurveKDTree::KNNCandidate>& maxHeap) const {
-    std::vector<std::pair<CurvePoint, float>> results;
-    results.reserve(maxHeap.size());
-    
-    while (!maxHeap.empty()) {
-        auto top = maxHeap.top();
-        results.push_back({top.point, std::sqrt(top.distSq)});
-        maxHeap.pop();
+void USDCurveKDTree::searchKNearest(const Tree& tree, const pxr::GfVec3f& query, size_t ignore_curve_id, KNNBuffer& buffer) const {
+    if (tree.points.empty()) return;
+    searchKNearestRec(tree, query, 0, 0, tree.points.size(), ignore_curve_id, buffer);
+}
+
+std::vector<USDCurveKDTree::KNNResult> USDCurveKDTree::finalizeKNN(const Tree& tree, const KNNBuffer& buffer) const {
+    std::vector<KNNResult> results;
+    results.reserve(buffer.size);
+    for (size_t i = 0; i < buffer.size; ++i) {
+        results.push_back({tree.points[buffer.items[i].index], std::sqrt(buffer.items[i].distSq)});
     }
-    // Max-heap pops items from furthest to closest; reverse to get closest first
-    std::reverse(results.begin(), results.end());
     return results;
 }
 
 bool USDCurveKDTree::findNearestPoint(const pxr::GfVec3f& query, USDCurveKDTree::CurvePoint& result, float& outDistance, std::optional<size_t> ignore_curve_id) const {
+    KNNBuffer buffer(1);
+    searchKNearest(mAllTree, query, ignore_curve_id.value_or(kNoCurve), buffer);
 
-    assert(mpRootNode);
-
-    std::shared_ptr<KDNode> bestNode = nullptr;
-    float bestDistSq = std::numeric_limits<float>::max();
-
-    searchNearestRec(mpRootNode, query, 0, {}, ignore_curve_id, bestNode, bestDistSq);
-
-    if (bestNode) {
-        result = bestNode->point;
-        outDistance = std::sqrt(bestDistSq);
+    if (buffer.size > 0) {
+        result = mAllTree.points[buffer.items[0].index];
+        outDistance = std::sqrt(buffer.items[0].distSq);
         return true;
     }
     return false;
 }
 
 bool USDCurveKDTree::findNearestCurveRoot(const pxr::GfVec3f& query, USDCurveKDTree::CurvePoint& result, float& outDistance, std::optional<size_t> ignore_curve_id) const {
+    KNNBuffer buffer(1);
+    searchKNearest(mRootsTree, query, ignore_curve_id.value_or(kNoCurve), buffer);
 
-    assert(mpRootNode);
-
-    std::shared_ptr<KDNode> bestNode = nullptr;
-    float bestDistSq = std::numeric_limits<float>::max();
-
-    searchNearestRec(mpRootNode, query, 0, {CurvePositionType::Root}, ignore_curve_id, bestNode, bestDistSq);
-
-    if (bestNode) {
-        result = bestNode->point;
-        outDistance = std::sqrt(bestDistSq);
+    if (buffer.size > 0) {
+        result = mRootsTree.points[buffer.items[0].index];
+        outDistance = std::sqrt(buffer.items[0].distSq);
         return true;
     }
     return false;
 }
 
 bool USDCurveKDTree::findNearestCurveTip(const pxr::GfVec3f& query, USDCurveKDTree::CurvePoint& result, float& outDistance, std::optional<size_t> ignore_curve_id) const {
+    KNNBuffer buffer(1);
+    searchKNearest(mTipsTree, query, ignore_curve_id.value_or(kNoCurve), buffer);
 
-    assert(mpRootNode);
-
-    std::shared_ptr<KDNode> bestNode = nullptr;
-    float bestDistSq = std::numeric_limits<float>::max();
-
-    searchNearestRec(mpRootNode, query, 0, {CurvePositionType::Tip}, ignore_curve_id, bestNode, bestDistSq);
-
-    if (bestNode) {
-        result = bestNode->point;
-        outDistance = std::sqrt(bestDistSq);
+    if (buffer.size > 0) {
+        result = mTipsTree.points[buffer.items[0].index];
+        outDistance = std::sqrt(buffer.items[0].distSq);
         return true;
     }
     return false;
 }
 
-std::vector<std::pair<USDCurveKDTree::CurvePoint, float>> USDCurveKDTree::findKNearestPoints(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id) const {
-	
-	assert(mpRootNode);
+std::vector<USDCurveKDTree::KNNResult> USDCurveKDTree::findKNearestPoints(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id) const {
     if (k == 0) return {};
-    std::priority_queue<KNNCandidate> maxHeap;
-    searchKNearestRec(mpRootNode, query, 0, k, {}, ignore_curve_id, maxHeap);
-    return finalizeKNN(maxHeap);
+    if (k > kMaxK) {
+        LOG_ERR << "K-Nearest query size " << k << " exceeds maximum of " << kMaxK << " !";
+        return {};
+    }
+    KNNBuffer buffer(k);
+    searchKNearest(mAllTree, query, ignore_curve_id.value_or(kNoCurve), buffer);
+    return finalizeKNN(mAllTree, buffer);
 }
 
-std::vector<std::pair<USDCurveKDTree::CurvePoint, float>> USDCurveKDTree::findKNearestCurveRoots(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id) const {
-    
-	assert(mpRootNode);
+std::vector<USDCurveKDTree::KNNResult> USDCurveKDTree::findKNearestCurveRoots(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id) const {
     if (k == 0) return {};
-    std::priority_queue<KNNCandidate> maxHeap;
-    searchKNearestRec(mpRootNode, query, 0, k, {CurvePositionType::Root}, ignore_curve_id, maxHeap);
-    return finalizeKNN(maxHeap);
+    if (k > kMaxK) {
+        LOG_ERR << "K-Nearest query size " << k << " exceeds maximum of " << kMaxK << " !";
+        return {};
+    }
+    KNNBuffer buffer(k);
+    searchKNearest(mRootsTree, query, ignore_curve_id.value_or(kNoCurve), buffer);
+    return finalizeKNN(mRootsTree, buffer);
 }
 
-std::vector<std::pair<USDCurveKDTree::CurvePoint, float>> USDCurveKDTree::findKNearestCurveTips(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id) const {
-    
-	assert(mpRootNode);
+std::vector<USDCurveKDTree::KNNResult> USDCurveKDTree::findKNearestCurveTips(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id) const {
     if (k == 0) return {};
-    std::priority_queue<KNNCandidate> maxHeap;
-    searchKNearestRec(mpRootNode, query, 0, k, {CurvePositionType::Tip}, ignore_curve_id, maxHeap);
-    return finalizeKNN(maxHeap);
+    if (k > kMaxK) {
+        LOG_ERR << "K-Nearest query size " << k << " exceeds maximum of " << kMaxK << " !";
+        return {};
+    }
+    KNNBuffer buffer(k);
+    searchKNearest(mTipsTree, query, ignore_curve_id.value_or(kNoCurve), buffer);
+    return finalizeKNN(mTipsTree, buffer);
+}
+
+bool USDCurveKDTree::findKNearestBatch(TreeType type, const std::vector<pxr::GfVec3f>& queries, size_t k, std::vector<KNNResult>& outResults, std::vector<uint32_t>& outCounts,
+    const std::vector<size_t>* pIgnoreCurveIds, ThreadPool* pThreadPool) const {
+    
+    assert(!pIgnoreCurveIds || (pIgnoreCurveIds->size() == queries.size()));
+    if (k > kMaxK) {
+        LOG_ERR << "K-Nearest query size " << k << " exceeds maximum of " << kMaxK << " !";
+        outResults.clear();
+        outCounts.clear();
+        return false;
+    }
+
+    outResults.resize(queries.size() * k);
+    outCounts.assign(queries.size(), 0);
+    if (k == 0 || queries.empty()) return true;
+
+    const Tree& tree = getTree(type);
+
+    // Sort queries along morton curve so that consecutive queries touch the same tree nodes
+    std::vector<uint32_t> order;
+    buildMortonOrder(queries, order);
+
+    auto func = [&](const size_t start, const size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            const uint32_t query_index = order[i];
+            const size_t ignore_curve_id = pIgnoreCurveIds ? (*pIgnoreCurveIds)[query_index] : kNoCurve;
+
+            KNNBuffer buffer(k);
+            searchKNearest(tree, queries[query_index], ignore_curve_id, buffer);
+
+            KNNResult* pResults = outResults.data() + query_index * k;
+            for (size_t j = 0; j < buffer.size; ++j) {
+                pResults[j] = {tree.points[buffer.items[j].index], std::sqrt(buffer.items[j].distSq)};
+            }
+            outCounts[query_index] = static_cast<uint32_t>(buffer.size);
+        }
+    };
+
+    if (pThreadPool) {
+        BS::multi_future<void> blocks = pThreadPool->submit_blocks(size_t(0), order.size(), func);
+        blocks.wait();
+    } else {
+        func(0, order.size());
+    }
+
+    return true;
 }
 
 } // namespace Piston
@@ -3,6 +3,7 @@
 
 #include "framework.h"
 #include "common.h"
+#include "thread_pool.h"
 
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usdGeom/curves.h>
@@ -15,7 +16,8 @@
 #include <cmath>
 #include <algorithm>
 #include <limits>
-#include <queue>
+#include <array>
+#include <optional>
 
 namespace Piston {
 
@@ -26,6 +28,9 @@ class GuideCurvesContainer : public std::enable_shared_from_this<GuideCurvesCont
 	public:
 		static UniquePtr create();
 
+		// Deep copy. Used to give each concurrent evaluation its own live state
+		UniquePtr clone() const { return UniquePtr(new GuideCurvesContainer(*this)); }
+
 		bool init(const UsdPrimHandle& prim_handle, const std::string& rest_attr_name, pxr::UsdTimeCode reference_time_code, const pxr::VtArray<pxr::GfVec3f>* pRestPointsDataExt = nullptr, const pxr::VtArray<pxr::GfVec3f>* pLivePointsDataExt = nullptr);
 
 		bool update(const UsdPrimHandle& prim_handle, pxr::UsdTimeCode time_code, bool force);
@@ -89,6 +94,16 @@ class USDCurveKDTree {
 	    	Tip    // Last point of the curve
 		};
 
+		// Separate trees are kept for roots and tips so queries never filter by vertex type during traversal
+		enum class TreeType {
+			All,
+			Roots,
+			Tips
+		};
+
+		static constexpr size_t kMaxK = 32; // K-Nearest queries result buffer capacity
+		static constexpr size_t kNoCurve = std::numeric_limits<size_t>::max();
+
 		// Structure linking structural metadata back to the USD curve source
 		struct CurvePoint {
 		    pxr::GfVec3f position;
@@ -97,24 +112,7 @@ class USDCurveKDTree {
 		    CurvePositionType positionType;
 		};
 
-		// Heap element to track current closest neighbors during traversal
-		struct KNNCandidate {
-		    CurvePoint point;
-		    float distSq;
-
-		    // Max-heap requires the element with the LARGEST distance at the top
-		    bool operator<(const KNNCandidate& other) const {
-		        return distSq < other.distSq;
-		    }
-		};
-
-		struct KDNode {
-		    CurvePoint point;
-		    std::shared_ptr<KDNode> left;
-		    std::shared_ptr<KDNode> right;
-
-		    KDNode(const CurvePoint& pt) : point(pt), left(nullptr), right(nullptr) {}
-		};
+		using KNNResult = std::pair<CurvePoint, float>; // <point, distance>
 
 	public:
     	USDCurveKDTree(const pxr::UsdGeomCurves& usdCurves, pxr::UsdTimeCode time_code = pxr::UsdTimeCode::Default());
@@ -131,31 +129,62 @@ class USDCurveKDTree {
 
 
     	// Find K-Nearest overall points
-    	std::vector<std::pair<CurvePoint, float>> findKNearestPoints(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id = std::nullopt) const;
+    	std::vector<KNNResult> findKNearestPoints(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id = std::nullopt) const;
 
     	// Find K-Nearest curve roots
-    	std::vector<std::pair<CurvePoint, float>> findKNearestCurveRoots(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id = std::nullopt) const;
+    	std::vector<KNNResult> findKNearestCurveRoots(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id = std::nullopt) const;
 
     	// Find K-Nearest curve tips
-    	std::vector<std::pair<CurvePoint, float>> findKNearestCurveTips(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id = std::nullopt) const;
+    	std::vector<KNNResult> findKNearestCurveTips(const pxr::GfVec3f& query, size_t k, std::optional<size_t> ignore_curve_id = std::nullopt) const;
+
+    	// Batch K-Nearest query. Queries are processed in spatially coherent (morton) order. Results are stored with stride k,
+    	// outCounts holds number of neighbours found for each query. Optional per query curve ids to ignore (kNoCurve for none).
+    	// All K-Nearest queries reject k > kMaxK: batch returns false, single queries return empty result
+    	bool findKNearestBatch(TreeType type, const std::vector<pxr::GfVec3f>& queries, size_t k, std::vector<KNNResult>& outResults, std::vector<uint32_t>& outCounts,
+    		const std::vector<size_t>* pIgnoreCurveIds = nullptr, ThreadPool* pThreadPool = nullptr) const;
 
 	private:
-    	std::shared_ptr<KDNode> buildTreeRec(std::vector<CurvePoint>& points, int depth, int start, int end);
+		static constexpr size_t kLeafSize = 8;
+
+		// Implicit balanced kd-tree. Node of the [start, end) range is stored at its median, children ranges are
+		// [start, median) and [median + 1, end). Ranges of up to kLeafSize points are scanned linearly
+		struct Tree {
+			std::vector<pxr::GfVec3f> positions;
+			std::vector<CurvePoint>   points;
+		};
+
+		// Fixed capacity, distance sorted K-Nearest candidates buffer
+		struct KNNBuffer {
+			struct Candidate {
+				uint32_t index;
+				float    distSq;
+			};
+
+			std::array<Candidate, kMaxK> items;
+			size_t size = 0;
+			size_t k = 1;
+
+			explicit KNNBuffer(size_t _k): k(std::min(_k, kMaxK)) {}
+
+			float worstDistSq() const { return (size < k) ? std::numeric_limits<float>::max() : items[size - 1].distSq; }
+			void insert(uint32_t index, float distSq);
+		};
+
+		void build(std::vector<CurvePoint>& flatPoints);
+		static void buildTree(Tree& tree, std::vector<CurvePoint>&& points);
+		static void buildTreeRec(std::vector<CurvePoint>& points, int depth, size_t start, size_t end);
 
-    	// Centralized search execution with selective pruning filters
-    	void searchNearestRec(const std::shared_ptr<KDNode>& pNode, 
-			const pxr::GfVec3f& query, int depth, const std::vector<CurvePositionType>& allowedTypes,
-			const std::optional<size_t>& ignore_curve_id, std::shared_ptr<KDNode>& bestNode, float& bestDistSq) const;
+		const Tree& getTree(TreeType type) const;
 
-		// Recursive K-NN search using a max-priority queue for strict pruning
-		void searchKNearestRec(const std::shared_ptr<KDNode>& pNode, const pxr::GfVec3f& query, 
-			int depth, size_t k, const std::vector<CurvePositionType>& allowedTypes, const std::optional<size_t>& ignore_curve_id, std::priority_queue<KNNCandidate>& maxHeap) const;
+		void searchKNearestRec(const Tree& tree, const pxr::GfVec3f& query, int depth, size_t start, size_t end, size_t ignore_curve_id, KNNBuffer& buffer) const;
+		void searchKNearest(const Tree& tree, const pxr::GfVec3f& query, size_t ignore_curve_id, KNNBuffer& buffer) const;
 
-    	// Utility wrapper to convert max-heap results to a sorted proximity vector
-	    std::vector<std::pair<CurvePoint, float>> finalizeKNN(std::priority_queue<KNNCandidate>& maxHeap) const;
+		std::vector<KNNResult> finalizeKNN(const Tree& tree, const KNNBuffer& buffer) const;
 
     private:
-    	std::shared_ptr<KDNode> mpRootNode;
+    	Tree mAllTree;
+    	Tree mRootsTree;
+    	Tree mTipsTree;
 };
 
 
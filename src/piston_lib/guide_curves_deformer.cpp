@@ -20,6 +20,8 @@
 
 namespace Piston {
 
+static constexpr size_t kNTBFramesGrainSize = 64; // guides per RMF building task
+
 GuideCurvesDeformer::GuideCurvesDeformer(const std::string& name): BaseCurvesDeformer(BaseCurvesDeformer::Type::GUIDES, name) {
 	mBindMode = BindMode::NTB;
 
@@ -88,42 +90,95 @@ void GuideCurvesDeformer::setGuidesSkinGeoPrim(const pxr::UsdPrim& geoPrim) {
 	DLOG_DBG << "Guides skin geometry prim is set to: " << mGuidesSkinGeoPrimHandle.getPath().GetText();
 }
 
-bool GuideCurvesDeformer::deformImpl(PointsList& points, pxr::UsdTimeCode time_code) {
+std::vector<pxr::SdfPath> GuideCurvesDeformer::getInputPrimPaths() const {
+	std::vector<pxr::SdfPath> paths = BaseCurvesDeformer::getInputPrimPaths();
+	if(mGuidesSkinGeoPrimHandle.isValid()) {
+		paths.push_back(mGuidesSkinGeoPrimHandle.getPath());
+	}
+	return paths;
+}
+
+bool GuideCurvesDeformer::initEvalContext(BaseCurvesDeformer::EvalContext& base_ctx, bool make_unique) const {
+	if(!BaseCurvesDeformer::initEvalContext(base_ctx, make_unique)) return false;
+	if(!mpGuideCurvesContainer) return false;
+
+	EvalContext& ctx = static_cast<EvalContext&>(base_ctx);
+
+	if(!make_unique) {
+		ctx.pGuideCurvesContainer = mpGuideCurvesContainer.get();
+		ctx.pSkinMeshContainer = mpSkinMeshContainer.get();
+	} else {
+		ctx.pOwnGuideCurvesContainer = mpGuideCurvesContainer->clone();
+		ctx.pOwnSkinMeshContainer = mpSkinMeshContainer ? mpSkinMeshContainer->clone() : nullptr;
+		ctx.pGuideCurvesContainer = ctx.pOwnGuideCurvesContainer.get();
+		ctx.pSkinMeshContainer = ctx.pOwnSkinMeshContainer.get();
+	}
+
+	// size per frame buffers once, so playback doesn't reallocate them
+	const size_t guide_vertex_count = ctx.pGuideCurvesContainer->getTotalVertexCount();
+	switch(getBindMode()) {
+		case BindMode::NTB:
+		case BindMode::BLEND:
+			ctx.liveGuideFrames.resize(guide_vertex_count);
+			break;
+		case BindMode::ANGLE:
+			ctx.liveSegmentRotations.resize(guide_vertex_count);
+			break;
+		default:
+			break;
+	}
+
+	ctx.skinFacesCache.setLayout(mpSkinFacesLayout);
+	ctx.guideFacesCache.setLayout(mpGuideFacesLayout);
+	return true;
+}
+
+bool GuideCurvesDeformer::canEvaluateConcurrently() const {
+	return BaseCurvesDeformer::canEvaluateConcurrently() && !mGuidesSkinGeoPrimHandle.isDeformerOutput() && (mGuidesSkinGeoPrimHandle.getSubdivLevel() == 0);
+}
+
+bool GuideCurvesDeformer::deformImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) {
 	PROFILE("GuideCurvesDeformer::deformImpl");
-	return __deform__(points, false, time_code);
+	return __deform__(static_cast<EvalContext&>(ctx), points, false, time_code);
 }
 
-bool GuideCurvesDeformer::deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) {
+bool GuideCurvesDeformer::deformMtImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) {
 	PROFILE("GuideCurvesDeformer::deformMtImpl");
-	return __deform__(points, true, time_code);
+	return __deform__(static_cast<EvalContext&>(ctx), points, true, time_code);
 }
 
-bool GuideCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code) {
-	if(!mpGuideCurvesContainer->update(mDeformerGeoPrimHandle, time_code, isDirty())) {
+bool GuideCurvesDeformer::__deform__(EvalContext& ctx, PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code) {
+	if(!ctx.pGuideCurvesContainer->update(mDeformerGeoPrimHandle, time_code, isDirty())) {
 		DLOG_ERR << "Error updating guide curves from prim" << mDeformerGeoPrimHandle.getPath().GetText() << " !";
 		return false;
 	}
 
 	const auto bind_mode = getBindMode();
 	DLOG_TRC << "GuideCurvesDeformer::__deform__() mode " << to_string(bind_mode) << " " << (multi_threaded ? "multi_threaded" : "single thread");
+
+	// skin surface is updated and its live face frames are computed once per frame for all the paths below
+	if(mpSkinPhantomTrimeshData && mpSkinPhantomTrimeshData->isValid() && ctx.pSkinMeshContainer) {
+		ctx.pSkinMeshContainer->update(mGuidesSkinGeoPrimHandle, time_code, isDirty());
+		ctx.skinFacesCache.update(mpSkinPhantomTrimeshData->getTrimesh(), ctx.pSkinMeshContainer, multi_threaded ? &mPool : nullptr);
+	}
 	
 	bool result = false;
 
 	switch(bind_mode) {
 		case BindMode::SPACE:
-			result = deformImpl_SpaceMode(multi_threaded, points, time_code);
+			result = deformImpl_SpaceMode(ctx, multi_threaded, points, time_code);
 			break;
 		case BindMode::ANGLE:
-			result = deformImpl_AngleMode(multi_threaded, points, time_code);
+			result = deformImpl_AngleMode(ctx, multi_threaded, points, time_code);
 			break;
 		case BindMode::NTB:
-			result = deformImpl_NTBMode(multi_threaded, points, time_code);
+			result = deformImpl_NTBMode(ctx, multi_threaded, points, time_code);
 			break;
 		case BindMode::BLEND:
-			result = deformImpl_BlendNTBMode(multi_threaded, points, time_code);
+			result = deformImpl_BlendNTBMode(ctx, multi_threaded, points, time_code);
 			break;
 		case BindMode::LHS:
-			result = deformImpl_LHSMode(multi_threaded, points, time_code);
+			result = deformImpl_LHSMode(ctx, multi_threaded, points, time_code);
 			break;
 		default:
 			assert(false && "Unimplemented GuideCurvesDeformer::BindMode");
@@ -132,13 +187,13 @@ bool GuideCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, px
 	}
 
 	if(result && getBindRootsToSkinSurface() && !mpGuideCurvesDeformerData->getPointSurfaceBinds().empty()) {
-		result = moveSkinBoundPoints(multi_threaded, points, time_code);
+		result = moveSkinBoundPoints(ctx, multi_threaded, points, time_code);
 	}
 
 	return result;
 }
 
-bool GuideCurvesDeformer::moveSkinBoundPoints(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool GuideCurvesDeformer::moveSkinBoundPoints(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	if(!hasSkinPrimitiveData()) {
 		return true;
 	}
@@ -147,13 +202,9 @@ bool GuideCurvesDeformer::moveSkinBoundPoints(bool multi_threaded, PointsList& p
 	PhantomTrimesh* pSkinPhantomTrimesh = mpSkinPhantomTrimeshData->getTrimesh();
 	assert(pSkinPhantomTrimesh);
 
-	assert(mpSkinMeshContainer);
-	const MeshContainer* pSkinMeshContainer = mpSkinMeshContainer.get();
-
-	pSkinMeshContainer->update(mGuidesSkinGeoPrimHandle, time_code, isDirty());
-
-	mTempSkinFaceLiveNormals.resize(pSkinPhantomTrimesh->getFaceCount());
-	TODO(precalculate skin live face normals first !!!)
+	assert(ctx.pSkinMeshContainer);
+	const MeshContainer* pSkinMeshContainer = ctx.pSkinMeshContainer;
+	const LiveFacesCache& skinFacesCache = ctx.skinFacesCache;
 
 	const auto& pointBinds = mpGuideCurvesDeformerData->getPointSurfaceBinds();
 
@@ -163,7 +214,7 @@ bool GuideCurvesDeformer::moveSkinBoundPoints(bool multi_threaded, PointsList& p
 			assert(bind.point_id < points.size());
 
 			const PhantomTrimesh::TriFace& skin_face = pSkinPhantomTrimesh->getFace(bind.face_id);
-			const pxr::GfVec3f face_normal = pSkinMeshContainer->getFaceLiveNormal(skin_face);
+			const pxr::GfVec3f face_normal = skinFacesCache.hasFace(bind.face_id) ? skinFacesCache.getFaceNormal(bind.face_id) : pSkinMeshContainer->getFaceLiveNormal(skin_face);
 			auto pos = pSkinMeshContainer->getInterpolatedLivePosition(skin_face, bind.u, bind.v) + face_normal * bind.dist;
 			points[bind.point_id] = pos * bind.weight + points[bind.point_id] * (1.f - bind.weight);
 		}
@@ -179,11 +230,30 @@ bool GuideCurvesDeformer::moveSkinBoundPoints(bool multi_threaded, PointsList& p
 	return true;
 }
 
-bool GuideCurvesDeformer::deformImpl_AngleMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool GuideCurvesDeformer::deformImpl_AngleMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	const auto& pointBinds = mpGuideCurvesDeformerData->getPointBinds();
-	const size_t guide_curves_count = mpGuideCurvesContainer->getCurvesCount();
-	const auto& guides_rest_points = mpGuideCurvesContainer->getRestCurvePoints();
-	const auto& guides_live_points = mpGuideCurvesContainer->getLiveCurvePoints();
+	const GuideCurvesContainer* pGuideCurvesContainer = ctx.pGuideCurvesContainer;
+	const size_t guide_curves_count = pGuideCurvesContainer->getCurvesCount();
+	const auto& guides_rest_points = pGuideCurvesContainer->getRestCurvePoints();
+	const auto& guides_live_points = pGuideCurvesContainer->getLiveCurvePoints();
+
+	// Rotation depends only on guide segment rest and live directions, so we build it once per segment
+	auto& segment_rotations = ctx.liveSegmentRotations;
+	segment_rotations.resize(pGuideCurvesContainer->getTotalVertexCount());
+
+	auto buildRotationsFunc = [&](const std::size_t start, const std::size_t end) {
+		for(size_t guide_id = start; guide_id < end; ++guide_id) {
+			const size_t guide_vertex_offset = pGuideCurvesContainer->getCurveVertexOffset(guide_id);
+			const size_t guide_vertex_count = pGuideCurvesContainer->getCurveVertexCount(guide_id);
+
+			for(size_t j = guide_vertex_offset; (j + 1) < (guide_vertex_offset + guide_vertex_count); ++j) {
+				const pxr::GfVec3f rest_segment_vector_n = pxr::GfGetNormalized(guides_rest_points[j + 1] - guides_rest_points[j], MIN_VECTOR_LENGTH_F);
+				const pxr::GfVec3f live_segment_vector_n = pxr::GfGetNormalized(guides_live_points[j + 1] - guides_live_points[j], MIN_VECTOR_LENGTH_F);
+
+				segment_rotations[j] = rotateAlign(rest_segment_vector_n, live_segment_vector_n);
+			}
+		}
+	};
 
 	auto func = [&](const std::size_t start, const std::size_t end) {
 
@@ -197,24 +267,22 @@ bool GuideCurvesDeformer::deformImpl_AngleMode(bool multi_threaded, PointsList&
 
 			bind.decodeID_modeANGLE(guide_id, segment_id);
 			assert(guide_id < guide_curves_count);
-			assert((size_t)segment_id < (mpGuideCurvesContainer->getCurveVertexCount(guide_id) - 1));
+			assert((size_t)segment_id < (pGuideCurvesContainer->getCurveVertexCount(guide_id) - 1));
 			bind.getData(vec);
-			const size_t guide_segment_start_vtx = mpGuideCurvesContainer->getCurveVertexOffset(guide_id) + segment_id;
-
-			// TODO: precalculate rest vectors. Maybe use CurvesContainter class instead as it's already in vectors form.... 
-			const pxr::GfVec3f rest_segment_vector_n = pxr::GfGetNormalized(guides_rest_points[guide_segment_start_vtx + 1] - guides_rest_points[guide_segment_start_vtx], MIN_VECTOR_LENGTH_F);
-			const pxr::GfVec3f live_segment_vector_n = pxr::GfGetNormalized(guides_live_points[guide_segment_start_vtx + 1] - guides_live_points[guide_segment_start_vtx], MIN_VECTOR_LENGTH_F);
-
-			const pxr::GfMatrix3f m = rotateAlign(rest_segment_vector_n, live_segment_vector_n);
+			const size_t guide_segment_start_vtx = pGuideCurvesContainer->getCurveVertexOffset(guide_id) + segment_id;
 
-			points[i] = guides_live_points[guide_segment_start_vtx] + (m * vec);
+			points[i] = guides_live_points[guide_segment_start_vtx] + (segment_rotations[guide_segment_start_vtx] * vec);
 		}
 	};
 
 	if(multi_threaded) {
+		BS::multi_future<void> rotation_blocks = mPool.submit_blocks(0u, guide_curves_count, buildRotationsFunc);
+		rotation_blocks.wait();
+
 		BS::multi_future<void> blocks = mPool.submit_blocks(0u, pointBinds.size(), func);
 		blocks.wait();
 	} else {
+		buildRotationsFunc(0u, guide_curves_count);
 		func(0u, pointBinds.size());
 	}
 
@@ -237,11 +305,11 @@ bool GuideCurvesDeformer::hasSkinPrimitiveData() const {
 	return mpSkinPhantomTrimeshData && mpSkinPhantomTrimeshData->isValid();
 }
 
-bool GuideCurvesDeformer::deformImpl_LHSMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool GuideCurvesDeformer::deformImpl_LHSMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	const auto& pointBinds = mpGuideCurvesDeformerData->getLHSPointBinds();
 
 	auto func = [&](const std::size_t start, const std::size_t end) {
-		const auto* pGuideCurvesContainer = mpGuideCurvesContainer.get();
+		const auto* pGuideCurvesContainer = ctx.pGuideCurvesContainer;
 		const auto& positions = pGuideCurvesContainer->getLiveCurvePoints();
 
 		for(size_t i = start; i < end; ++i) {
@@ -274,24 +342,24 @@ bool GuideCurvesDeformer::deformImpl_LHSMode(bool multi_threaded, PointsList& po
 	return true;
 }
 
-bool GuideCurvesDeformer::deformImpl_NTBMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool GuideCurvesDeformer::deformImpl_NTBMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	assert(mpGuideCurvesDeformerData);
-	assert(mpGuideCurvesContainer);
+	assert(ctx.pGuideCurvesContainer);
 
 	assert(hasSkinPrimitiveData()); // for now we only work with skin geometry
 	assert(mpSkinPhantomTrimeshData->isValid());
 	PhantomTrimesh* pSkinPhantomTrimesh = hasSkinPrimitiveData() ? mpSkinPhantomTrimeshData->getTrimesh() : nullptr;
 	assert(pSkinPhantomTrimesh);
 
-	assert(mpSkinMeshContainer);
-	mpSkinMeshContainer->update(mGuidesSkinGeoPrimHandle, time_code, isDirty());
+	assert(ctx.pSkinMeshContainer);
 
-	const auto& guides_live_points = mpGuideCurvesContainer->getLiveCurvePoints();
+	const auto& guides_live_points = ctx.pGuideCurvesContainer->getLiveCurvePoints();
 
 	const auto& pointBinds = mpGuideCurvesDeformerData->getPointBinds();
-	std::vector<NTBFrame> live_guide_frames(mpGuideCurvesContainer->getLiveCurvePoints().size());
+	std::vector<NTBFrame>& live_guide_frames = ctx.liveGuideFrames;
+	live_guide_frames.resize(guides_live_points.size());
 
-	if(!buildNTBFrames(live_guide_frames, multi_threaded, true /* build live */)) {
+	if(!buildNTBFrames(ctx.pGuideCurvesContainer, ctx.pSkinMeshContainer, live_guide_frames, multi_threaded, true /* build live */, &ctx.skinFacesCache)) {
 		return false;
 	}
 	
@@ -320,21 +388,21 @@ bool GuideCurvesDeformer::deformImpl_NTBMode(bool multi_threaded, PointsList& po
 	return true;
 }
 
-bool GuideCurvesDeformer::deformImpl_BlendNTBMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
-	const auto* pGuideCurvesContainer = mpGuideCurvesContainer.get();
+bool GuideCurvesDeformer::deformImpl_BlendNTBMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+	const auto* pGuideCurvesContainer = ctx.pGuideCurvesContainer;
 	assert(pGuideCurvesContainer);
 
 	assert(hasSkinPrimitiveData()); // for now we only work with skin geometry
 
-	assert(mpSkinMeshContainer);
-	mpSkinMeshContainer->update(mGuidesSkinGeoPrimHandle, time_code, isDirty());
+	assert(ctx.pSkinMeshContainer);
 
-	const auto& guides_live_points = mpGuideCurvesContainer->getLiveCurvePoints();
+	const auto& guides_live_points = pGuideCurvesContainer->getLiveCurvePoints();
 	const auto& pointBinds = mpGuideCurvesDeformerData->getBlendNTBPointBinds();
 	assert(pointBinds.size() == points.size());
 
-	std::vector<NTBFrame> live_guide_frames(mpGuideCurvesContainer->getLiveCurvePoints().size());
-	if(!buildNTBFrames(live_guide_frames, multi_threaded, true /* build live */)) {
+	std::vector<NTBFrame>& live_guide_frames = ctx.liveGuideFrames;
+	live_guide_frames.resize(guides_live_points.size());
+	if(!buildNTBFrames(pGuideCurvesContainer, ctx.pSkinMeshContainer, live_guide_frames, multi_threaded, true /* build live */, &ctx.skinFacesCache)) {
 		return false;
 	}
 
@@ -374,17 +442,21 @@ bool GuideCurvesDeformer::deformImpl_BlendNTBMode(bool multi_threaded, PointsLis
 	return true;
 }
 
-bool GuideCurvesDeformer::deformImpl_SpaceMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool GuideCurvesDeformer::deformImpl_SpaceMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	assert(mpGuidesPhantomTrimeshData);
 	PhantomTrimesh* pPhantomTrimesh = mpGuidesPhantomTrimeshData->getTrimesh();
 	assert(pPhantomTrimesh);
 
 
-	assert(mpDeformerMeshContainer);
-	if(!mpDeformerMeshContainer->update(mDeformerGeoPrimHandle, time_code, isDirty())) {
+	const MeshContainer* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
+	assert(pDeformerMeshContainer);
+	if(!pDeformerMeshContainer->update(mDeformerGeoPrimHandle, time_code, isDirty())) {
 		return false;
 	}
 
+	LiveFacesCache& guideFacesCache = ctx.guideFacesCache;
+	guideFacesCache.update(pPhantomTrimesh, pDeformerMeshContainer, multi_threaded ? &mPool : nullptr);
+
 	const auto& pointBinds = mpGuideCurvesDeformerData->getPointBinds();
 	auto func = [&](const std::size_t start, const std::size_t end) {
 
@@ -404,15 +476,14 @@ bool GuideCurvesDeformer::deformImpl_SpaceMode(bool multi_threaded, PointsList&
 					bind.getData(u, v, w);
 					x = 1.f - (u + v + w);
 				}
-				points[i] = mpDeformerMeshContainer->getPointPositionFromBarycentricTetrahedronLiveCoords(tetra, u, v, w, x);
+				points[i] = pDeformerMeshContainer->getPointPositionFromBarycentricTetrahedronLiveCoords(tetra, u, v, w, x);
 			} else {
 				// bound to triface
-				TODO(precalculate skin live face normals first for SPACE mode !!!)
-
-				const auto& face = pPhantomTrimesh->getFace(bind.encoded_id.mode_space.element_id);
-				const pxr::GfVec3f face_normal = mpDeformerMeshContainer->getFaceLiveNormal(face);
+				const uint32_t face_id = bind.encoded_id.mode_space.element_id;
+				const auto& face = pPhantomTrimesh->getFace(face_id);
+				const pxr::GfVec3f face_normal = guideFacesCache.hasFace(face_id) ? guideFacesCache.getFaceNormal(face_id) : pDeformerMeshContainer->getFaceLiveNormal(face);
 				bind.getData(u, v, w);
-				points[i] = mpDeformerMeshContainer->getInterpolatedLivePosition(face, u, v) + (face_normal * w);
+				points[i] = pDeformerMeshContainer->getInterpolatedLivePosition(face, u, v) + (face_normal * w);
 			}
 		}
 	};
@@ -490,20 +561,23 @@ buildCurvesRootsBindDeformerData(pxr::UsdTimeCode rest_time_code, bool multi_thr
 		}
 	}
 
-	std::mutex binds_mutex;
 	auto& point_surface_binds = mpGuideCurvesDeformerData->pointSurfaceBinds();
 	point_surface_binds.clear();
 	point_surface_binds.reserve(curves_count);
 
+	// Per curve root binds and candidate faces. Face ids are created once binding is done
+	std::vector<PointSurfaceBindData> curve_root_binds(curves_count);
+	std::vector<PhantomTrimesh::TriFace::IndicesList> bind_faces(curves_count, PhantomTrimesh::TriFace::kInvalidIndices);
+
 	assert(mpSkinMeshContainer);
 	const auto* pSkinMeshContainer = mpSkinMeshContainer.get();
 
-	auto bindPointToSkinPrim = [&] (const pxr::GfVec3f& pt, PointSurfaceBindData& bind, uint32_t prim_id, std::vector<float>& _tmp_sq_distances, bool ignore_prim_boundaries = false) {
+	auto bindPointToSkinPrim = [&] (const pxr::GfVec3f& pt, PointSurfaceBindData& bind, PhantomTrimesh::TriFace& bind_face, uint32_t prim_id, std::vector<float>& _tmp_sq_distances, bool ignore_prim_boundaries = false) {
 		bool is_bound = false;
 		const uint32_t prim_vertex_count = pSkinAdjacency->getFaceVertexCount(prim_id);
 		const uint32_t prim_vertex_offset = pSkinAdjacency->getFaceVertexOffset(prim_id);
 
-		uint32_t face_id;
+		PhantomTrimesh::TriFace face;
 		float u, v, dist;
 
 		if( prim_vertex_count > 3u){
@@ -521,43 +595,41 @@ buildCurvesRootsBindDeformerData(pxr::UsdTimeCode rest_time_code, bool multi_thr
 			static const float kFLT_MAX = std::numeric_limits<float>::max();
 
 			float pt_tri_dist_sq_min = kFLT_MAX;
-			uint32_t _face_id = PhantomTrimesh::kInvalidTriFaceID; 
 			float _u, _v, _dist;
 			for(uint32_t i = 1; i < (prim_vertex_count - 1); ++i) {
-				_face_id = pSkinPhantomTrimesh->getOrCreateFaceID(
+				const auto _face = PhantomTrimesh::makeFace(
 					pSkinAdjacency->getFaceVertex(prim_id, local_index), 
 					pSkinAdjacency->getFaceVertex(prim_id, (local_index + i) % prim_vertex_count),
 					pSkinAdjacency->getFaceVertex(prim_id, (local_index + i + 1) % prim_vertex_count)
 				);
 
-				const auto& face = pSkinPhantomTrimesh->getFace(_face_id);
-				is_bound = pSkinMeshContainer->projectPoint(pt, face, _u, _v, _dist);
+				is_bound = pSkinMeshContainer->projectPoint(pt, _face, _u, _v, _dist);
 				
 				if(is_bound) {
-					face_id = _face_id; u = _u; v = _v; dist = _dist;
+					face = _face; u = _u; v = _v; dist = _dist;
 					break;
 				} else if(ignore_prim_boundaries) {
 					// If outside we push point to triangle squared distance for later closest search
-					const float pt_tri_dist_sq = pointTriangleDistSquared(pt, rest_positions[face.indices[0]], rest_positions[face.indices[1]], rest_positions[face.indices[2]]);
+					const float pt_tri_dist_sq = pointTriangleDistSquared(pt, rest_positions[_face.indices[0]], rest_positions[_face.indices[1]], rest_positions[_face.indices[2]]);
 					if(pt_tri_dist_sq < pt_tri_dist_sq_min) {
-						face_id = _face_id;
+						face = _face;
 						u = _u; v =_v; dist = _dist;
 						pt_tri_dist_sq_min = pt_tri_dist_sq;
 					}
 				}
 			}
 		} else {
-			face_id = pSkinPhantomTrimesh->getOrCreateFaceID(
+			face = PhantomTrimesh::makeFace(
 				pSkinAdjacency->getFaceVertex(prim_id, 0), 
 				pSkinAdjacency->getFaceVertex(prim_id, 1),
 				pSkinAdjacency->getFaceVertex(prim_id, 2)
 			);
-			is_bound = pSkinMeshContainer->projectPoint(pt, pSkinPhantomTrimesh->getFace(face_id), u, v, dist);
+			is_bound = pSkinMeshContainer->projectPoint(pt, face, u, v, dist);
 		}
 
 
-		if(is_bound || ignore_prim_boundaries) {
-			bind.face_id = face_id;
+		if((is_bound || ignore_prim_boundaries) && face.isValid()) {
+			bind_face = face;
 			bind.u = u; bind.v = v; bind.dist = dist;
 		}
 		
@@ -579,16 +651,16 @@ buildCurvesRootsBindDeformerData(pxr::UsdTimeCode rest_time_code, bool multi_thr
 			for(uint32_t i = 0; i < curve_vertices_count; ++i) {
         		const pxr::GfVec3f curr_pt = curve_root_pt + *(curve_data_ptr.second + i);
 
-				PointSurfaceBindData bind;
+				PointSurfaceBindData& bind = curve_root_binds[curve_index];
 				bind.point_id = curve_vertex_offset + i;
 				bind.weight = 1.0f;
 
+				PhantomTrimesh::TriFace bind_face;
 				const uint32_t prim_id = is_per_vertex_attr ? skin_prim_indices[bind.point_id] : skin_prim_indices[curve_index];
-				bindPointToSkinPrim(curr_pt, bind, prim_id, tmp_squared_distances, true /* ignore prim boundaries */); 
+				bindPointToSkinPrim(curr_pt, bind, bind_face, prim_id, tmp_squared_distances, true /* ignore prim boundaries */); 
 
-				if(bind.face_id != PhantomTrimesh::kInvalidTriFaceID) {
-					const std::lock_guard<std::mutex> lock(binds_mutex);
-					point_surface_binds.push_back(bind);
+				if(bind_face.isValid()) {
+					bind_faces[curve_index] = bind_face.indices;
 				}
 			
 				break; // We process only root points for now
@@ -603,6 +675,18 @@ buildCurvesRootsBindDeformerData(pxr::UsdTimeCode rest_time_code, bool multi_thr
 		func(0u, curves_count);
 	}
 
+	// Create skin trimesh faces at once and collect binds in curves order
+	std::vector<uint32_t> bind_face_ids;
+	pSkinPhantomTrimesh->createFaceIDs(bind_faces, bind_face_ids, (multi_threaded ? &mPool : nullptr));
+
+	for(size_t curve_index = 0; curve_index < curves_count; ++curve_index) {
+		if(bind_face_ids[curve_index] == PhantomTrimesh::kInvalidTriFaceID) continue;
+
+		PointSurfaceBindData& bind = curve_root_binds[curve_index];
+		bind.face_id = bind_face_ids[curve_index];
+		point_surface_binds.push_back(bind);
+	}
+
 	mpSkinPhantomTrimeshData->setValid(true);
 	DLOG_DBG << point_surface_binds.size() << " points are bound to skin surface.";
 
@@ -683,6 +767,7 @@ bool GuideCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code,
 		}
 	}
 
+	// Loaded alone. Guides trimesh (SPACE mode) is read only when this load fails, see buildDeformerDataSpaceMode()
 	if(deformer_data_created || skin_prim_data_created || !mpGuideCurvesDeformerData->isValid() || !getReadJsonDataState() || !mGuidesSkinGeoPrimHandle.getDataFromBson(getDataPrimPath(), mpGuideCurvesDeformerData.get())) {
 
 		if(getBindRootsToSkinSurface()) {
@@ -715,7 +800,62 @@ bool GuideCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code,
 		mpGuideCurvesDeformerData->setValid(result);
 	}
 
-	return mpGuideCurvesDeformerData->isValid();
+	if(!mpGuideCurvesDeformerData->isValid()) {
+		return false;
+	}
+
+	buildLiveFacesCacheLayouts();
+	return true;
+}
+
+void GuideCurvesDeformer::buildLiveFacesCacheLayouts() {
+	assert(mpGuideCurvesDeformerData);
+
+	mpSkinFacesLayout = nullptr;
+	mpGuideFacesLayout = nullptr;
+
+	std::vector<uint32_t> face_ids;
+
+	if(mpSkinPhantomTrimeshData && mpSkinPhantomTrimeshData->isValid()) {
+		const PhantomTrimesh* pSkinPhantomTrimesh = mpSkinPhantomTrimeshData->getTrimesh();
+		assert(pSkinPhantomTrimesh);
+
+		if(getBindRootsToSkinSurface()) {
+			for(const auto& bind: mpGuideCurvesDeformerData->getPointSurfaceBinds()) {
+				face_ids.push_back(bind.face_id);
+			}
+		}
+
+		if(getBindMode() == BindMode::NTB || getBindMode() == BindMode::BLEND) {
+			uint32_t face_id, axis_id;
+			for(const auto& origin: mpGuideCurvesDeformerData->getGuideOrigins()) {
+				origin.decode(face_id, axis_id);
+				face_ids.push_back(face_id);
+			}
+		}
+
+		if(!face_ids.empty()) {
+			mpSkinFacesLayout = LiveFacesCache::buildLayout(face_ids, pSkinPhantomTrimesh->getFaceCount());
+		}
+	}
+
+	if(getBindMode() == BindMode::SPACE && mpGuidesPhantomTrimeshData && mpGuidesPhantomTrimeshData->isValid()) {
+		const PhantomTrimesh* pPhantomTrimesh = mpGuidesPhantomTrimeshData->getTrimesh();
+		assert(pPhantomTrimesh);
+
+		face_ids.clear();
+		uint32_t element_id;
+		bool is_tetra, is_24bit;
+		for(const auto& bind: mpGuideCurvesDeformerData->getPointBinds()) {
+			if(bind.encoded_id == PointBindData::kInvalid) continue;
+			bind.decodeID_modeSPACE(element_id, is_tetra, is_24bit);
+			if(!is_tetra) face_ids.push_back(element_id);
+		}
+
+		if(!face_ids.empty()) {
+			mpGuideFacesLayout = LiveFacesCache::buildLayout(face_ids, pPhantomTrimesh->getFaceCount());
+		}
+	}
 }
 
 bool GuideCurvesDeformer::buildDeformerDataSpaceMode(pxr::UsdTimeCode rest_time_code, bool multi_threaded) {
@@ -727,6 +867,7 @@ bool GuideCurvesDeformer::buildDeformerDataSpaceMode(pxr::UsdTimeCode rest_time_
 	}
 
 	if(guides_trimesh_data_created || !mpGuidesPhantomTrimeshData->isValid()) {
+		// Not batched with guide bind data: we get here only after that load failed, and binding below adds faces to this trimesh
 		if(!getReadJsonDataState() || !mDeformerGeoPrimHandle.getDataFromBson(getDataPrimPath(), mpGuidesPhantomTrimeshData.get())) {
 			// Build in place if no json data present or not needed
 			if(!mpGuidesPhantomTrimeshData->buildInPlace(mDeformerGeoPrimHandle)) {
@@ -745,7 +886,7 @@ bool GuideCurvesDeformer::buildDeformerDataSpaceMode(pxr::UsdTimeCode rest_time_
 
 		if(!pPhantomTrimesh->hasTetrahedrons()) {
 			assert(mpDeformerMeshContainer);
-			if(!pPhantomTrimesh->buildTetrahedrons(mpDeformerMeshContainer->getRestPositions(), mpGuideCurvesContainer.get())) {
+			if(!pPhantomTrimesh->buildTetrahedrons(mpDeformerMeshContainer->getRestPositions(), mpGuideCurvesContainer.get(), multi_threaded ? &mPool : nullptr)) {
 				DLOG_ERR << "Error building tetrahedrons!";
 				return false;
 			}
@@ -775,110 +916,122 @@ bool GuideCurvesDeformer::buildDeformerDataSpaceMode(pxr::UsdTimeCode rest_time_
 		const size_t curves_count = mpCurvesContainer->getCurvesCount();
 
 		assert(mpGuideCurvesDeformerData);
-		auto& pointBinds = mpGuideCurvesDeformerData->mPointBinds;
+		auto& pointBinds = mpGuideCurvesDeformerData->pointBinds();
 		pointBinds.resize(mpCurvesContainer->getTotalVertexCount());
 
 		std::atomic<size_t> total_points = 0;
 		std::atomic<size_t> bound_points = 0;
 		std::atomic<size_t> unboud_points = 0;
 		
-		TetrahedronKDTree<PhantomTrimesh::PxrIndexType> tetraKDTree(pPhantomTrimesh->getTetrahedrons(), pDeformerMeshContainer->getRestPositions());
-
-		auto bind_func = [&](const std::size_t start, const std::size_t end) {
-	    	if(multi_threaded) {
-	    		const std::optional<std::size_t> thread_index = BS::this_thread::get_index();
-	    		LOG_TRC << "Binding curves from " << start << " to " << end << " by thread id #" << *thread_index;
-	    	}
-
-	    	std::vector<neighbour_search::KDTree<float, 3>::ReturnType> sorted_tetra_centroids; // sorted tetrahedron centroids for brute force search
-	    	sorted_tetra_centroids.reserve(tetrahedrons.size());
-
-	    	std::vector<neighbour_search::KDTree<float, 3>::ReturnType> closest_deformer_points(3);
-
-	    	const auto& faces = pPhantomTrimesh->getFaces();
-
-	    	TetrahedronKDTree<PhantomTrimesh>::TetraIndexType cachedTetraIndex = TetrahedronKDTree<PhantomTrimesh>::kInvalidTetraID;
-
-			for(size_t curve_idx = start; curve_idx < end; ++curve_idx) {
-	    		const PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(curve_idx);
-
-	    		const uint32_t curve_vertices_count = static_cast<uint32_t>(curve_data_ptr.first);
-
-	        	const pxr::GfVec3f& curve_root_pt = mpCurvesContainer->getCurveRootPoint(curve_idx);
-	        	const uint32_t curve_vertex_offset = mpCurvesContainer->getCurveVertexOffset(curve_idx);
+		TetrahedronBVH<PhantomTrimesh::PxrIndexType> tetraBVH(pPhantomTrimesh->getTetrahedrons(), pDeformerMeshContainer->getRestPositions(), (multi_threaded ? &mPool : nullptr));
 
-	        	float u, v, w, x;
+		// Gather points to bind and locate them in tetrahedrons with one batch query
+		std::vector<pxr::GfVec3f> query_points;
+		std::vector<uint32_t> query_point_indices;
+		query_points.reserve(curves_count);
+		query_point_indices.reserve(curves_count);
 
-	        	for(uint32_t i = 0; i < curve_vertices_count; ++i) {
-	        		total_points++;
+		for(size_t curve_idx = 0; curve_idx < curves_count; ++curve_idx) {
+			const PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(curve_idx);
+			const uint32_t curve_vertices_count = static_cast<uint32_t>(curve_data_ptr.first);
 
-	        		const size_t curr_point_index = curve_vertex_offset + i;
-	        		auto& bind = pointBinds[curr_point_index];
-	        		bind.encoded_id = PointBindData::kInvalid;
+			const pxr::GfVec3f& curve_root_pt = mpCurvesContainer->getCurveRootPoint(curve_idx);
+			const uint32_t curve_vertex_offset = mpCurvesContainer->getCurveVertexOffset(curve_idx);
 
-	        		const pxr::GfVec3f curr_pt = curve_root_pt + *(curve_data_ptr.second + i); 
+			// only the first curve vertex is bound for now
+			if(curve_vertices_count > 0) {
+				query_points.push_back(curve_root_pt + *curve_data_ptr.second);
+				query_point_indices.push_back(curve_vertex_offset);
+			}
+		}
 
-	        		bool is_inside = false;
-	        		
-	        		//auto tetra_index = tetraKDTree.queryPoint(curr_pt, is_inside);
-	        		auto tetra_index = tetraKDTree.queryPointWithCache(curr_pt, cachedTetraIndex, is_inside);
+		std::vector<TetrahedronBVH<PhantomTrimesh::PxrIndexType>::TetraIndexType> query_tetra_indices;
+		std::vector<uint8_t> query_inside_flags;
+		tetraBVH.queryPoints(query_points, query_tetra_indices, query_inside_flags, (multi_threaded ? &mPool : nullptr));
 
-	        		if(is_inside) {
-	        			PROFILE("inside");
-	        			pDeformerMeshContainer->barycentricTetrahedronRestCoords(pPhantomTrimesh->getTetrahedron(tetra_index), curr_pt, u, v, w, x);
+		// Per point candidate faces for points bound outside of tetrahedrons. Face ids are created once binding is done
+		std::vector<PhantomTrimesh::TriFace::IndicesList> bind_faces(pointBinds.size(), PhantomTrimesh::TriFace::kInvalidIndices);
 
-	        			// bound inside tetra;
-	        			bind.encodeID_modeSPACE(tetra_index, true /* is tetra id */, false /* data is 3x32bit floats */);
-	        			bind.setData(u, v, w);
-	        			bound_points++;
-	        		} else {
-	        			PROFILE("outside");
-	        			// Bind to triface
-						deformer_restpoints_kdtree.findKNearestNeighbours(curr_pt, 3, closest_deformer_points);
+		auto bind_func = [&](const std::size_t start, const std::size_t end) {
+			if(multi_threaded) {
+				const std::optional<std::size_t> thread_index = BS::this_thread::get_index();
+				LOG_TRC << "Binding points from " << start << " to " << end << " by thread id #" << *thread_index;
+			}
 
-        				const uint32_t face_id = pPhantomTrimesh->getOrCreateFaceID(closest_deformer_points[0].first, closest_deformer_points[1].first, closest_deformer_points[2].first);
-        				const auto& face = faces[face_id];
+			std::vector<neighbour_search::KDTree<float, 3>::ReturnType> closest_deformer_points(3);
 
-						const pxr::GfVec3f& p0 = pDeformerMeshContainer->getRestPointPosition(face.indices[0]);
-						const pxr::GfVec3f& p1 = pDeformerMeshContainer->getRestPointPosition(face.indices[1]);
-						const pxr::GfVec3f& p2 = pDeformerMeshContainer->getRestPointPosition(face.indices[2]);
+			float u, v, w, x;
 
-						const auto& face_normal = pDeformerMeshContainer->getFaceRestNormal(face);
-						const Plane face_plane(p0, face_normal);
-						const float face_distance = distance(face_plane, curr_pt);
+			for(size_t q = start; q < end; ++q) {
+				total_points++;
 
-						const pxr::GfVec3f projected_pt = curr_pt - face_normal * face_distance; // project point on to face plane
+				const size_t curr_point_index = query_point_indices[q];
+				auto& bind = pointBinds[curr_point_index];
+				bind.encoded_id = PointBindData::kInvalid;
 
-						const pxr::GfVec3f v0 = p1 - p0, v1 = p2 - p0, v2 = projected_pt - p0;
-						float d00 = pxr::GfDot(v0, v0);
-						float d01 = pxr::GfDot(v0, v1);
-						float d11 = pxr::GfDot(v1, v1);
-						float d20 = pxr::GfDot(v2, v0);
-						float d21 = pxr::GfDot(v2, v1);
-						float denom = d00 * d11 - d01 * d01;
+				const pxr::GfVec3f& curr_pt = query_points[q];
 
-						u = (d11 * d20 - d01 * d21) / denom;
-						v = (d00 * d21 - d01 * d20) / denom;
-						w = face_distance;
-						bind.encodeID_modeSPACE(face_id, false /* not a tetra id */, false /* data is 3x32bit floats */);
-						bind.setData(u, v, w);
-        				bound_points++;
-	        		}
+				const bool is_inside = query_inside_flags[q] != 0;
+				const auto tetra_index = query_tetra_indices[q];
 
-	        		break;
+				if(is_inside) {
+					PROFILE("inside");
+					pDeformerMeshContainer->barycentricTetrahedronRestCoords(pPhantomTrimesh->getTetrahedron(tetra_index), curr_pt, u, v, w, x);
 
-	        		assert(bind.encoded_id != PointBindData::kInvalid && "SPACE mode encoded_id should not be PointBindData::kInvalid !");
-	        	}
-	    	}
+					// bound inside tetra;
+					bind.encodeID_modeSPACE(tetra_index, true /* is tetra id */, false /* data is 3x32bit floats */);
+					bind.setData(u, v, w);
+					bound_points++;
+				} else {
+					PROFILE("outside");
+					// Bind to triface
+					deformer_restpoints_kdtree.findKNearestNeighbours(curr_pt, 3, closest_deformer_points);
+
+					const auto face = PhantomTrimesh::makeFace(closest_deformer_points[0].first, closest_deformer_points[1].first, closest_deformer_points[2].first);
+
+					const pxr::GfVec3f& p0 = pDeformerMeshContainer->getRestPointPosition(face.indices[0]);
+					const pxr::GfVec3f& p1 = pDeformerMeshContainer->getRestPointPosition(face.indices[1]);
+					const pxr::GfVec3f& p2 = pDeformerMeshContainer->getRestPointPosition(face.indices[2]);
+
+					const auto& face_normal = pDeformerMeshContainer->getFaceRestNormal(face);
+					const Plane face_plane(p0, face_normal);
+					const float face_distance = distance(face_plane, curr_pt);
+
+					const pxr::GfVec3f projected_pt = curr_pt - face_normal * face_distance; // project point on to face plane
+
+					const pxr::GfVec3f v0 = p1 - p0, v1 = p2 - p0, v2 = projected_pt - p0;
+					float d00 = pxr::GfDot(v0, v0);
+					float d01 = pxr::GfDot(v0, v1);
+					float d11 = pxr::GfDot(v1, v1);
+					float d20 = pxr::GfDot(v2, v0);
+					float d21 = pxr::GfDot(v2, v1);
+					float denom = d00 * d11 - d01 * d01;
+
+					u = (d11 * d20 - d01 * d21) / denom;
+					v = (d00 * d21 - d01 * d20) / denom;
+					w = face_distance;
+					bind_faces[curr_point_index] = face.indices; // face id is encoded later
+					bind.setData(u, v, w);
+					bound_points++;
+				}
+			}
 		};
 
 		DLOG_INF << "Binding curves to guides using SPACE mode.";
 
 		if(multi_threaded) {
-			BS::multi_future<void> blocks = mPool.submit_blocks(0u, curves_count, bind_func);
+			BS::multi_future<void> blocks = mPool.submit_blocks(size_t(0), query_points.size(), bind_func);
 			blocks.wait();
 		} else {
-			bind_func(0u, curves_count);
+			bind_func(0u, query_points.size());
+		}
+
+		std::vector<uint32_t> bind_face_ids;
+		pPhantomTrimesh->createFaceIDs(bind_faces, bind_face_ids, (multi_threaded ? &mPool : nullptr));
+
+		for(size_t i = 0; i < pointBinds.size(); ++i) {
+			if(bind_face_ids[i] == PhantomTrimesh::kInvalidTriFaceID) continue;
+			pointBinds[i].encodeID_modeSPACE(bind_face_ids[i], false /* not a tetra id */, false /* data is 3x32bit floats */);
 		}
 
 		DLOG_DBG << "Total points: " << total_points.load();
@@ -893,8 +1046,8 @@ bool GuideCurvesDeformer::buildDeformerDataSpaceMode(pxr::UsdTimeCode rest_time_
 	return mpGuidesPhantomTrimeshData->isValid();
 }
 
-bool GuideCurvesDeformer::buildNTBFrames(std::vector<NTBFrame>& guide_frames, bool multi_threaded, bool build_live) {
-	assert(mpGuideCurvesContainer);
+bool GuideCurvesDeformer::buildNTBFrames(const GuideCurvesContainer* pGuideCurvesContainer, const MeshContainer* pSkinMeshContainer, std::vector<NTBFrame>& guide_frames, bool multi_threaded, bool build_live, const LiveFacesCache* pSkinFacesCache) const {
+	assert(pGuideCurvesContainer);
 
 	if(!mpSkinPhantomTrimeshData || !mpSkinPhantomTrimeshData->isValid()) {
 		DLOG_ERR << "Can't build NTB frames! No skin geometry data.";
@@ -904,11 +1057,11 @@ bool GuideCurvesDeformer::buildNTBFrames(std::vector<NTBFrame>& guide_frames, bo
 	const PhantomTrimesh* pSkinPhantomTrimesh = mpSkinPhantomTrimeshData->getTrimesh();
 	assert(pSkinPhantomTrimesh);
 
-	const auto total_guides_count = mpGuideCurvesContainer->getCurvesCount();
-	const auto& guide_points = build_live ? mpGuideCurvesContainer->getLiveCurvePoints() : mpGuideCurvesContainer->getRestCurvePoints();
+	const auto total_guides_count = pGuideCurvesContainer->getCurvesCount();
+	const auto& guide_points = build_live ? pGuideCurvesContainer->getLiveCurvePoints() : pGuideCurvesContainer->getRestCurvePoints();
 
-	assert(mpSkinMeshContainer);
-	const MeshContainer::ContainerType& skin_points = build_live ? mpSkinMeshContainer->getLivePositions() : mpSkinMeshContainer->getRestPositions();
+	assert(pSkinMeshContainer);
+	const MeshContainer::ContainerType& skin_points = build_live ? pSkinMeshContainer->getLivePositions() : pSkinMeshContainer->getRestPositions();
 
 	const auto& guide_origins = mpGuideCurvesDeformerData->getGuideOrigins();
 
@@ -917,8 +1070,8 @@ bool GuideCurvesDeformer::buildNTBFrames(std::vector<NTBFrame>& guide_frames, bo
 		for(auto guide_id = start; guide_id < end; ++guide_id) {
 			assert(guide_id < total_guides_count);
 
-			const size_t guide_vertex_offset = mpGuideCurvesContainer->getCurveVertexOffset(guide_id);
-			const size_t curve_points_count = mpGuideCurvesContainer->getCurveVertexCount(guide_id);
+			const size_t guide_vertex_offset = pGuideCurvesContainer->getCurveVertexOffset(guide_id);
+			const size_t curve_points_count = pGuideCurvesContainer->getCurveVertexCount(guide_id);
 			const pxr::GfVec3f* pCurveRootPt = guide_points.data() + guide_vertex_offset;
 			const pxr::GfVec3f& root_tangent = *(pCurveRootPt + 1) - *pCurveRootPt; 
 
@@ -928,8 +1081,13 @@ bool GuideCurvesDeformer::buildNTBFrames(std::vector<NTBFrame>& guide_frames, bo
 			assert(guide_id < guide_origins.size());
 			guide_origins[guide_id].decode(face_id, axis_id);
 
-			const PhantomTrimesh::TriFace& face = pSkinPhantomTrimesh->getFace(face_id);
-			const pxr::GfVec3f up_vector = pxr::GfGetNormalized(skin_points[face.indices[0]] - skin_points[face.indices[1]]);
+			pxr::GfVec3f up_vector;
+			if(build_live && pSkinFacesCache && pSkinFacesCache->hasFace(face_id)) {
+				up_vector = pSkinFacesCache->getFaceTangent(face_id);
+			} else {
+				const PhantomTrimesh::TriFace& face = pSkinPhantomTrimesh->getFace(face_id);
+				up_vector = pxr::GfGetNormalized(skin_points[face.indices[0]] - skin_points[face.indices[1]]);
+			}
 			
 			std::vector<NTBFrame>::iterator it_begin = guide_frames.begin() + guide_vertex_offset;
 			std::vector<NTBFrame>::iterator it_end = it_begin + curve_points_count;
@@ -939,7 +1097,9 @@ bool GuideCurvesDeformer::buildNTBFrames(std::vector<NTBFrame>& guide_frames, bo
 	};
 
 	if(multi_threaded) {
-		BS::multi_future<void> blocks = mPool.submit_blocks(0u, total_guides_count, frame_func);
+		// guides differ in length a lot, so we use fixed size blocks instead of one block per thread for better balancing
+		const size_t blocks_count = (total_guides_count + kNTBFramesGrainSize - 1) / kNTBFramesGrainSize;
+		BS::multi_future<void> blocks = mPool.submit_blocks(0u, total_guides_count, frame_func, blocks_count);
 		blocks.wait();
 	} else {
 		frame_func(0u, total_guides_count);
@@ -948,6 +1108,34 @@ bool GuideCurvesDeformer::buildNTBFrames(std::vector<NTBFrame>& guide_frames, bo
 	return true;
 }
 
+bool GuideCurvesDeformer::buildRestGuideInvFrames(std::vector<pxr::GfMatrix3f>& inv_frames, bool multi_threaded) {
+	assert(mpGuideCurvesContainer);
+
+	std::vector<NTBFrame> rest_guide_frames(mpGuideCurvesContainer->getTotalVertexCount());
+
+	static const bool build_live = false;
+	if(!buildNTBFrames(mpGuideCurvesContainer.get(), mpSkinMeshContainer.get(), rest_guide_frames, multi_threaded, build_live)) {
+		return false;
+	}
+
+	inv_frames.resize(rest_guide_frames.size());
+
+	auto func = [&](const std::size_t start, const std::size_t end) {
+		for(size_t i = start; i < end; ++i) {
+			inv_frames[i] = rest_guide_frames[i].getMatrix3f().GetInverse();
+		}
+	};
+
+	if(multi_threaded) {
+		BS::multi_future<void> blocks = mPool.submit_blocks(0u, rest_guide_frames.size(), func);
+		blocks.wait();
+	} else {
+		func(0u, rest_guide_frames.size());
+	}
+
+	return true;
+}
+
 bool GuideCurvesDeformer::buildGuideOrigins(bool multi_threaded) {
 	assert(mpGuideCurvesContainer);
 	assert(mpGuideCurvesDeformerData);
@@ -975,6 +1163,9 @@ bool GuideCurvesDeformer::buildGuideOrigins(bool multi_threaded) {
 	std::vector<std::mutex> kdtrees_mutexes(guide_curves_count);  // protects kdree initialisation
 	std::vector<std::unique_ptr<neighbour_search::KDTree<float, 3>>> kdtrees(guide_curves_count);
 
+	// Per guide candidate origin faces. Face ids are created once all guides are processed
+	std::vector<PhantomTrimesh::TriFace::IndicesList> origin_faces(guide_curves_count, PhantomTrimesh::TriFace::kInvalidIndices);
+
 	auto func = [&](const std::size_t start, const std::size_t end) {
 		std::vector<neighbour_search::KDTree<float, 3>::ReturnType> closest_deformer_points(3);
 
@@ -1011,10 +1202,7 @@ bool GuideCurvesDeformer::buildGuideOrigins(bool multi_threaded) {
         	const PhantomTrimesh::PxrIndexType b = pSkinGeoAdjacency->getFaceVertex(skin_prim_vtx_offset + closest_deformer_points[1].first);
         	const PhantomTrimesh::PxrIndexType c = pSkinGeoAdjacency->getFaceVertex(skin_prim_vtx_offset + closest_deformer_points[2].first);
 
-			const uint32_t face_id = pSkinGeoPhantomTrimesh->getOrCreateFaceID(a, b, c);
-
-			uint32_t axis_id = 0; // TODO: find a proper axis id !
-			guide_origins[guide_id].encode(face_id, axis_id);
+			origin_faces[guide_id] = PhantomTrimesh::makeFace(a, b, c).indices;
 		}
 	};
 
@@ -1025,6 +1213,14 @@ bool GuideCurvesDeformer::buildGuideOrigins(bool multi_threaded) {
 		func(0u, guide_curves_count);
 	}
 
+	std::vector<uint32_t> origin_face_ids;
+	pSkinGeoPhantomTrimesh->createFaceIDs(origin_faces, origin_face_ids, (multi_threaded ? &mPool : nullptr));
+
+	for(size_t guide_id = 0; guide_id < guide_curves_count; ++guide_id) {
+		uint32_t axis_id = 0; // TODO: find a proper axis id !
+		guide_origins[guide_id].encode(origin_face_ids[guide_id], axis_id);
+	}
+
 	mpSkinPhantomTrimeshData->setValid(true);
 
 	return true;
@@ -1271,7 +1467,7 @@ static inline bool calculateWeights(const pxr::GfVec3f& P, const pxr::VtArray<px
 
 // Computes the optimal reconstruction weights for point P using 6 3D points
 static std::array<float, 6> calculate3DWeights(const pxr::GfVec3f& P, const std::array<pxr::GfVec3f, 6>& points) {
-    size_t N = points.size(); // Designed for N=6
+    constexpr size_t N = 6; // Designed for N=6
     
     // We set up a system of linear equations using Lagrange Multipliers
     // To minimize sum(w_i^2 * dist_i) subject to sum(w_i) = 1 and sum(w_i * v_i) = P
@@ -1281,9 +1477,11 @@ static std::array<float, 6> calculate3DWeights(const pxr::GfVec3f& P, const std:
     // Row 3: Sum of weights equals 1 constraint
     // Rows 4,5: Regularization/minimization parameters for the remaining degrees of freedom
     
-    int matrixSize = N + 4; // 6 points + 4 constraints (X, Y, Z, and Sum=1)
-    std::vector<std::vector<float>> A(matrixSize, std::vector<float>(matrixSize, 0.0));
-    std::vector<float> B(matrixSize, 0.0);
+    constexpr int matrixSize = N + 4; // 6 points + 4 constraints (X, Y, Z, and Sum=1)
+
+    // Fixed size system lives on stack. This is called for every bound hair vertex, so no heap allocations here
+    std::array<std::array<float, matrixSize>, matrixSize> A{};
+    std::array<float, matrixSize> B{};
 
     // Populate the objective function (minimize distance-based energy)
     for (size_t i = 0; i < N; ++i) {
@@ -1344,7 +1542,7 @@ static std::array<float, 6> calculate3DWeights(const pxr::GfVec3f& P, const std:
     }
 
     // Back substitution
-    std::vector<float> X(matrixSize, 0.0f);
+    std::array<float, matrixSize> X{};
     for (int i = matrixSize - 1; i >= 0; --i) {
         X[i] = B[i];
         for (int j = i + 1; j < matrixSize; ++j) {
@@ -1362,6 +1560,20 @@ static std::array<float, 6> calculate3DWeights(const pxr::GfVec3f& P, const std:
     return weights;
 }
 
+bool GuideCurvesDeformer::findNeighbourGuideRoots(const USDCurveKDTree& guides_kdtree, size_t k, std::vector<USDCurveKDTree::KNNResult>& neighbour_roots, std::vector<uint32_t>& neighbour_roots_counts, bool multi_threaded) {
+	const PxrCurvesContainer* pCurvesContainer = mpCurvesContainer.get();
+	const size_t curves_count = pCurvesContainer->getCurvesCount();
+
+	std::vector<pxr::GfVec3f> root_queries(curves_count);
+	std::vector<size_t> ignore_guide_ids(curves_count);
+	for(size_t curve_index = 0; curve_index < curves_count; ++curve_index) {
+		root_queries[curve_index] = pCurvesContainer->getCurveRootPoint(curve_index);
+		ignore_guide_ids[curve_index] = static_cast<size_t>(mGuideIndices.AsConst()[curve_index]);
+	}
+
+	return guides_kdtree.findKNearestBatch(USDCurveKDTree::TreeType::Roots, root_queries, k, neighbour_roots, neighbour_roots_counts, &ignore_guide_ids, multi_threaded ? &mPool : nullptr);
+}
+
 bool GuideCurvesDeformer::buildDeformerDataLHSMode(pxr::UsdTimeCode rest_time_code, bool multi_threaded) {
 	// Check we have guide indices (clump ids) and curves count matches.
 	const size_t curves_count = mpCurvesContainer->getCurvesCount();
@@ -1380,105 +1592,123 @@ bool GuideCurvesDeformer::buildDeformerDataLHSMode(pxr::UsdTimeCode rest_time_co
 	const PxrCurvesContainer* pCurvesContainer = mpCurvesContainer.get();
 	const USDCurveKDTree guides_kdtree(pGuideCurvesContainer);
 
-	size_t bound_curves = 0;
-	size_t bound_points = 0;
+	std::atomic<size_t> bound_curves = 0;
+	std::atomic<size_t> bound_points = 0;
 
 	// preallocate 
 	auto& pointBinds = mpGuideCurvesDeformerData->lhsPointBinds();
 	pointBinds.resize(pCurvesContainer->getTotalVertexCount()); 
 
-	// pre compute per vertex distances
-	std::vector<float> dist_from_root(mpCurvesContainer->getTotalVertexCount());
-	for(uint32_t curve_index = 0; curve_index < mpCurvesContainer->getCurvesCount(); ++curve_index) {
-		uint32_t curve_vertex_offset = pCurvesContainer->getCurveVertexOffset(curve_index);
-		dist_from_root[curve_vertex_offset] = 0.f;
-		for(uint32_t i = 1; i < mpCurvesContainer->getCurveVertexCount(curve_index); ++i) {
-			dist_from_root[curve_vertex_offset + i] = dist_from_root[curve_vertex_offset + i - 1] + 
-				(pCurvesContainer->getCurveVector(curve_index, i - 1) - pCurvesContainer->getCurveVector(curve_index, i)).GetLength();
-		}
+	std::vector<USDCurveKDTree::KNNResult> neighbour_roots;
+	std::vector<uint32_t> neighbour_roots_counts;
+	if(!findNeighbourGuideRoots(guides_kdtree, 2, neighbour_roots, neighbour_roots_counts, multi_threaded)) {
+		return false;
 	}
 
-	for(uint32_t curve_index = 0; curve_index < mpCurvesContainer->getCurvesCount(); ++curve_index) {
+	// Each curve writes only its own [curve_vertex_offset, curve_vertex_offset + curve_vertices_count) binds range, so output
+	// does not depend on how curves are split between threads
+	auto func = [&](const std::size_t start, const std::size_t end) {
+		std::vector<float> dist_from_root; // per thread scratch buffer
+		dist_from_root.reserve(64);
 
-		PxrCurvesContainer::CurveDataConstPtr curve_data_ptr = pCurvesContainer->getCurveDataPtr(curve_index);
-		const uint32_t curve_vertices_count = static_cast<uint32_t>(curve_data_ptr.first);
+		for(size_t curve_index = start; curve_index < end; ++curve_index) {
 
-		const pxr::GfVec3f& curve_root_pt = pCurvesContainer->getCurveRootPoint(curve_index);
-		const uint32_t curve_vertex_offset = pCurvesContainer->getCurveVertexOffset(curve_index);
+			PxrCurvesContainer::CurveDataConstPtr curve_data_ptr = pCurvesContainer->getCurveDataPtr(curve_index);
+			const uint32_t curve_vertices_count = static_cast<uint32_t>(curve_data_ptr.first);
 
-		assert(curve_index < mGuideIndices.AsConst().size());
-		const auto guide_id = mGuideIndices.AsConst()[curve_index];
+			const pxr::GfVec3f& curve_root_pt = pCurvesContainer->getCurveRootPoint(curve_index);
+			const uint32_t curve_vertex_offset = pCurvesContainer->getCurveVertexOffset(curve_index);
 
-		//DLOG_DBG << "Guide 0 ID " << guide_id;
-		//DLOG_DBG << "Guide 0 length " << mpGuideCurvesContainer->getRestCurveLength(guide_id);
+			assert(curve_index < mGuideIndices.AsConst().size());
+			const auto guide_id = mGuideIndices.AsConst()[curve_index];
 
-		const auto root_points = guides_kdtree.findKNearestCurveRoots(curve_root_pt, 2, guide_id /* ignore guide_id itself */);
+			//DLOG_DBG << "Guide 0 ID " << guide_id;
+			//DLOG_DBG << "Guide 0 length " << mpGuideCurvesContainer->getRestCurveLength(guide_id);
 
-		bool has_doubled_guide_id = false;
-		for(const auto& root_point: root_points) {
-			assert(root_point.first.positionType == USDCurveKDTree::CurvePositionType::Root);
-			if(root_point.first.curveIndex == guide_id) has_doubled_guide_id = true;
-		}
+			const USDCurveKDTree::KNNResult* root_points = neighbour_roots.data() + curve_index * 2;
+			const uint32_t root_points_count = neighbour_roots_counts[curve_index];
 
-		if(has_doubled_guide_id || root_points.size() != 2) {
-			DLOG_DBG << "!!!";
-			continue;
-		}
+			bool has_doubled_guide_id = false;
+			for(uint32_t j = 0; j < root_points_count; ++j) {
+				assert(root_points[j].first.positionType == USDCurveKDTree::CurvePositionType::Root);
+				if(root_points[j].first.curveIndex == guide_id) has_doubled_guide_id = true;
+			}
+
+			if(has_doubled_guide_id || root_points_count != 2) {
+				DLOG_DBG << "!!!";
+				continue;
+			}
+
+			//DLOG_DBG << "Guide 1 ID " << root_points[0].first.curveIndex;
+			//DLOG_DBG << "Guide 2 ID " << root_points[1].first.curveIndex;
 
-		//DLOG_DBG << "Guide 1 ID " << root_points[0].first.curveIndex;
-		//DLOG_DBG << "Guide 2 ID " << root_points[1].first.curveIndex;
+			// per vertex distances from curve root
+			dist_from_root.resize(curve_vertices_count);
+			dist_from_root[0] = 0.f;
+			for(uint32_t i = 1; i < curve_vertices_count; ++i) {
+				dist_from_root[i] = dist_from_root[i - 1] + (*(curve_data_ptr.second + i - 1) - *(curve_data_ptr.second + i)).GetLength();
+			}
 
-		// Bind rest of curves points
-		for(uint32_t i = 0; i < curve_vertices_count; ++i) {
-			float curr_dist_from_root = dist_from_root[curve_vertex_offset + i];
+			// Bind rest of curves points
+			for(uint32_t i = 0; i < curve_vertices_count; ++i) {
+				float curr_dist_from_root = dist_from_root[i];
 
-			//DLOG_DBG << "Curr dist " << curr_dist_from_root;
+				//DLOG_DBG << "Curr dist " << curr_dist_from_root;
 
-			const pxr::GfVec3f curr_pt = curve_root_pt + *(curve_data_ptr.second + i); 
+				const pxr::GfVec3f curr_pt = curve_root_pt + *(curve_data_ptr.second + i); 
 
 
-			std::array<uint32_t, 6> gv; // 6 neightbour guides vertices
+				std::array<uint32_t, 6> gv; // 6 neightbour guides vertices
 
-			pGuideCurvesContainer->getVeticesAtLength(guide_id, curr_dist_from_root, gv[0], gv[1]);
-			pGuideCurvesContainer->getVeticesAtLength(root_points[0].first.curveIndex, curr_dist_from_root, gv[2], gv[3]);
-			pGuideCurvesContainer->getVeticesAtLength(root_points[1].first.curveIndex, curr_dist_from_root, gv[4], gv[5]);
+				pGuideCurvesContainer->getVeticesAtLength(guide_id, curr_dist_from_root, gv[0], gv[1]);
+				pGuideCurvesContainer->getVeticesAtLength(root_points[0].first.curveIndex, curr_dist_from_root, gv[2], gv[3]);
+				pGuideCurvesContainer->getVeticesAtLength(root_points[1].first.curveIndex, curr_dist_from_root, gv[4], gv[5]);
 
-			auto& bind = pointBinds[curve_vertex_offset + i];
+				auto& bind = pointBinds[curve_vertex_offset + i];
 
-			// another test
+				// another test
 
-			bind.curveIndices[0] = guide_id;
-			bind.curveIndices[1] = root_points[0].first.curveIndex;
-			bind.curveIndices[2] = root_points[1].first.curveIndex;
+				bind.curveIndices[0] = guide_id;
+				bind.curveIndices[1] = root_points[0].first.curveIndex;
+				bind.curveIndices[2] = root_points[1].first.curveIndex;
 
-			std::array<pxr::GfVec3f, 6> pts;
-			pts[0] = guides_rest_points[gv[0]];
-			pts[1] = guides_rest_points[gv[1]];
-			pts[2] = guides_rest_points[gv[2]];
-			pts[3] = guides_rest_points[gv[3]];
-			pts[4] = guides_rest_points[gv[4]];
-			pts[5] = guides_rest_points[gv[5]];
+				std::array<pxr::GfVec3f, 6> pts;
+				pts[0] = guides_rest_points[gv[0]];
+				pts[1] = guides_rest_points[gv[1]];
+				pts[2] = guides_rest_points[gv[2]];
+				pts[3] = guides_rest_points[gv[3]];
+				pts[4] = guides_rest_points[gv[4]];
+				pts[5] = guides_rest_points[gv[5]];
 
 
-			std::array<float, 6> weights = calculate3DWeights(curr_pt, pts);
-			bind.w[0] = weights[0];
-			bind.w[1] = weights[1];
-			bind.w[2] = weights[2];
-			bind.w[3] = weights[3];
-			bind.w[4] = weights[4];
-			bind.w[5] = weights[5];
+				std::array<float, 6> weights = calculate3DWeights(curr_pt, pts);
+				bind.w[0] = weights[0];
+				bind.w[1] = weights[1];
+				bind.w[2] = weights[2];
+				bind.w[3] = weights[3];
+				bind.w[4] = weights[4];
+				bind.w[5] = weights[5];
 
-			bind.v[0] = gv[0] - pGuideCurvesContainer->getCurveVertexOffset(guide_id);
-			bind.v[1] = gv[1] - pGuideCurvesContainer->getCurveVertexOffset(guide_id);
+				bind.v[0] = gv[0] - pGuideCurvesContainer->getCurveVertexOffset(guide_id);
+				bind.v[1] = gv[1] - pGuideCurvesContainer->getCurveVertexOffset(guide_id);
 
-			bind.v[2] = gv[2] - pGuideCurvesContainer->getCurveVertexOffset(root_points[0].first.curveIndex);
-			bind.v[3] = gv[3] - pGuideCurvesContainer->getCurveVertexOffset(root_points[0].first.curveIndex);
+				bind.v[2] = gv[2] - pGuideCurvesContainer->getCurveVertexOffset(root_points[0].first.curveIndex);
+				bind.v[3] = gv[3] - pGuideCurvesContainer->getCurveVertexOffset(root_points[0].first.curveIndex);
 
-			bind.v[4] = gv[4] - pGuideCurvesContainer->getCurveVertexOffset(root_points[1].first.curveIndex);
-			bind.v[5] = gv[5] - pGuideCurvesContainer->getCurveVertexOffset(root_points[1].first.curveIndex);
-       	}
+				bind.v[4] = gv[4] - pGuideCurvesContainer->getCurveVertexOffset(root_points[1].first.curveIndex);
+				bind.v[5] = gv[5] - pGuideCurvesContainer->getCurveVertexOffset(root_points[1].first.curveIndex);
+	       	}
 
-       	bound_curves++;
+	       	bound_points += curve_vertices_count;
+	       	bound_curves++;
+		}
+	};
+
+	if(multi_threaded) {
+		BS::multi_future<void> blocks = mPool.submit_blocks(0u, curves_count, func);
+		blocks.wait();
+	} else {
+		func(0u, curves_count);
 	}
 
 
@@ -1596,19 +1826,12 @@ bool GuideCurvesDeformer::buildDeformerDataBlendNTBMode(pxr::UsdTimeCode rest_ti
 	const PxrCurvesContainer* pCurvesContainer = mpCurvesContainer.get();
 	pointBinds.resize(mpCurvesContainer->getTotalVertexCount());
 
-	std::vector<NTBFrame> rest_guide_frames(pGuideCurvesContainer->getRestCurvePoints().size());
-
-	static const bool build_live = false;
-	if(!buildNTBFrames(rest_guide_frames, multi_threaded, build_live)) {
+	// inverse rest frames. Bind time only, released when binding is done
+	std::vector<pxr::GfMatrix3f> matrices;
+	if(!buildRestGuideInvFrames(matrices, multi_threaded)) {
 		return false;
 	}
 
-	// inverse frames
-	std::vector<pxr::GfMatrix3f> matrices(rest_guide_frames.size());
-	for(size_t i = 0; i < rest_guide_frames.size(); ++i) {
-		matrices[i] = rest_guide_frames[i].getMatrix3f().GetInverse();
-	}
-
 	const size_t guide_curves_count = pGuideCurvesContainer->getCurvesCount();
 
 	std::vector<std::mutex> kdtrees_mutexes(guide_curves_count);  // protects kdree initialisation
@@ -1617,6 +1840,12 @@ bool GuideCurvesDeformer::buildDeformerDataBlendNTBMode(pxr::UsdTimeCode rest_ti
 
 	const USDCurveKDTree guides_kdtree(pGuideCurvesContainer);
 
+	std::vector<USDCurveKDTree::KNNResult> neighbour_roots;
+	std::vector<uint32_t> neighbour_roots_counts;
+	if(!findNeighbourGuideRoots(guides_kdtree, 2, neighbour_roots, neighbour_roots_counts, multi_threaded)) {
+		return false;
+	}
+
 	// pre compute per vertex distances
 	std::vector<float> dist_from_root(mpCurvesContainer->getTotalVertexCount());
 
@@ -1641,7 +1870,8 @@ bool GuideCurvesDeformer::buildDeformerDataBlendNTBMode(pxr::UsdTimeCode rest_ti
 			const pxr::GfVec3f& curve_root_pt = pCurvesContainer->getCurveRootPoint(curve_index);
 			const uint32_t curve_vertex_offset = pCurvesContainer->getCurveVertexOffset(curve_index);
 
-			const auto root_points = guides_kdtree.findKNearestCurveRoots(curve_root_pt, 2, guide_id /* ignore guide_id itself */);
+			const USDCurveKDTree::KNNResult* root_points = neighbour_roots.data() + curve_index * 2;
+			const uint32_t root_points_count = neighbour_roots_counts[curve_index];
 
 			for(uint32_t i = 0; i < curve_vertices_count; ++i) {
 				float curr_dist_from_root = dist_from_root[curve_vertex_offset + i];
@@ -1655,7 +1885,7 @@ bool GuideCurvesDeformer::buildDeformerDataBlendNTBMode(pxr::UsdTimeCode rest_ti
 				bind.guide_id[0] = guide_id;
 				bind.v[0] = gv[0] - pGuideCurvesContainer->getCurveVertexOffset(guide_id);
 
-				const uint8_t neighbour_guides_count = static_cast<uint8_t>(root_points.size());
+				const uint8_t neighbour_guides_count = static_cast<uint8_t>(root_points_count);
 
 				switch (neighbour_guides_count) {
 					case 0:
@@ -1743,19 +1973,12 @@ bool GuideCurvesDeformer::buildDeformerDataNTBMode(pxr::UsdTimeCode rest_time_co
 	const size_t curves_count = mpCurvesContainer->getCurvesCount();
 	assert(curves_count == mGuideIndices.size());
 
-	std::vector<NTBFrame> rest_guide_frames(mpGuideCurvesContainer->getRestCurvePoints().size());
-
-	static const bool build_live = false;
-	if(!buildNTBFrames(rest_guide_frames, multi_threaded, build_live)) {
+	// inverse rest frames. Bind time only, released when binding is done
+	std::vector<pxr::GfMatrix3f> matrices;
+	if(!buildRestGuideInvFrames(matrices, multi_threaded)) {
 		return false;
 	}
 
-	// inverse frames
-	std::vector<pxr::GfMatrix3f> matrices(rest_guide_frames.size());
-	for(size_t i = 0; i < rest_guide_frames.size(); ++i) {
-		matrices[i] = rest_guide_frames[i].getMatrix3f().GetInverse();
-	}
-
 	auto& pointBinds = mpGuideCurvesDeformerData->pointBinds();
 	const PxrCurvesContainer* pCurvesContainer = mpCurvesContainer.get();
 	pointBinds.resize(mpCurvesContainer->getTotalVertexCount());
@@ -1860,7 +2083,7 @@ bool GuideCurvesDeformer::buildDeformerDataAngleMode(pxr::UsdTimeCode rest_time_
 
 	assert(curves_count == mGuideIndices.size());
 
-	auto& pointBinds = mpGuideCurvesDeformerData->mPointBinds;
+	auto& pointBinds = mpGuideCurvesDeformerData->pointBinds();
 	pointBinds.resize(mpCurvesContainer->getTotalVertexCount());
 
 	auto func = [&](const size_t curve_index) {
@@ -1953,20 +2176,36 @@ bool GuideCurvesDeformer::buildSkinPrimData(bool multi_threaded, pxr::UsdTimeCod
 		assert(mpSkinAdjacencyData);
 	}
 
-	if(skin_adjacency_data_created || !getReadJsonDataState() || !mGuidesSkinGeoPrimHandle.getDataFromBson(getDataPrimPath(), mpSkinAdjacencyData.get())) {
-		if(!mpSkinAdjacencyData->buildInPlace(mGuidesSkinGeoPrimHandle)) {
-			DLOG_ERR << "Error building guides skin adjacency data!";
-			return false;
-		}
-	}
-
 	bool skin_trimesh_data_created = true;
 	if(!mpSkinPhantomTrimeshData) {
 		mpSkinPhantomTrimeshData = dataCache.getOrCreateData<SerializablePhantomTrimesh>(this, {&mDeformerGeoPrimHandle, &mCurvesGeoPrimHandle, &mGuidesSkinGeoPrimHandle}, rest_time_code, skin_trimesh_data_created);
 		assert(mpSkinPhantomTrimeshData);
 	}
 
-	if(skin_trimesh_data_created || !getReadJsonDataState() || !mGuidesSkinGeoPrimHandle.getDataFromBson(getDataPrimPath(), mpSkinPhantomTrimeshData.get())) {
+	// Stored skin adjacency and trimesh are decoded concurrently
+	bool skin_adjacency_data_read = false;
+	bool skin_trimesh_data_read = false;
+	if(getReadJsonDataState() && (!skin_adjacency_data_created || !skin_trimesh_data_created)) {
+		std::vector<UsdPrimHandle::DataRequest> requests;
+		if(!skin_adjacency_data_created) requests.push_back({&mGuidesSkinGeoPrimHandle, mpSkinAdjacencyData.get()});
+		if(!skin_trimesh_data_created) requests.push_back({&mGuidesSkinGeoPrimHandle, mpSkinPhantomTrimeshData.get()});
+
+		UsdPrimHandle::getDataFromBson(getDataPrimPath(), requests);
+
+		for(const auto& request: requests) {
+			if(request.pData == mpSkinAdjacencyData.get()) skin_adjacency_data_read = request.result;
+			if(request.pData == mpSkinPhantomTrimeshData.get()) skin_trimesh_data_read = request.result;
+		}
+	}
+
+	if(!skin_adjacency_data_read) {
+		if(!mpSkinAdjacencyData->buildInPlace(mGuidesSkinGeoPrimHandle)) {
+			DLOG_ERR << "Error building guides skin adjacency data!";
+			return false;
+		}
+	}
+
+	if(!skin_trimesh_data_read) {
 		if(!mpSkinPhantomTrimeshData->buildInPlace(mGuidesSkinGeoPrimHandle)) {
 			DLOG_ERR << "Error building guides skin trimesh data!";
 			return false;
@@ -1978,52 +2217,23 @@ bool GuideCurvesDeformer::buildSkinPrimData(bool multi_threaded, pxr::UsdTimeCod
 	return true;
 }
 
-bool GuideCurvesDeformer::writeJsonDataToPrimImpl() const {
-	if(mpGuidesPhantomTrimeshData){
-		if(!mDeformerGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpGuidesPhantomTrimeshData.get())) {
-			DLOG_ERR << "Error writing " << mpGuidesPhantomTrimeshData->typeName() << " deformer data to json !";
-			return false;
-		} else {
-			DLOG_DBG << "Deformer data " << mpGuidesPhantomTrimeshData->jsonDataKey() << " written.";
-		}
-	}
-
-	if(mpGuideCurvesDeformerData) {
-		if(!mCurvesGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpGuideCurvesDeformerData.get())) {
-			DLOG_ERR << "Error writing " << mpGuideCurvesDeformerData->typeName() << " deformer data to json !";
-			return false;
-		} else {
-			DLOG_DBG << "Deformer data " << mpGuideCurvesDeformerData->jsonDataKey() << " written.";
-		}
-	}
+void GuideCurvesDeformer::collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const {
+	if(mpGuidesPhantomTrimeshData) requests.push_back({&mDeformerGeoPrimHandle, mpGuidesPhantomTrimeshData.get()});
+	if(mpGuideCurvesDeformerData) requests.push_back({&mCurvesGeoPrimHandle, mpGuideCurvesDeformerData.get()});
 
 	if(mGuidesSkinGeoPrimHandle) {
-		if(mpSkinPhantomTrimeshData && mpSkinPhantomTrimeshData->isValid()) {
-			if(!mGuidesSkinGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpSkinPhantomTrimeshData.get())) {
-				DLOG_ERR << "Error writing " << mpSkinPhantomTrimeshData->typeName() << " curves data to json !";
-				return false;
-			} else {
-				DLOG_DBG << "Deformer data " << mpSkinPhantomTrimeshData->jsonDataKey() << " written.";
-			}
-		}
-
-		if(mpSkinAdjacencyData && mpSkinAdjacencyData->isValid()) {
-			if(!mGuidesSkinGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpSkinAdjacencyData.get())) {
-				DLOG_ERR << "Error writing " << mpSkinAdjacencyData->typeName() << " deformer data to json !";
-				return false;
-			} else {
-				DLOG_DBG << "Deformer data " << mpSkinAdjacencyData->jsonDataKey() << " written.";
-			}
-		}
+		if(mpSkinPhantomTrimeshData && mpSkinPhantomTrimeshData->isValid()) requests.push_back({&mGuidesSkinGeoPrimHandle, mpSkinPhantomTrimeshData.get()});
+		if(mpSkinAdjacencyData && mpSkinAdjacencyData->isValid()) requests.push_back({&mGuidesSkinGeoPrimHandle, mpSkinAdjacencyData.get()});
 	}
-
-	return true;
 }
 
-void GuideCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) {
+void GuideCurvesDeformer::drawDebugGeometry(const BaseCurvesDeformer::EvalContext& base_ctx, pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) {
+	const EvalContext& ctx = static_cast<const EvalContext&>(base_ctx);
+	const GuideCurvesContainer* pGuideCurvesContainer = ctx.pGuideCurvesContainer;
+
 	assert(mpGuideCurvesDeformerData);
-	assert(mpGuideCurvesContainer);
-	assert(mpCurvesContainer);
+	assert(pGuideCurvesContainer);
+	assert(ctx.pCurvesContainer);
 
 	if(!mpDebugGeo) {
 		mpDebugGeo = DebugGeo::create(getName());
@@ -2031,18 +2241,11 @@ void GuideCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const Po
 		mpDebugGeo->clear();
 	}
 
-	const auto& guides_live_points = mpGuideCurvesContainer->getLiveCurvePoints();
+	const auto& guides_live_points = pGuideCurvesContainer->getLiveCurvePoints();
 
 	switch(mpGuideCurvesDeformerData->getBindMode()) {
 		case GuideCurvesDeformerData::BindMode::BLEND:
 		{
-			std::vector<NTBFrame> live_guide_frames(guides_live_points.size());
-			
-			if(!buildNTBFrames(live_guide_frames, true /* multi threaded */, true /* live */)) {
-				DLOG_ERR << "drawDebugGeometry(time_code) NTB frames building failed.";
-				return;
-			}
-
 			// vector from curve point to frame
 			const auto& pointBinds = mpGuideCurvesDeformerData->getBlendNTBPointBinds();
 			
@@ -2052,9 +2255,9 @@ void GuideCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const Po
 				const auto& bind = pointBinds[i];
 				if(!bind.isValid()) continue;
 
-				uint32_t frame_id_0 = mpGuideCurvesContainer->getCurveVertexOffset(bind.guide_id[0]) + bind.v[0];
-				uint32_t frame_id_1 = mpGuideCurvesContainer->getCurveVertexOffset(bind.guide_id[1]) + bind.v[1];
-				uint32_t frame_id_2 = mpGuideCurvesContainer->getCurveVertexOffset(bind.guide_id[2]) + bind.v[2];
+				uint32_t frame_id_0 = pGuideCurvesContainer->getCurveVertexOffset(bind.guide_id[0]) + bind.v[0];
+				uint32_t frame_id_1 = pGuideCurvesContainer->getCurveVertexOffset(bind.guide_id[1]) + bind.v[1];
+				uint32_t frame_id_2 = pGuideCurvesContainer->getCurveVertexOffset(bind.guide_id[2]) + bind.v[2];
 
 				const pxr::GfVec3f& pt = deformed_points[i];
 
@@ -2079,17 +2282,17 @@ void GuideCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const Po
 			break;
 		case GuideCurvesDeformerData::BindMode::NTB:
 		{
-			std::vector<NTBFrame> live_guide_frames(guides_live_points.size());
-			
-			if(!buildNTBFrames(live_guide_frames, true /* multi threaded */, true /* live */)) {
-				DLOG_ERR << "drawDebugGeometry(time_code) NTB frames building failed.";
+			// live frames were already built by this frame deformation pass
+			const std::vector<NTBFrame>& live_guide_frames = ctx.liveGuideFrames;
+			if(live_guide_frames.size() != guides_live_points.size()) {
+				DLOG_ERR << "drawDebugGeometry(time_code) no live NTB frames.";
 				return;
 			}
 
 			// ntb frames
-			for(size_t guide_id = 0; guide_id < mpGuideCurvesContainer->getCurvesCount(); ++guide_id) {
-				const size_t guide_vertex_offset = mpGuideCurvesContainer->getCurveVertexOffset(guide_id);
-				for(size_t i = 0; i < 1 /*mpGuideCurvesContainer->getCurveVertexCount(guide_id)*/; ++i) {
+			for(size_t guide_id = 0; guide_id < pGuideCurvesContainer->getCurvesCount(); ++guide_id) {
+				const size_t guide_vertex_offset = pGuideCurvesContainer->getCurveVertexOffset(guide_id);
+				for(size_t i = 0; i < 1 /*pGuideCurvesContainer->getCurveVertexCount(guide_id)*/; ++i) {
 					size_t vtx = guide_vertex_offset + i; 
 					const auto& frame = live_guide_frames[vtx];
 					const auto& p = guides_live_points[vtx];
@@ -2140,7 +2343,7 @@ void GuideCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const Po
 			PhantomTrimesh* pPhantomTrimesh = mpGuidesPhantomTrimeshData->getTrimesh();
 			assert(pPhantomTrimesh);
 
-			const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
+			const auto* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
 			assert(pDeformerMeshContainer);
 
 			DLOG_DBG << "DebugGeo tetrahedrons count " << pPhantomTrimesh->getTetrahedrons().size();
@@ -2151,28 +2354,29 @@ void GuideCurvesDeformer::drawDebugGeometry(pxr::UsdTimeCode time_code, const Po
 			}
 
 			const std::vector<PhantomTrimesh::Tetrahedron>& tetrahedrons = pPhantomTrimesh->getTetrahedrons();
-			TetrahedronKDTree<PhantomTrimesh::PxrIndexType> tetraKDTree(tetrahedrons, pDeformerMeshContainer->getRestPositions());
+			TetrahedronBVH<PhantomTrimesh::PxrIndexType> tetraBVH(tetrahedrons, pDeformerMeshContainer->getRestPositions());
 
-			const auto* pRootNode = tetraKDTree.getRootNode();
-			if(!pRootNode) {
-				DLOG_ERR << "No tetrahedrons KDTree root node!";
+			if(tetraBVH.empty()) {
+				DLOG_ERR << "No tetrahedrons BVH nodes!";
 				return;
 			}
 
-			std::function<void(const TetrahedronKDTree<PhantomTrimesh::PxrIndexType>::KDNode*, float)> drawNodeBound = 
-			[&](const TetrahedronKDTree<PhantomTrimesh::PxrIndexType>::KDNode* pNode, float k_c) {
-				if (!pNode) return;
+			const auto& nodes = tetraBVH.getNodes();
+
+			std::function<void(uint32_t, float)> drawNodeBound = [&](uint32_t node_index, float k_c) {
+				const auto& node = nodes[node_index];
 
-				DebugGeo::WireframeBox box(pNode->nodeBounds);
+				DebugGeo::WireframeBox box(node.bounds);
 				box.setColor({1.0f * k_c, 0.0f, 0.0f});
 				box.setWidth(0.05f);
 				mpDebugGeo->addWireBox(box);
 
-				if (pNode->left)  drawNodeBound(pNode->left, k_c * 0.85f);
-				if (pNode->right) drawNodeBound(pNode->right, k_c * 0.85f);
+				if(node.isLeaf()) return;
+				drawNodeBound(node.offset, k_c * 0.85f);
+				drawNodeBound(node.offset + 1, k_c * 0.85f);
 			};
 
-			drawNodeBound(pRootNode, 1.0 /* color k */);
+			drawNodeBound(0, 1.0 /* color k */);
 
 			// Tetras
 			const auto& points = pDeformerMeshContainer->getRestPositions();
@@ -2208,6 +2412,9 @@ void GuideCurvesDeformer::invalidateData(DeformerDataCache& cache) {
 	cache.invalidate(mpSkinAdjacencyData);
 	cache.invalidate(mpSkinPhantomTrimeshData);
 	cache.invalidate(mpGuidesPhantomTrimeshData);
+
+	mpSkinFacesLayout = nullptr;
+	mpGuideFacesLayout = nullptr;
 }
 
 void GuideCurvesDeformer::setBindMode(GuideCurvesDeformer::BindMode mode) {
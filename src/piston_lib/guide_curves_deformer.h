@@ -8,6 +8,7 @@
 #include "guide_curves_container.h"
 #include "guide_curves_deformer_data.h"
 #include "geometry_tools.h"
+#include "live_faces_cache.h"
 #include "debug_drawing.h"
 
 #include <memory>
@@ -40,6 +41,7 @@ class GuideCurvesDeformer : public BaseCurvesDeformer, public inherit_shared_fro
 
 		static SharedPtr create(const std::string& name);
 		virtual const std::string& toString() const override;
+		virtual std::vector<pxr::SdfPath> getInputPrimPaths() const override;
 
 		void setBindMode(BindMode mode);
 		BindMode getBindMode() const;
@@ -61,26 +63,44 @@ class GuideCurvesDeformer : public BaseCurvesDeformer, public inherit_shared_fro
 		void setFastPointBind(bool fast);
 		bool isFastPointBind() const { return mFastPointBind; }
 
+		struct EvalContext : public BaseCurvesDeformer::EvalContext {
+			GuideCurvesContainer* 				pGuideCurvesContainer = nullptr;
+			const MeshContainer* 				pSkinMeshContainer = nullptr;
+
+			GuideCurvesContainer::UniquePtr 	pOwnGuideCurvesContainer;
+			MeshContainer::UniquePtr 			pOwnSkinMeshContainer;
+
+			LiveFacesCache                      skinFacesCache;  // skin faces referenced by surface binds and guide origins
+			LiveFacesCache                      guideFacesCache; // SPACE mode deformer mesh faces referenced by point binds
+			std::vector<NTBFrame>               liveGuideFrames;
+			std::vector<pxr::GfMatrix3f>        liveSegmentRotations; // ANGLE mode per guide segment rotations. Indexed by segment start vertex
+		};
+
 	protected:
 		GuideCurvesDeformer(const std::string& name);
 
 		virtual bool validateDeformerGeoPrim(const pxr::UsdPrim& geoPrim) override;
 
-		virtual bool deformImpl(PointsList& points, pxr::UsdTimeCode time_code) override;
-		virtual bool deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) override;
+		virtual bool deformImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) override;
+		virtual bool deformMtImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) override;
+
+		virtual BaseCurvesDeformer::EvalContext::UniquePtr createEvalContext() const override { return std::make_unique<EvalContext>(); }
+		virtual bool initEvalContext(BaseCurvesDeformer::EvalContext& ctx, bool make_unique) const override;
+		virtual bool canEvaluateConcurrently() const override;
 
 		virtual void invalidateData(DeformerDataCache& cache) override;
 
-		virtual void drawDebugGeometry(pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) override;
+		virtual void drawDebugGeometry(const BaseCurvesDeformer::EvalContext& ctx, pxr::UsdTimeCode time_code, const PointsList* pDeformedPoints) override;
 
 	private:
-		bool __deform__(PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code);
+		bool __deform__(EvalContext& ctx, PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code);
 
 		bool buildSkinPrimData(bool multi_threaded, pxr::UsdTimeCode rest_time_code, bool& created);
 		bool hasSkinPrimitiveData() const;
 
 		bool buildGuideOrigins(bool multi_threaded);
-		bool buildNTBFrames(std::vector<NTBFrame>& guide_frames, bool multi_threaded, bool build_live);
+		bool buildNTBFrames(const GuideCurvesContainer* pGuideCurvesContainer, const MeshContainer* pSkinMeshContainer, std::vector<NTBFrame>& guide_frames, bool multi_threaded, bool build_live, const LiveFacesCache* pSkinFacesCache = nullptr) const;
+		bool buildRestGuideInvFrames(std::vector<pxr::GfMatrix3f>& inv_frames, bool multi_threaded);
 
 		bool buildCurvesRootsBindDeformerData(pxr::UsdTimeCode rest_time_code, bool multi_threaded);
 		bool buildDeformerDataNTBMode(pxr::UsdTimeCode rest_time_code, bool multi_threaded);
@@ -90,21 +110,26 @@ class GuideCurvesDeformer : public BaseCurvesDeformer, public inherit_shared_fro
 		bool buildDeformerDataLHSMode(pxr::UsdTimeCode rest_time_code, bool multi_threaded);
 		bool buildDeformerDataBlendNTBMode(pxr::UsdTimeCode rest_time_code, bool multi_threaded);
 
-		bool deformImpl_SpaceMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
-		bool deformImpl_AngleMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
-		bool deformImpl_NTBMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool deformImpl_SpaceMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool deformImpl_AngleMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool deformImpl_NTBMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
 
-		bool deformImpl_LHSMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
-		bool deformImpl_BlendNTBMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool deformImpl_LHSMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool deformImpl_BlendNTBMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
 
 
 
-		bool moveSkinBoundPoints(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool moveSkinBoundPoints(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
 
 		bool guideIndicesNeeded() const;
 
+		void buildLiveFacesCacheLayouts();
+
+		// K nearest guide roots for every curve root, each curve's own guide excluded. Results are stored with stride k
+		bool findNeighbourGuideRoots(const USDCurveKDTree& guides_kdtree, size_t k, std::vector<USDCurveKDTree::KNNResult>& neighbour_roots, std::vector<uint32_t>& neighbour_roots_counts, bool multi_threaded);
+
 		virtual bool buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded = false);
-		virtual bool writeJsonDataToPrimImpl() const;
+		virtual void collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const override;
 
 		std::shared_ptr<GuideCurvesDeformerData>   				mpGuideCurvesDeformerData;
 		GuideCurvesContainer::UniquePtr 						mpGuideCurvesContainer;
@@ -117,6 +142,9 @@ class GuideCurvesDeformer : public BaseCurvesDeformer, public inherit_shared_fro
 
 		std::shared_ptr<SerializablePhantomTrimesh>				mpGuidesPhantomTrimeshData;
 
+		LiveFacesCache::Layout::ConstSharedPtr                  mpSkinFacesLayout;
+		LiveFacesCache::Layout::ConstSharedPtr                  mpGuideFacesLayout;
+
 		bool                                            		mFastPointBind = true;
 		bool 													mBindRootsToSkinSurface = false;
 
@@ -128,8 +156,6 @@ class GuideCurvesDeformer : public BaseCurvesDeformer, public inherit_shared_fro
 		float                                       			mFalloff = .0f;
 		BindMode                                                mBindMode;
 
-		std::vector<pxr::GfVec3f>               				mTempSkinFaceLiveNormals; // temporary to save on per-frame reallocations
-
 		DebugGeo::UniquePtr                                 	mpDebugGeo;
 };
 
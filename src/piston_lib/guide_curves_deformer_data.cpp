@@ -136,6 +136,11 @@ inline void from_json(const json& j, GuideCurvesDeformerData::BlendedNTBData& bi
 void GuideCurvesDeformerData::clearData() {
 	const std::lock_guard<std::mutex> lock(mMutex);
 
+	mPointBindsLoader.reset();
+	mPointSurfaceBindsLoader.reset();
+	mBlendNTBPointBindsLoader.reset();
+	mLHSPointBindsLoader.reset();
+
 	mPointBinds.clear();
 	mBlendNTBPointBinds.clear();
 	mLHSPointBinds.clear();
@@ -146,6 +151,17 @@ void GuideCurvesDeformerData::clearData() {
 	mIsValid = false;
 }
 
+void GuideCurvesDeformerData::ensureLoaded() const {
+	mPointBindsLoader.ensureAll();
+	mPointSurfaceBindsLoader.ensureAll();
+	mBlendNTBPointBindsLoader.ensureAll();
+	mLHSPointBindsLoader.ensureAll();
+}
+
+bool GuideCurvesDeformerData::isLoadPending() const {
+	return mPointBindsLoader.isPending() || mPointSurfaceBindsLoader.isPending() || mBlendNTBPointBindsLoader.isPending() || mLHSPointBindsLoader.isPending();
+}
+
 size_t GuideCurvesDeformerData::calcHash() const {
 	size_t hash = 0;
 
@@ -201,6 +217,8 @@ bool GuideCurvesDeformerData::dumpToJSON(json& j) const {
 	static const std::vector<PointBindDataLHS> kEmptyLHSBinds;
 	static const std::vector<BlendedNTBData> kEmptyBlendNTBBinds;
 
+	ensureLoaded();
+
 	j[kJMode] = static_cast<uint8_t>(mBindMode);
 	
 	j[kJPointBinds] = mPointBinds;
@@ -260,6 +278,76 @@ bool GuideCurvesDeformerData::readFromJSON(const json& j) {
 	return true;
 }
 
+bool GuideCurvesDeformerData::dumpToBinary(BinaryDataWriter& writer) const {
+	ensureLoaded();
+
+	writer.addValue(kJMode, static_cast<uint8_t>(mBindMode));
+	writer.addChunkedBlock(kJPointBinds, mPointBinds);
+
+	if(mBindMode == BindMode::NTB) {
+		writer.addBlock(kJGuideOrigins, mGuideOrigins);
+	} else if(mBindMode == BindMode::LHS) {
+		writer.addChunkedBlock(kJLHSPointBinds, mLHSPointBinds);
+	} else if(mBindMode == BindMode::BLEND) {
+		writer.addChunkedBlock(kJBlendNTBPointBinds, mBlendNTBPointBinds);
+	}
+
+	writer.addChunkedBlock(kJPointSurfaceBinds, mPointSurfaceBinds);
+	writer.addString(kJSkinPrimPath, mSkinPrimPath);
+	writer.addBlock(kJSkinPrimIndices, mSkinPrimIndices);
+	writer.addValue(kJDataHash, static_cast<uint64_t>(calcHash()));
+
+	return true;
+}
+
+bool GuideCurvesDeformerData::readFromBinary(const BinaryDataReader& reader) {
+	mIsValid = false;
+
+	uint8_t bind_mode;
+	if(!reader.readValue(kJMode, bind_mode)) return false;
+
+	if(static_cast<BindMode>(bind_mode) != mBindMode) {
+		LOG_ERR << typeName() << " binary data bind mode mismatch !";
+		return false;
+	}
+
+	std::string skin_prim_path;
+	if(!reader.readString(kJSkinPrimPath, skin_prim_path)) return false;
+
+	if((skin_prim_path != mSkinPrimPath) && (mBindMode == BindMode::NTB)) {
+		LOG_ERR << typeName() << " binary data skin primitive path mismatch !";
+		return false;
+	}
+
+	if(!mPointBindsLoader.attach(reader, kJPointBinds, mPointBinds)) return false;
+
+	if(mBindMode == BindMode::NTB) {
+		if(!reader.readBlock(kJGuideOrigins, mGuideOrigins)) return false;
+	} else if(mBindMode == BindMode::LHS) {
+		if(!mLHSPointBindsLoader.attach(reader, kJLHSPointBinds, mLHSPointBinds)) return false;
+	} else if(mBindMode == BindMode::BLEND) {
+		if(!mBlendNTBPointBindsLoader.attach(reader, kJBlendNTBPointBinds, mBlendNTBPointBinds)) return false;
+	}
+
+	uint64_t data_hash;
+	if(!mPointSurfaceBindsLoader.attach(reader, kJPointSurfaceBinds, mPointSurfaceBinds) ||
+		!reader.readBlock(kJSkinPrimIndices, mSkinPrimIndices) ||
+		!reader.readValue(kJDataHash, data_hash)) {
+		return false;
+	}
+
+	// Lazily decoded chunks are verified by their own checksums
+	if(!isLoadPending() && data_hash != calcHash()) {
+		LOG_ERR << typeName() << " binary data hash mismatch !";
+		return false;
+	}
+
+	LOG_DBG << "GuideCurvesDeformerData data read from binary payload !";
+
+	mIsValid = true;
+	return true;
+}
+
 void GuideCurvesDeformerData::setBindMode(const GuideCurvesDeformerData::BindMode& mode) {
 	if(mBindMode == mode) return;
 	mBindMode = mode;
@@ -12,6 +12,7 @@
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usdGeom/curves.h>
 #include <pxr/base/tf/hash.h>
+#include <pxr/base/gf/matrix3f.h>
 
 #include <glm/vec3.hpp> // glm::vec3
 
@@ -218,11 +219,11 @@ class GuideCurvesDeformerData : public SerializableDeformerDataBase {
 	public:
 		GuideCurvesDeformerData(): mIsValid(false) {}
 
-		const std::vector<PointBindData>& 			getPointBinds() const { return mPointBinds; }
-		const std::vector<BlendedNTBData>&          getBlendNTBPointBinds() const { return mBlendNTBPointBinds; }
-		const std::vector<PointBindDataLHS>&        getLHSPointBinds() const { return mLHSPointBinds; }
+		const std::vector<PointBindData>& 			getPointBinds() const { mPointBindsLoader.ensureAll(); return mPointBinds; }
+		const std::vector<BlendedNTBData>&          getBlendNTBPointBinds() const { mBlendNTBPointBindsLoader.ensureAll(); return mBlendNTBPointBinds; }
+		const std::vector<PointBindDataLHS>&        getLHSPointBinds() const { mLHSPointBindsLoader.ensureAll(); return mLHSPointBinds; }
 
-		const std::vector<PointSurfaceBindData>& 	getPointSurfaceBinds() const { return mPointSurfaceBinds; }
+		const std::vector<PointSurfaceBindData>& 	getPointSurfaceBinds() const { mPointSurfaceBindsLoader.ensureAll(); return mPointSurfaceBinds; }
 		const std::vector<GuideOrigin>& 			getGuideOrigins() const { return mGuideOrigins; }
 		const std::vector<int>& 					getSkinPrimIndices() const { return mSkinPrimIndices; }
 		BindMode        							getBindMode() const { return mBindMode; }
@@ -236,13 +237,17 @@ class GuideCurvesDeformerData : public SerializableDeformerDataBase {
 	protected:
 		virtual bool dumpToJSON(json& j) const override;
 		virtual bool readFromJSON(const json& j) override;
+
+		virtual bool hasBinaryLayout() const override { return true; }
+		virtual bool dumpToBinary(BinaryDataWriter& writer) const override;
+		virtual bool readFromBinary(const BinaryDataReader& reader) override;
 		virtual void clearData() override;
 
-		std::vector<PointBindData>& 		pointBinds() { return mPointBinds; }
-		std::vector<BlendedNTBData>&        blendNTBPointBinds() { return mBlendNTBPointBinds; }
-		std::vector<PointBindDataLHS>&      lhsPointBinds() { return mLHSPointBinds; }
+		std::vector<PointBindData>& 		pointBinds() { mPointBindsLoader.ensureAll(); return mPointBinds; }
+		std::vector<BlendedNTBData>&        blendNTBPointBinds() { mBlendNTBPointBindsLoader.ensureAll(); return mBlendNTBPointBinds; }
+		std::vector<PointBindDataLHS>&      lhsPointBinds() { mLHSPointBindsLoader.ensureAll(); return mLHSPointBinds; }
 
-		std::vector<PointSurfaceBindData>& 	pointSurfaceBinds() { return mPointSurfaceBinds; }
+		std::vector<PointSurfaceBindData>& 	pointSurfaceBinds() { mPointSurfaceBindsLoader.ensureAll(); return mPointSurfaceBinds; }
 		std::vector<GuideOrigin>& 			guideOrigins() { return mGuideOrigins; }
 		std::vector<int>&               	skinPrimIndices() { return mSkinPrimIndices; }
 		void setSkinPrimPath(const std::string& prim_path);
@@ -250,6 +255,8 @@ class GuideCurvesDeformerData : public SerializableDeformerDataBase {
 	private:
 		size_t 	calcHash() const;
 		void 	setValid(bool state) { const std::lock_guard<std::mutex> lock(mMutex); mIsValid = state;}
+		void 	ensureLoaded() const;
+		bool 	isLoadPending() const;
 
 		std::vector<PointBindData> 			mPointBinds;
 		std::vector<GuideOrigin> 			mGuideOrigins;
@@ -259,6 +266,12 @@ class GuideCurvesDeformerData : public SerializableDeformerDataBase {
 		std::vector<BlendedNTBData>         mBlendNTBPointBinds;
 		std::vector<PointBindDataLHS>  		mLHSPointBinds;
 
+		// Per point and per curve binds are decoded from chunked blocks on first access
+		LazyChunkedBlock                    mPointBindsLoader;
+		LazyChunkedBlock                    mPointSurfaceBindsLoader;
+		LazyChunkedBlock                    mBlendNTBPointBindsLoader;
+		LazyChunkedBlock                    mLHSPointBindsLoader;
+
 		BindMode                    		mBindMode = BindMode::NTB;
 		std::string                 		mSkinPrimPath;
 		std::vector<int> 					mSkinPrimIndices;
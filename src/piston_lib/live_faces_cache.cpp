@@ -0,0 +1,62 @@
+#include "live_faces_cache.h"
+#include "simple_profiler.h"
+#include "logging.h"
+
+
+namespace Piston {
+
+LiveFacesCache::Layout::ConstSharedPtr LiveFacesCache::buildLayout(const std::vector<uint32_t>& face_ids, size_t total_faces_count) {
+	auto pLayout = std::make_shared<Layout>();
+	pLayout->slots.assign(total_faces_count, kNotCached);
+
+	for(const uint32_t face_id: face_ids) {
+		if(face_id >= total_faces_count || pLayout->slots[face_id] != kNotCached) continue;
+		pLayout->slots[face_id] = static_cast<uint32_t>(pLayout->faceIds.size());
+		pLayout->faceIds.push_back(face_id);
+	}
+
+	return pLayout;
+}
+
+void LiveFacesCache::setLayout(const Layout::ConstSharedPtr& pLayout) {
+	if(mpLayout == pLayout) return;
+
+	mpLayout = pLayout;
+	mFrames.resize(mpLayout ? mpLayout->faceIds.size() : 0);
+}
+
+bool LiveFacesCache::update(const PhantomTrimesh* pTrimesh, const MeshContainer* pMeshContainer, ThreadPool* pThreadPool) {
+	PROFILE("LiveFacesCache::update");
+
+	if(!mpLayout || mFrames.empty()) return true;
+
+	assert(pTrimesh);
+	assert(pMeshContainer);
+
+	const auto& live_positions = pMeshContainer->getLivePositions();
+	const auto& face_ids = mpLayout->faceIds;
+
+	auto func = [&](const std::size_t start, const std::size_t end) {
+		for(size_t i = start; i < end; ++i) {
+			const PhantomTrimesh::TriFace& face = pTrimesh->getFace(face_ids[i]);
+			const pxr::GfVec3f& p0 = live_positions[face.indices[0]];
+			const pxr::GfVec3f& p1 = live_positions[face.indices[1]];
+			const pxr::GfVec3f& p2 = live_positions[face.indices[2]];
+
+			FaceFrame& frame = mFrames[i];
+			frame.normal = pxr::GfGetNormalized(pxr::GfCross(p1 - p0, p2 - p0), MIN_VECTOR_LENGTH_F);
+			frame.tangent = pxr::GfGetNormalized(p0 - p1);
+		}
+	};
+
+	if(pThreadPool) {
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(0u, face_ids.size(), func);
+		blocks.wait();
+	} else {
+		func(0u, face_ids.size());
+	}
+
+	return true;
+}
+
+} // namespace Piston
@@ -0,0 +1,59 @@
+#ifndef PISTON_LIB_LIVE_FACES_CACHE_H_
+#define PISTON_LIB_LIVE_FACES_CACHE_H_
+
+#include "framework.h"
+#include "phantom_trimesh.h"
+#include "mesh_container.h"
+#include "thread_pool.h"
+
+#include <pxr/base/gf/vec3f.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+
+namespace Piston {
+
+// Per frame live normals and tangents of PhantomTrimesh faces that are actually referenced by bind data.
+// Frames are computed once per frame and then shared by all deformation paths that read them.
+class LiveFacesCache {
+	public:
+		static constexpr uint32_t kNotCached = std::numeric_limits<uint32_t>::max();
+
+		struct FaceFrame {
+			pxr::GfVec3f normal;   // same as MeshContainer::getFaceLiveNormal()
+			pxr::GfVec3f tangent;  // normalized (indices[0] - indices[1]) face edge
+		};
+
+		// Immutable set of cached faces. Built once per bind data and shared between evaluation contexts
+		struct Layout {
+			using ConstSharedPtr = std::shared_ptr<const Layout>;
+
+			std::vector<uint32_t> faceIds; // unique face ids
+			std::vector<uint32_t> slots;   // face id to faceIds index map. kNotCached for faces not in the layout
+		};
+
+		static Layout::ConstSharedPtr buildLayout(const std::vector<uint32_t>& face_ids, size_t total_faces_count);
+
+		// Cheap when called with the same layout again, so it's safe to call on every context init
+		void setLayout(const Layout::ConstSharedPtr& pLayout);
+		const Layout::ConstSharedPtr& getLayout() const { return mpLayout; }
+
+		bool update(const PhantomTrimesh* pTrimesh, const MeshContainer* pMeshContainer, ThreadPool* pThreadPool = nullptr);
+
+		bool empty() const { return mFrames.empty(); }
+		bool hasFace(uint32_t face_id) const { return mpLayout && face_id < mpLayout->slots.size() && mpLayout->slots[face_id] != kNotCached; }
+
+		const FaceFrame& getFaceFrame(uint32_t face_id) const { assert(hasFace(face_id)); return mFrames[mpLayout->slots[face_id]]; }
+		const pxr::GfVec3f& getFaceNormal(uint32_t face_id) const { return getFaceFrame(face_id).normal; }
+		const pxr::GfVec3f& getFaceTangent(uint32_t face_id) const { return getFaceFrame(face_id).tangent; }
+
+	private:
+		Layout::ConstSharedPtr      mpLayout;
+		std::vector<FaceFrame>      mFrames;
+};
+
+} // namespace Piston
+
+#endif // PISTON_LIB_LIVE_FACES_CACHE_H_
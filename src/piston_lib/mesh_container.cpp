@@ -256,6 +256,8 @@ bool TemplatedMeshContainer<T>::update(const UsdPrimHandle& prim_handle, pxr::Us
 		attr = pxr::UsdGeomPointBased(prim_handle.getPrim()).GetPointsAttr();
 	}
 
+	std::shared_lock<std::shared_mutex> stage_lock(getStageAccessMutex());
+
 	if constexpr (std::is_same_v<T, pxr::VtArray<PointType>>) {
 		if(!attr.Get(&mUsdMeshLivePositions, time_code)) {
 			LOG_ERR << "Error getting point positions from " << prim_handle.getPath() << " !";
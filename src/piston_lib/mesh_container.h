@@ -39,6 +39,8 @@ class TemplatedMeshContainer: public TemplatedMeshContainerBase {
 
 		void makeUnique();
 
+		UniquePtr clone() const { return std::make_unique<TemplatedMeshContainer<T>>(*this); }
+
 	public:
 		static UniquePtr create(const UsdPrimHandle& prim_handle, pxr::UsdTimeCode rest_time_code);
 
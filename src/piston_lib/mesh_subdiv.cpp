@@ -4,6 +4,8 @@
 
 #include "mesh_subdiv.h"
 
+#include <algorithm>
+
 namespace Piston {
 
 PersistentMeshRefiner::UniquePtr PersistentMeshRefiner::create() {
@@ -12,6 +14,9 @@ PersistentMeshRefiner::UniquePtr PersistentMeshRefiner::create() {
 
 void PersistentMeshRefiner::clear() {
     mIsInitialized = false;
+    mRefinedFacesCounts.clear();
+    mRefinedFacesOffsets.clear();
+    mRefinedFacesIndices.clear();
     mOutputMesh.GetPointsAttr().Clear();
     mOutputMesh.GetFaceVertexCountsAttr().Clear();
     mOutputMesh.GetFaceVertexIndicesAttr().Clear();
@@ -170,6 +175,8 @@ bool PersistentMeshRefiner::init(const pxr::UsdGeomMesh& sourceMesh, uint8_t max
     mOutputMesh.GetFaceVertexIndicesAttr().Set(outIndices);
     mOutputMesh.GetSubdivisionSchemeAttr().Set(pxr::UsdGeomTokens->none);
 
+    buildSourceToRefinedFacesMap();
+
     //////
 
     mLastUpdateTimeCode = rest_time_code;
@@ -237,59 +244,80 @@ void PersistentMeshRefiner::update(pxr::UsdTimeCode time_code) const {
     mLastUpdateTimeCode = time_code;
 }
 
-void PersistentMeshRefiner::getSubdividedPrimsFromSource(int sourceFaceId, std::vector<int>& outFaceIds) const  {
-    outFaceIds.clear();
+void PersistentMeshRefiner::buildSourceToRefinedFacesMap() {
+    mRefinedFacesCounts.clear();
+    mRefinedFacesOffsets.clear();
+    mRefinedFacesIndices.clear();
 
-    if (!mpRefiner || sourceFaceId < 0 || sourceFaceId >= mpRefiner->GetLevel(0).GetNumFaces()) {
-        return;
-    }
+    if(!mpRefiner) return;
 
-    const OpenSubdiv::Far::TopologyLevel& refLevel = mpRefiner->GetLevel(mMaxLevel);
-    int refinedNumFaces = refLevel.GetNumFaces();
-    
-    // Trace faces instantly via cached pointer maps
+    const int sourceNumFaces = mpRefiner->GetLevel(0).GetNumFaces();
+    const int refinedNumFaces = mpRefiner->GetLevel(mMaxLevel).GetNumFaces();
+
+    // trace every refined face to its source face once
+    std::vector<int> sourceFaceIds(refinedNumFaces);
     for (int face = 0; face < refinedNumFaces; ++face) {
         int parentFace = face;
         for (int l = mMaxLevel; l > 0; --l) {
             parentFace = mpRefiner->GetLevel(l).GetFaceParentFace(parentFace);
         }
+        sourceFaceIds[face] = parentFace;
+    }
 
-        if (parentFace == sourceFaceId) {
-            outFaceIds.push_back(face);
-        }
+    mRefinedFacesCounts.assign(sourceNumFaces, 0u);
+    for (const int parentFace: sourceFaceIds) {
+        assert(parentFace >= 0 && parentFace < sourceNumFaces);
+        mRefinedFacesCounts[parentFace]++;
+    }
+
+    mRefinedFacesOffsets.resize(sourceNumFaces + 1);
+    mRefinedFacesOffsets[0] = 0u;
+    for (int i = 0; i < sourceNumFaces; ++i) {
+        mRefinedFacesOffsets[i + 1] = mRefinedFacesOffsets[i] + mRefinedFacesCounts[i];
     }
+
+    // refined faces are visited in ascending order, so each slice stays sorted
+    std::vector<uint32_t> fillOffsets(mRefinedFacesOffsets.begin(), mRefinedFacesOffsets.end() - 1);
+    mRefinedFacesIndices.resize(refinedNumFaces);
+    for (int face = 0; face < refinedNumFaces; ++face) {
+        mRefinedFacesIndices[fillOffsets[sourceFaceIds[face]]++] = face;
+    }
+
+    LOG_DBG << "PersistentMeshRefiner source to refined faces map built for " << sourceNumFaces << " source faces and " << refinedNumFaces << " refined faces";
+}
+
+PersistentMeshRefiner::FaceIdsConstPtr PersistentMeshRefiner::getSubdividedPrimsPtrFromSource(int sourceFaceId) const {
+    if (sourceFaceId < 0 || static_cast<size_t>(sourceFaceId) >= mRefinedFacesCounts.size()) {
+        return {0u, nullptr};
+    }
+
+    return {mRefinedFacesCounts[sourceFaceId], mRefinedFacesIndices.data() + mRefinedFacesOffsets[sourceFaceId]};
+}
+
+void PersistentMeshRefiner::getSubdividedPrimsFromSource(int sourceFaceId, std::vector<int>& outFaceIds) const  {
+    const FaceIdsConstPtr faces_ptr = getSubdividedPrimsPtrFromSource(sourceFaceId);
+    outFaceIds.assign(faces_ptr.second, faces_ptr.second + faces_ptr.first);
 }
 
 void PersistentMeshRefiner::getSubdividedPrimsAndVerticesFromSource(int sourceFaceId, std::vector<int>& outFaceIds, std::vector<int>& outVertexIds) const  {
-    outFaceIds.clear();
     outVertexIds.clear();
 
-    if (!mpRefiner || sourceFaceId < 0 || sourceFaceId >= mpRefiner->GetLevel(0).GetNumFaces()) {
+    getSubdividedPrimsFromSource(sourceFaceId, outFaceIds);
+    if (outFaceIds.empty()) {
         return;
     }
 
     const OpenSubdiv::Far::TopologyLevel& refLevel = mpRefiner->GetLevel(mMaxLevel);
-    int refinedNumFaces = refLevel.GetNumFaces();
-    std::set<int> uniqueVerts;
 
-    // Trace faces instantly via cached pointer maps
-    for (int face = 0; face < refinedNumFaces; ++face) {
-        int parentFace = face;
-        for (int l = mMaxLevel; l > 0; --l) {
-            parentFace = mpRefiner->GetLevel(l).GetFaceParentFace(parentFace);
-        }
-
-        if (parentFace == sourceFaceId) {
-            outFaceIds.push_back(face);
-            
-            OpenSubdiv::Far::ConstIndexArray faceVerts = refLevel.GetFaceVertices(face);
-            for (int i = 0; i < faceVerts.size(); ++i) {
-                uniqueVerts.insert(faceVerts[i]);
-            }
+    for (const int face: outFaceIds) {
+        OpenSubdiv::Far::ConstIndexArray faceVerts = refLevel.GetFaceVertices(face);
+        for (int i = 0; i < faceVerts.size(); ++i) {
+            outVertexIds.push_back(faceVerts[i]);
         }
     }
 
-    outVertexIds.assign(uniqueVerts.begin(), uniqueVerts.end());
+    std::sort(outVertexIds.begin(), outVertexIds.end());
+    outVertexIds.erase(std::unique(outVertexIds.begin(), outVertexIds.end()), outVertexIds.end());
 }
 
 void PersistentMeshRefiner::querySubdividedPoints(int sourceFaceId, std::vector<pxr::GfVec3f>& points, uint32_t& count) const {
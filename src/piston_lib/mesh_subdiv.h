@@ -39,6 +39,7 @@ struct OpenSubdVertex {
 class PersistentMeshRefiner {
 	public:
 		using UniquePtr = std::unique_ptr<PersistentMeshRefiner>;
+		using FaceIdsConstPtr = std::pair<uint32_t, const int*>;  // refined face ids <count, ptr> pair
 
 	    PersistentMeshRefiner(): mIsInitialized(false), mMaxLevel(0) {};
 
@@ -58,6 +59,8 @@ class PersistentMeshRefiner {
      	 */
 
 		void getSubdividedPrimsFromSource(int sourceFaceId, std::vector<int>& outFaceIds) const;
+		// no-copy slice of the source to refined faces map. {0, nullptr} for invalid source face id
+		FaceIdsConstPtr getSubdividedPrimsPtrFromSource(int sourceFaceId) const;
 		void getSubdividedPrimsAndVerticesFromSource(int sourceFaceId, std::vector<int>& outFaceIds, std::vector<int>& outVertexIds) const;
 
 	    void querySubdividedPoints(int sourceFaceId, std::vector<pxr::GfVec3f>& points, uint32_t& count) const;
@@ -78,6 +81,9 @@ class PersistentMeshRefiner {
 	protected:
 		void clear();
 
+	private:
+		void buildSourceToRefinedFacesMap();
+
 	private:
 	    bool mIsInitialized = false;
 	    uint8_t mMaxLevel = 0;
@@ -95,6 +101,11 @@ class PersistentMeshRefiner {
 	    mutable std::vector<OpenSubdVertex>  mTmpVertexBuffer;
 	    mutable pxr::VtVec3fArray 			 mTmpOutPoints;
 
+	    // source face to refined faces map in CSR form. Built once per topology
+	    std::vector<uint32_t>                mRefinedFacesCounts;
+	    std::vector<uint32_t>                mRefinedFacesOffsets;
+	    std::vector<int>                     mRefinedFacesIndices;
+
 	   	friend class UsdPrimHandle;
 };
 
@@ -1,9 +1,23 @@
 #include "framework.h"
 #include "os.h"
+#include "logging.h"
 
 #include <string>
 #include <cassert>
 #include <cstdlib>
+#include <cstdio>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace Piston {
 
@@ -20,4 +34,191 @@ bool getEnvVar(const std::string& var_name, std::string& var_value) {
     return false;
 }
 
+std::string getTempDirPath() {
+    std::string path;
+#if defined(_WIN32)
+    if(getEnvVar("TEMP", path) && !path.empty()) return path;
+    if(getEnvVar("TMP", path) && !path.empty()) return path;
+    return ".";
+#else
+    if(getEnvVar("TMPDIR", path) && !path.empty()) return path;
+    return "/tmp";
+#endif
+}
+
+MappedScratchFile::UniquePtr MappedScratchFile::create(const std::string& dir_path, size_t size_bytes) {
+    if(size_bytes == 0) return nullptr;
+
+    MappedScratchFile::UniquePtr pFile = MappedScratchFile::UniquePtr(new MappedScratchFile());
+    pFile->mSize = size_bytes;
+
+#if defined(_WIN32)
+    char file_path[MAX_PATH];
+    if(GetTempFileNameA(dir_path.c_str(), "pst", 0, file_path) == 0) {
+        LOG_ERR << "Error creating scratch file in \"" << dir_path << "\" !";
+        return nullptr;
+    }
+
+    HANDLE file_handle = CreateFileA(file_path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, 
+        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if(file_handle == INVALID_HANDLE_VALUE) {
+        LOG_ERR << "Error opening scratch file \"" << file_path << "\" !";
+        return nullptr;
+    }
+    pFile->mFileHandle = file_handle;
+
+    const DWORD size_hi = static_cast<DWORD>(static_cast<uint64_t>(size_bytes) >> 32);
+    const DWORD size_lo = static_cast<DWORD>(static_cast<uint64_t>(size_bytes) & 0xFFFFFFFFull);
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READWRITE, size_hi, size_lo, nullptr);
+    if(mapping_handle == nullptr) {
+        LOG_ERR << "Error mapping scratch file \"" << file_path << "\" !";
+        return nullptr;
+    }
+    pFile->mMappingHandle = mapping_handle;
+
+    pFile->mpData = static_cast<uint8_t*>(MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, size_bytes));
+    if(!pFile->mpData) {
+        LOG_ERR << "Error mapping scratch file \"" << file_path << "\" view !";
+        return nullptr;
+    }
+#else
+    std::string file_path = dir_path + "/piston_scratch_XXXXXX";
+    pFile->mFd = mkstemp(file_path.data());
+    if(pFile->mFd < 0) {
+        LOG_ERR << "Error creating scratch file in \"" << dir_path << "\": " << std::strerror(errno);
+        return nullptr;
+    }
+
+    // file stays accessible through the descriptor only
+    unlink(file_path.c_str());
+
+    if(ftruncate(pFile->mFd, static_cast<off_t>(size_bytes)) != 0) {
+        LOG_ERR << "Error resizing scratch file to " << size_bytes << " bytes: " << std::strerror(errno);
+        return nullptr;
+    }
+
+    void* pData = mmap(nullptr, size_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, pFile->mFd, 0);
+    if(pData == MAP_FAILED) {
+        LOG_ERR << "Error mapping scratch file: " << std::strerror(errno);
+        return nullptr;
+    }
+    pFile->mpData = static_cast<uint8_t*>(pData);
+#endif
+
+    return pFile;
+}
+
+MappedScratchFile::~MappedScratchFile() {
+#if defined(_WIN32)
+    if(mpData) UnmapViewOfFile(mpData);
+    if(mMappingHandle) CloseHandle(static_cast<HANDLE>(mMappingHandle));
+    if(mFileHandle) CloseHandle(static_cast<HANDLE>(mFileHandle));
+#else
+    if(mpData) munmap(mpData, mSize);
+    if(mFd >= 0) close(mFd);
+#endif
+}
+
+MappedFile::UniquePtr MappedFile::open(const std::string& file_path) {
+    MappedFile::UniquePtr pFile = MappedFile::UniquePtr(new MappedFile());
+
+#if defined(_WIN32)
+    HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file_handle == INVALID_HANDLE_VALUE) {
+        LOG_ERR << "Error opening file \"" << file_path << "\" !";
+        return nullptr;
+    }
+    pFile->mFileHandle = file_handle;
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+        LOG_ERR << "File \"" << file_path << "\" is empty !";
+        return nullptr;
+    }
+    pFile->mSize = static_cast<size_t>(file_size.QuadPart);
+
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping_handle == nullptr) {
+        LOG_ERR << "Error mapping file \"" << file_path << "\" !";
+        return nullptr;
+    }
+    pFile->mMappingHandle = mapping_handle;
+
+    pFile->mpData = static_cast<uint8_t*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if(!pFile->mpData) {
+        LOG_ERR << "Error mapping file \"" << file_path << "\" view !";
+        return nullptr;
+    }
+#else
+    pFile->mFd = ::open(file_path.c_str(), O_RDONLY);
+    if(pFile->mFd < 0) {
+        LOG_ERR << "Error opening file \"" << file_path << "\": " << std::strerror(errno);
+        return nullptr;
+    }
+
+    struct stat file_stat;
+    if(fstat(pFile->mFd, &file_stat) != 0 || file_stat.st_size == 0) {
+        LOG_ERR << "File \"" << file_path << "\" is empty or unreadable !";
+        return nullptr;
+    }
+    pFile->mSize = static_cast<size_t>(file_stat.st_size);
+
+    void* pData = mmap(nullptr, pFile->mSize, PROT_READ, MAP_SHARED, pFile->mFd, 0);
+    if(pData == MAP_FAILED) {
+        LOG_ERR << "Error mapping file \"" << file_path << "\": " << std::strerror(errno);
+        return nullptr;
+    }
+    pFile->mpData = static_cast<uint8_t*>(pData);
+#endif
+
+    return pFile;
+}
+
+MappedFile::~MappedFile() {
+#if defined(_WIN32)
+    if(mpData) UnmapViewOfFile(mpData);
+    if(mMappingHandle) CloseHandle(static_cast<HANDLE>(mMappingHandle));
+    if(mFileHandle) CloseHandle(static_cast<HANDLE>(mFileHandle));
+#else
+    if(mpData) munmap(mpData, mSize);
+    if(mFd >= 0) close(mFd);
+#endif
+}
+
+bool writeFileReplace(const std::string& file_path, const uint8_t* pData, size_t size) {
+    const std::string tmp_file_path = file_path + ".tmp";
+
+    {
+        std::ofstream file(tmp_file_path, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) {
+            LOG_ERR << "Error creating file \"" << tmp_file_path << "\" !";
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(pData), static_cast<std::streamsize>(size));
+        if(!file.good()) {
+            LOG_ERR << "Error writing file \"" << tmp_file_path << "\" !";
+            file.close();
+            std::remove(tmp_file_path.c_str());
+            return false;
+        }
+    }
+
+#if defined(_WIN32)
+    // Fails with ERROR_ACCESS_DENIED / ERROR_SHARING_VIOLATION while the target file is mapped
+    const bool replaced = MoveFileExA(tmp_file_path.c_str(), file_path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool replaced = std::rename(tmp_file_path.c_str(), file_path.c_str()) == 0;
+#endif
+
+    if(!replaced) {
+        LOG_ERR << "Error replacing file \"" << file_path << "\" !";
+        std::remove(tmp_file_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace Piston
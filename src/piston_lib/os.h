@@ -1,12 +1,85 @@
 #ifndef PISTON_LIB_OS_H_
 #define PISTON_LIB_OS_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace Piston {
 
 bool getEnvVar(const std::string& var_name, std::string& var_value);
 
+// Default directory for temporary files (TMPDIR/TEMP or system default)
+std::string getTempDirPath();
+
+// Read/write memory mapped scratch file of fixed size. File is anonymous (or deleted on close) and never outlives the object
+class MappedScratchFile {
+    public:
+        using UniquePtr = std::unique_ptr<MappedScratchFile>;
+
+        // Returns nullptr on failure
+        static UniquePtr create(const std::string& dir_path, size_t size_bytes);
+
+        ~MappedScratchFile();
+
+        MappedScratchFile(const MappedScratchFile&) = delete;
+        MappedScratchFile& operator=(const MappedScratchFile&) = delete;
+
+        uint8_t* data() { return mpData; }
+        const uint8_t* data() const { return mpData; }
+        size_t size() const { return mSize; }
+
+    private:
+        MappedScratchFile() = default;
+
+        uint8_t*    mpData = nullptr;
+        size_t      mSize = 0;
+
+#if defined(_WIN32)
+        void*       mFileHandle = nullptr;
+        void*       mMappingHandle = nullptr;
+#else
+        int         mFd = -1;
+#endif
+};
+
+// Read only memory mapped file. Mapping is shared, so processes mapping the same file share physical pages
+// and pages are read from disk only when touched.
+class MappedFile {
+    public:
+        using UniquePtr = std::unique_ptr<MappedFile>;
+
+        // Returns nullptr on failure
+        static UniquePtr open(const std::string& file_path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const { return mpData; }
+        size_t size() const { return mSize; }
+
+    private:
+        MappedFile() = default;
+
+        uint8_t*    mpData = nullptr;
+        size_t      mSize = 0;
+
+#if defined(_WIN32)
+        void*       mFileHandle = nullptr;
+        void*       mMappingHandle = nullptr;
+#else
+        int         mFd = -1;
+#endif
+};
+
+// Writes data to a temporary file which then replaces file_path. Readers never see a partially written file.
+// On POSIX existing mappings keep the old file contents. On Windows the replace fails while file_path is still mapped
+// (MappedFile of data that isn't fully decoded yet), the old file is kept and false is returned
+bool writeFileReplace(const std::string& file_path, const uint8_t* pData, size_t size);
+
 } // namespace Piston
 
-#endif // PISTON_LIB_OS_H_
\ No newline at end of file
+#endif // PISTON_LIB_OS_H_
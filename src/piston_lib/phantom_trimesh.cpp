@@ -88,7 +88,7 @@ bool PhantomTrimesh::init(const UsdPrimHandle& prim_handle, pxr::UsdTimeCode res
 #ifdef USE_CGAL
 
 template <typename T>
-bool PhantomTrimesh::buildTetrahedrons(const T& positions, const GuideCurvesContainer* pCurvesContainer) {
+bool PhantomTrimesh::buildTetrahedrons(const T& positions, const GuideCurvesContainer* pCurvesContainer, ThreadPool* pThreadPool) {
 	PROFILE("PhantomTrimesh::buildTetrahedrons");
 	static_assert(std::is_same_v<T, std::vector<pxr::GfVec3f>> || std::is_same_v<T, pxr::VtArray<pxr::GfVec3f>>, "Only std::vector<pxr::GfVec3f> and pxr::VtArray<pxr::GfVec3f> types are permitted!"); 
 
@@ -104,7 +104,12 @@ bool PhantomTrimesh::buildTetrahedrons(const T& positions, const GuideCurvesCont
 	using Cb_with_alpha = CGAL::Alpha_shape_cell_base_3<Kernel, Rt_Cb>;
 
 	// 4. Mesh Assembly Topology Types
-	using Tds = CGAL::Triangulation_data_structure_3<Vb_with_info, Cb_with_alpha>;
+#ifdef CGAL_LINKED_WITH_TBB
+	using Concurrency_tag = CGAL::Parallel_tag;
+#else
+	using Concurrency_tag = CGAL::Sequential_tag;
+#endif
+	using Tds = CGAL::Triangulation_data_structure_3<Vb_with_info, Cb_with_alpha, Concurrency_tag>;
 	using Rt = CGAL::Regular_triangulation_3<Kernel, Tds>;
 	using Weighted_Alpha_shape = CGAL::Alpha_shape_3<Rt>;  
 
@@ -159,46 +164,59 @@ bool PhantomTrimesh::buildTetrahedrons(const T& positions, const GuideCurvesCont
 	// Calc point weights
 	neighbour_search::KDTree<float, 3> deformer_restpoints_kdtree = neighbour_search::KDTree<float, 3>(positions, true /* multi threaded */);
 
-	std::vector<std::tuple<Weighted_point, unsigned int>> input_data;
-     
+	std::vector<std::pair<Weighted_point, unsigned int>> input_data(points_count);
+
 	static const auto kClosestNeighborsCount = 4;
 
-	for(size_t i = 0; i < points_count; ++i) {
-		const auto& pxr_pt = positions[i];
-  		std::vector<neighbour_search::KDTree<float, 3>::ReturnType> closest_points(kClosestNeighborsCount);
-  		deformer_restpoints_kdtree.findKNearestNeighbours(pxr_pt, kClosestNeighborsCount, closest_points);
-
-  		double total_distance = 0.0;
-  		uint32_t count = 0;
-  		for(uint32_t j = 0; j < kClosestNeighborsCount; ++j) {
-  			auto dist = distance(pxr_pt, positions[closest_points[j].first]);
-  			if(dist > 0.0001) {
-  				total_distance += dist;
-  				count++;
-  			}
-  		}
-
-  		double avg_neighbor_distance = (count > 0) ? (total_distance / count) : 1.0;
-  		double calculated_radius = avg_neighbor_distance * 0.5;
-  		double target_weight = calculated_radius * calculated_radius;
-
-  		input_data.push_back({Weighted_point(Point_3(pxr_pt[0], pxr_pt[1], pxr_pt[2]), target_weight), (unsigned int)i});
-  	}
+	auto weights_func = [&](const std::size_t start, const std::size_t end) {
+		std::vector<neighbour_search::KDTree<float, 3>::ReturnType> closest_points;
+		closest_points.reserve(kClosestNeighborsCount);
+
+		for(size_t i = start; i < end; ++i) {
+			const auto& pxr_pt = positions[i];
+			deformer_restpoints_kdtree.findKNearestNeighbours(pxr_pt, kClosestNeighborsCount, closest_points);
+
+			double total_distance = 0.0;
+			uint32_t count = 0;
+			for(const auto& closest_point: closest_points) {
+				auto dist = distance(pxr_pt, positions[closest_point.first]);
+				if(dist > 0.0001) {
+					total_distance += dist;
+					count++;
+				}
+			}
+
+			double avg_neighbor_distance = (count > 0) ? (total_distance / count) : 1.0;
+			double calculated_radius = avg_neighbor_distance * 0.5;
+			double target_weight = calculated_radius * calculated_radius;
 
-  	Rt rt;
+			input_data[i] = {Weighted_point(Point_3(pxr_pt[0], pxr_pt[1], pxr_pt[2]), target_weight), (unsigned int)i};
+		}
+	};
 
-  	// Insert points one-by-one to explicitly couple the vertex info
-    for (const auto& item : input_data) {
-        Weighted_point wp = std::get<0>(item);
-        uint32_t source_idx   = std::get<1>(item);
+	if(pThreadPool) {
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(0u, points_count, weights_func);
+		blocks.wait();
+	} else {
+		weights_func(0u, points_count);
+	}
 
-        Rt::Vertex_handle vh = rt.insert(wp);
-        
-        // Handle overlapping points or geometric degeneracies gracefully
-        if (vh != Rt::Vertex_handle()) {
-            vh->info() = source_idx; // Assign the original index to the CGAL vertex
-        }
-    }
+	// Range insertion spatially sorts the points (Hilbert order) before inserting and keeps the vertex info coupled.
+	// Overlapping points are hidden and don't produce vertices
+#ifdef CGAL_LINKED_WITH_TBB
+	CGAL::Bbox_3 bbox;
+	for(const auto& item: input_data) {
+		bbox += item.first.point().bbox();
+	}
+
+	static const int kLockGridCellsPerAxis = 50;
+	Rt::Lock_data_structure locking_ds(bbox, kLockGridCellsPerAxis);
+	Rt rt(Kernel(), pThreadPool ? &locking_ds : nullptr);
+#else
+	Rt rt;
+#endif
+
+	rt.insert(input_data.begin(), input_data.end());
 
 	//Triangulation tr(points.begin(), points.end());
 	//Delaunay tr(points.begin(), points.end());
@@ -280,7 +298,7 @@ bool PhantomTrimesh::buildTetrahedrons(const T& positions, const GuideCurvesCont
 
 
 template <typename T>
-bool PhantomTrimesh::buildTetrahedrons(const T& positions) {
+bool PhantomTrimesh::buildTetrahedrons(const T& positions, const GuideCurvesContainer* pCurvesContainer, ThreadPool* pThreadPool) {
 	LOG_ERR << "PhantomTrimesh::buildTetrahedrons() NOT IMPLEMENTED !!!";
 	return false;
 }
@@ -370,6 +388,112 @@ uint32_t PhantomTrimesh::getOrCreateFaceID(const std::array<PxrIndexType, 3>& a)
 	return getOrCreateFaceID(a[0], a[1], a[2]);
 }
 
+PhantomTrimesh::TriFace PhantomTrimesh::makeFace(PxrIndexType a, PxrIndexType b, PxrIndexType c) {
+	assert((a != b) && (a != c) && (b != c));
+	std::array<PhantomTrimesh::PxrIndexType, 3> indices{a, b, c};
+	std::sort(indices.begin(), indices.end());
+	return TriFace(indices);
+}
+
+void PhantomTrimesh::createFaceIDs(const std::vector<TriFace::IndicesList>& candidates, std::vector<uint32_t>& face_ids, ThreadPool* pThreadPool) {
+	using IndicesList = TriFace::IndicesList;
+
+	face_ids.resize(candidates.size());
+
+	// Phase 1. Sort and unique all valid candidates
+	std::vector<IndicesList> keys;
+	keys.reserve(candidates.size());
+	for(const auto& c: candidates) {
+		if(c[0] != TriFace::kInvalidVertexID) keys.push_back(c);
+	}
+
+	if(pThreadPool && keys.size() > 1) {
+		// sort blocks in parallel, then merge neighbouring sorted ranges pairwise
+		std::vector<size_t> bounds;
+		std::mutex bounds_mutex;
+
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(size_t(0), keys.size(), [&](const size_t start, const size_t end) {
+			std::sort(keys.begin() + start, keys.begin() + end);
+			const std::lock_guard<std::mutex> lock(bounds_mutex);
+			bounds.push_back(start);
+		});
+		blocks.wait();
+
+		std::sort(bounds.begin(), bounds.end());
+		bounds.push_back(keys.size());
+
+		while(bounds.size() > 2) {
+			const size_t pairs_count = (bounds.size() - 1) / 2;
+			BS::multi_future<void> merges = pThreadPool->submit_sequence(size_t(0), pairs_count, [&](const size_t i) {
+				std::inplace_merge(keys.begin() + bounds[i * 2], keys.begin() + bounds[i * 2 + 1], keys.begin() + bounds[i * 2 + 2]);
+			});
+			merges.wait();
+
+			std::vector<size_t> merged_bounds;
+			for(size_t i = 0; i < bounds.size(); i += 2) {
+				merged_bounds.push_back(bounds[i]);
+			}
+			if(merged_bounds.back() != keys.size()) merged_bounds.push_back(keys.size());
+			bounds.swap(merged_bounds);
+		}
+	} else {
+		std::sort(keys.begin(), keys.end());
+	}
+
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	// Phase 2. Register new faces in sorted order
+	std::vector<uint32_t> key_ids(keys.size());
+	{
+		std::scoped_lock lock(mFaceMapMutex);
+
+		for(size_t i = 0; i < keys.size(); ++i) {
+			const IndicesList& indices = keys[i];
+
+			auto it = mFaceMap.find(indices);
+			if(it != mFaceMap.end()) {
+				key_ids[i] = static_cast<uint32_t>(it->second);
+				continue;
+			}
+
+			const uint32_t idx = static_cast<uint32_t>(mFaces.size());
+
+			mFaces.emplace_back(indices);
+			mFaceFlags.emplace_back(TriFace::Flags::None);
+
+			for(const PxrIndexType vtx: indices) {
+				if(mTmpVertices.insert(vtx).second == true) mVertices.push_back(vtx);
+			}
+
+			mFaceMap[indices] = idx;
+			key_ids[i] = idx;
+		}
+	}
+
+	// Phase 3. Resolve candidates
+	auto func = [&](const size_t start, const size_t end) {
+		for(size_t i = start; i < end; ++i) {
+			const IndicesList& c = candidates[i];
+			if(c[0] == TriFace::kInvalidVertexID) {
+				face_ids[i] = kInvalidTriFaceID;
+				continue;
+			}
+			const auto it = std::lower_bound(keys.begin(), keys.end(), c);
+			assert(it != keys.end() && *it == c);
+			face_ids[i] = key_ids[std::distance(keys.begin(), it)];
+		}
+	};
+
+	if(pThreadPool) {
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(size_t(0), candidates.size(), func);
+		blocks.wait();
+	} else {
+		func(0, candidates.size());
+	}
+
+	LOG_DBG << "PhantomTrimesh::createFaceIDs() resolved " << candidates.size() << " candidates to " << keys.size() << " unique faces. Total faces count " << mFaces.size();
+}
+
 size_t PhantomTrimesh::calcHash() const {
 	size_t hash = 0;
 
@@ -509,6 +633,88 @@ bool SerializablePhantomTrimesh::readFromJSON(const json& j) {
 	return true;
 }
 
+static constexpr const char* kBFaceMapKeys = "face_map_keys";
+static constexpr const char* kBFaceMapValues = "face_map_values";
+
+bool SerializablePhantomTrimesh::dumpToBinary(BinaryDataWriter& writer) const {
+	if(!mpTrimesh || !mpTrimesh->isValid()) return false;
+
+	// Only face indices are stored, same as json
+	const auto& faces = mpTrimesh->mFaces;
+	PhantomTrimesh::TriFace::IndicesList* pFaces = writer.allocBlock<PhantomTrimesh::TriFace::IndicesList>(kJFaces, faces.size());
+	for(size_t i = 0; i < faces.size(); ++i) {
+		pFaces[i] = faces[i].indices;
+	}
+
+	const auto& face_map = mpTrimesh->mFaceMap;
+	PhantomTrimesh::TriFace::IndicesList* pKeys = writer.allocBlock<PhantomTrimesh::TriFace::IndicesList>(kBFaceMapKeys, face_map.size());
+	uint64_t* pValues = writer.allocBlock<uint64_t>(kBFaceMapValues, face_map.size());
+	for(const auto& [k, v]: face_map) {
+		*pKeys++ = k;
+		*pValues++ = static_cast<uint64_t>(v);
+	}
+
+	writer.addBlock(kJFaceFlags, mpTrimesh->mFaceFlags);
+	writer.addBlock(kJVertices, mpTrimesh->mVertices);
+	writer.addValue(kJDataHash, static_cast<uint64_t>(mpTrimesh->calcHash()));
+
+	return true;
+}
+
+bool SerializablePhantomTrimesh::readFromBinary(const BinaryDataReader& reader) {
+	mpTrimesh = std::make_unique<PhantomTrimesh>();
+	mpTrimesh->mIsValid = false;
+
+	BinaryData::ConstSpan<PhantomTrimesh::TriFace::IndicesList> faces;
+	BinaryData::ConstSpan<PhantomTrimesh::TriFace::IndicesList> face_map_keys;
+	BinaryData::ConstSpan<uint64_t> face_map_values;
+	uint64_t data_hash;
+
+	if(!reader.getSpan(kJFaces, faces) ||
+		!reader.getSpan(kBFaceMapKeys, face_map_keys) ||
+		!reader.getSpan(kBFaceMapValues, face_map_values) ||
+		!reader.readBlock(kJFaceFlags, mpTrimesh->mFaceFlags) ||
+		!reader.readBlock(kJVertices, mpTrimesh->mVertices) ||
+		!reader.readValue(kJDataHash, data_hash)) {
+		return false;
+	}
+
+	if(face_map_keys.size() != face_map_values.size()) {
+		LOG_ERR << "Trimesh face map keys and values array sizes mismatch!";
+		return false;
+	}
+
+	mpTrimesh->mFaces.reserve(faces.size());
+	for(const auto& indices: faces) {
+		mpTrimesh->mFaces.emplace_back(indices);
+	}
+
+	mpTrimesh->mFaceMap.reserve(face_map_keys.size());
+	for(size_t i = 0; i < face_map_keys.size(); ++i) {
+		mpTrimesh->mFaceMap.emplace(face_map_keys[i], static_cast<size_t>(face_map_values[i]));
+	}
+
+	if(mpTrimesh->calcHash() != data_hash) {
+		return false;
+	}
+
+	if(mpTrimesh->mFaces.size() != mpTrimesh->mFaceFlags.size()) {
+		LOG_ERR << "Trimesh face and face_flags array sizes mismatch!";
+		return false;
+	}
+
+	mpTrimesh->mTmpVertices.clear();
+	for(const auto& vtx: mpTrimesh->mVertices) {
+		mpTrimesh->mTmpVertices.insert(vtx);
+	}
+
+	mpTrimesh->mIsValid = true;
+
+	LOG_DBG << "PhantomTrimesh data read from binary payload.";
+
+	return true;
+}
+
 void SerializablePhantomTrimesh::setValid(bool state) {
 	if(!mpTrimesh) return;
 
@@ -543,7 +749,7 @@ const SerializableDeformerDataBase::DataVersion& SerializablePhantomTrimesh::jso
 	return kTrimeshDataVersion;
 }
 
-template bool PhantomTrimesh::buildTetrahedrons(const std::vector<pxr::GfVec3f>& positions, const GuideCurvesContainer* pCurvesContainer);
-template bool PhantomTrimesh::buildTetrahedrons(const pxr::VtArray<pxr::GfVec3f>& positions, const GuideCurvesContainer* pCurvesContainer);
+template bool PhantomTrimesh::buildTetrahedrons(const std::vector<pxr::GfVec3f>& positions, const GuideCurvesContainer* pCurvesContainer, ThreadPool* pThreadPool);
+template bool PhantomTrimesh::buildTetrahedrons(const pxr::VtArray<pxr::GfVec3f>& positions, const GuideCurvesContainer* pCurvesContainer, ThreadPool* pThreadPool);
 
 } // namespace Piston
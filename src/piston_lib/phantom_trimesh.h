@@ -7,6 +7,7 @@
 #include "serializable_data.h"
 #include "tetrahedron.h"
 #include "logging.h"
+#include "thread_pool.h"
 
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/base/gf/matrix3f.h>
@@ -58,6 +59,8 @@ class PhantomTrimesh {
 				Default = None
 			};
 
+			static constexpr IndicesList kInvalidIndices = {kInvalidVertexID, kInvalidVertexID, kInvalidVertexID};
+
 			TriFace(): indices{kInvalidVertexID} { }
 			TriFace(PxrIndexType a, PxrIndexType b, PxrIndexType c): indices{a, b, c} { }
 			TriFace(const std::array<PxrIndexType, 3>& d): indices{d} { }
@@ -96,6 +99,12 @@ class PhantomTrimesh {
 		uint32_t getOrCreateFaceID(PxrIndexType a, PxrIndexType b, PxrIndexType c);
 		uint32_t getOrCreateFaceID(const std::array<PxrIndexType, 3>& a);
 
+		// Two-phase face creation. Binding threads describe candidate faces with makeFace() without touching the trimesh
+		// and keep their indices. createFaceIDs() then merges all candidates at once. New faces are added in sorted indices
+		// order, so resulting face ids don't depend on threads interleaving. Invalid candidates resolve to kInvalidTriFaceID.
+		static TriFace makeFace(PxrIndexType a, PxrIndexType b, PxrIndexType c);
+		void createFaceIDs(const std::vector<TriFace::IndicesList>& candidates, std::vector<uint32_t>& face_ids, ThreadPool* pThreadPool = nullptr);
+
 		const std::vector<TriFace>& getFaces() const { return mFaces; }
 		const TriFace& getFace(const uint32_t id) const { 
 
@@ -116,7 +125,7 @@ class PhantomTrimesh {
 		void invalidate();
 
 		template <typename T>
-		bool buildTetrahedrons(const T& positions, const GuideCurvesContainer* pCurvesContainer = nullptr /* used to filter out invald tetrahedrons */);
+		bool buildTetrahedrons(const T& positions, const GuideCurvesContainer* pCurvesContainer = nullptr /* used to filter out invald tetrahedrons */, ThreadPool* pThreadPool = nullptr);
 
 		bool hasTetrahedrons() const;
 		const std::vector<Tetrahedron>& getTetrahedrons() const { return mTetrahedrons; }
@@ -178,6 +187,10 @@ class SerializablePhantomTrimesh: public SerializableDeformerDataBase {
 		virtual bool dumpToJSON(json& j) const override;
 		virtual bool readFromJSON(const json& j) override;
 
+		virtual bool hasBinaryLayout() const override { return true; }
+		virtual bool dumpToBinary(BinaryDataWriter& writer) const override;
+		virtual bool readFromBinary(const BinaryDataReader& reader) override;
+
 		virtual void clearData() override;
 
 	private:
@@ -2,11 +2,15 @@
 #include "common.h"
 #include "logging.h"
 
+#include <cstdio>
+#include <iterator>
+#include <limits>
+
 namespace Piston {
 
 static const size_t kMinEntries = 4; // 1 frame ofo current deformed curve points, 2 more frames for worst case motoin blur and 1 frame for velocities.
 
-PxrPointsLRUCache::PxrPointsLRUCache(const size_t max_mem_size_bytes): mMaxMemSizeBytes(max_mem_size_bytes), mCurrentMemSizeBytes(0), mShrinkLock(false), mMinEntries(kMinEntries) {
+PxrPointsLRUCache::PxrPointsLRUCache(const size_t max_mem_size_bytes): mMaxMemSizeBytes(max_mem_size_bytes), mCurrentMemSizeBytes(0), mItemsCount(0), mTick(0), mMinEntries(kMinEntries), mShrinkLock(0) {
 	LOG_INF << "PxrPointsLRUCache with " << std::string(stringifyMemSize(mMaxMemSizeBytes)) << " memory cap created.";
 }
 
@@ -16,16 +20,19 @@ PxrPointsLRUCache::UniquePtr PxrPointsLRUCache::create(const size_t max_mem_size
 	return pResult;
 }
 
-size_t PxrPointsLRUCache::getMemSize() const {
-	if(mCurrentMemSizeBytes != kInvalidUsedMemSize) return mCurrentMemSizeBytes;
+PxrPointsLRUCache::Shard* PxrPointsLRUCache::findShard(DeformerID deformer_id) const {
+	auto it = mShards.find(deformer_id);
+	return (it != mShards.end()) ? it->second.get() : nullptr;
+}
 
-	mCurrentMemSizeBytes = 0;
+void PxrPointsLRUCache::eraseEntry(Shard& shard, EntriesList::iterator it) {
+	const size_t mem_size = it->bytes;
+	shard.memSize -= mem_size;
+	mCurrentMemSizeBytes -= mem_size;
+	mItemsCount--;
 
-	for(const auto& pair: mCacheItemsList) {
-		mCurrentMemSizeBytes += pair.second.sizeInBytes();
-	}
-
-	return mCurrentMemSizeBytes;
+	shard.map.erase(it->key);
+	shard.items.erase(it);
 }
 
 PointsList* PxrPointsLRUCache::put(const CompositeKey& key, size_t points_count, bool init_to_zero) {
@@ -38,35 +45,92 @@ PointsList* PxrPointsLRUCache::put(const CompositeKey& key, size_t points_count,
 	return put(key, std::move(points));
 }
 
+bool PxrPointsLRUCache::enableSpillStore(const std::string& dir_path, size_t budget_bytes) {
+	mpSpillStore = PxrPointsSpillStore::create(dir_path, budget_bytes);
+	return mpSpillStore != nullptr;
+}
+
 PointsList* PxrPointsLRUCache::put(const PxrPointsLRUCache::CompositeKey& key, PointsList&& points) {
-	std::lock_guard<std::mutex> lock(mMutex);
+	// spilled copy of this frame (if any) is stale now
+	if(mpSpillStore) {
+		mpSpillStore->remove(toSpillKey(key.deformer_id, {key.channel, key.time}));
+	}
+
+	return insert(key, std::move(points));
+}
+
+PointsList* PxrPointsLRUCache::insert(const PxrPointsLRUCache::CompositeKey& key, PointsList&& points) {
 	const size_t new_points_mem_reqs = points.sizeInBytes();
-	reduceMemUsage(mMaxMemSizeBytes - new_points_mem_reqs);
+	reduceMemUsage((mMaxMemSizeBytes > new_points_mem_reqs) ? (mMaxMemSizeBytes - new_points_mem_reqs) : 0);
+
+	std::shared_lock<std::shared_mutex> shards_lock(mShardsMutex);
+	Shard* pShard = findShard(key.deformer_id);
+
+	while(!pShard) {
+		// first entry of this deformer. shard might be removed again before we re-acquire shared lock, hence the loop
+		shards_lock.unlock();
+		{
+			std::unique_lock<std::shared_mutex> shards_write_lock(mShardsMutex);
+			auto& pNewShard = mShards[key.deformer_id];
+			if(!pNewShard) {
+				pNewShard = std::make_unique<Shard>();
+				pNewShard->id = key.deformer_id;
+			}
+		}
+		shards_lock.lock();
+		pShard = findShard(key.deformer_id);
+	}
+
+	std::lock_guard<std::mutex> lock(pShard->mutex);
 
-	auto it = mCacheItemsMap.find(key);
-	mCacheItemsList.push_front(key_value_pair_t(key, std::move(points)));
-	if (it != mCacheItemsMap.end()) {
-		mCacheItemsList.erase(it->second);
-		mCacheItemsMap.erase(it);
+	const ShardKey shard_key = {key.channel, key.time};
+	auto it = pShard->map.find(shard_key);
+	if(it != pShard->map.end()) {
+		eraseEntry(*pShard, it->second);
 	}
 
-	mCacheItemsMap[key] = mCacheItemsList.begin();
+	pShard->items.push_front(Entry{shard_key, nextTick(), new_points_mem_reqs, std::move(points)});
+	pShard->map[shard_key] = pShard->items.begin();
 
-	mCurrentMemSizeBytes = kInvalidUsedMemSize;
+	pShard->memSize += new_points_mem_reqs;
+	mCurrentMemSizeBytes += new_points_mem_reqs;
+	mItemsCount++;
 
-	return &mCacheItemsList.begin()->second;
+	return &pShard->items.begin()->points;
 }
 
-const PointsList* PxrPointsLRUCache::get(const PxrPointsLRUCache::CompositeKey& key) const {
-	std::lock_guard<std::mutex> lock(mMutex);
-	auto it = mCacheItemsMap.find(key);
-	if (it == mCacheItemsMap.end()) {
-		LOG_TRC << "There is no key (" << key.name << ") in PxrPointsLRUCache.";
-		return nullptr;
-	} else {
-		mCacheItemsList.splice(mCacheItemsList.begin(), mCacheItemsList, it->second);
-		return &it->second->second;
+const PointsList* PxrPointsLRUCache::get(const PxrPointsLRUCache::CompositeKey& key) {
+	{
+		std::shared_lock<std::shared_mutex> shards_lock(mShardsMutex);
+		if(const Shard* pShard = findShard(key.deformer_id)) {
+			std::lock_guard<std::mutex> lock(pShard->mutex);
+			auto it = pShard->map.find({key.channel, key.time});
+			if (it != pShard->map.end()) {
+				it->second->tick = nextTick();
+				pShard->items.splice(pShard->items.begin(), pShard->items, it->second);
+				return &it->second->points;
+			}
+		}
+	}
+
+	if(mpSpillStore) {
+		if(std::unique_ptr<PointsList> pSpilledPoints = mpSpillStore->load(toSpillKey(key.deformer_id, {key.channel, key.time}))) {
+			LOG_TRC << "Key (" << to_string(key) << ") restored from PxrPointsLRUCache spill store.";
+			return insert(key, std::move(*pSpilledPoints));
+		}
 	}
+
+	LOG_TRC << "There is no key (" << to_string(key) << ") in PxrPointsLRUCache.";
+	return nullptr;
+}
+
+bool PxrPointsLRUCache::exists(const CompositeKey& key) const {
+	std::shared_lock<std::shared_mutex> shards_lock(mShardsMutex);
+	const Shard* pShard = findShard(key.deformer_id);
+	if(!pShard) return false;
+
+	std::lock_guard<std::mutex> lock(pShard->mutex);
+	return pShard->map.find({key.channel, key.time}) != pShard->map.end();
 }
 
 void PxrPointsLRUCache::setMaxMemSize(size_t max_mem_size_bytes) {
@@ -80,35 +144,60 @@ void PxrPointsLRUCache::setMaxMemSize(size_t max_mem_size_bytes) {
 }
 
 void PxrPointsLRUCache::reduceMemUsage(const size_t mem_size_bytes) {
-	if(mShrinkLock) return;
-
-	while ((getMemSize() > mem_size_bytes) && (mCacheItemsList.size() > mMinEntries)) {
-		auto last = mCacheItemsList.end();
-		last--;
-		mCacheItemsMap.erase(last->first);
-		mCacheItemsList.pop_back();
-		mCurrentMemSizeBytes = kInvalidUsedMemSize;
+	if(mShrinkLock > 0) return;
+	if(getMemSize() <= mem_size_bytes) return;
+
+	std::lock_guard<std::mutex> eviction_lock(mEvictionMutex);
+	std::shared_lock<std::shared_mutex> shards_lock(mShardsMutex);
+
+	while ((getMemSize() > mem_size_bytes) && (size() > mMinEntries)) {
+		// globally least recently used entry is the oldest of shard lists tails
+		Shard* pVictimShard = nullptr;
+		uint64_t oldest_tick = std::numeric_limits<uint64_t>::max();
+
+		for(const auto& shard_pair: mShards) {
+			Shard* pShard = shard_pair.second.get();
+			std::lock_guard<std::mutex> lock(pShard->mutex);
+			if(!pShard->items.empty() && pShard->items.back().tick < oldest_tick) {
+				oldest_tick = pShard->items.back().tick;
+				pVictimShard = pShard;
+			}
+		}
+
+		if(!pVictimShard) break;
+
+		std::lock_guard<std::mutex> lock(pVictimShard->mutex);
+		if(!pVictimShard->items.empty()) {
+			auto last = std::prev(pVictimShard->items.end());
+			if(mpSpillStore) {
+				mpSpillStore->store(toSpillKey(pVictimShard->id, last->key), std::move(last->points));
+			}
+			eraseEntry(*pVictimShard, last);
+		}
 	}
 }
 
-size_t PxrPointsLRUCache::removeByName(const std::string& name) {
-	std::lock_guard<std::mutex> lock(mMutex);
+size_t PxrPointsLRUCache::removeByDeformer(DeformerID deformer_id) {
 	size_t removed_count = 0;
-	std::list<key_value_pair_t>::iterator it = mCacheItemsList.begin();
-
-	while(it != mCacheItemsList.end()) {
-		if(it->first.name == name) {
-			mCacheItemsMap.erase(it->first);
-			it = mCacheItemsList.erase(it);
-			mCurrentMemSizeBytes = kInvalidUsedMemSize;
-			removed_count++;
-		} else {
-			++it;
-		}
+	{
+		std::unique_lock<std::shared_mutex> shards_lock(mShardsMutex);
+		auto it = mShards.find(deformer_id);
+		if(it == mShards.end()) return 0;
+
+		const Shard& shard = *it->second;
+		removed_count = shard.items.size();
+		mCurrentMemSizeBytes -= shard.memSize;
+		mItemsCount -= removed_count;
+
+		mShards.erase(it);
+	}
+
+	if(mpSpillStore) {
+		mpSpillStore->removeByDeformer(deformer_id);
 	}
 
 	if(removed_count > 0) {
-		LOG_DBG << "PxrPointsLRUCache: " << removed_count << " items for key \"" << name << "\" removed from cache.";
+		LOG_DBG << "PxrPointsLRUCache: " << removed_count << " items for deformer id " << deformer_id << " removed from cache.";
 	}
 
 	return removed_count;
@@ -117,12 +206,16 @@ size_t PxrPointsLRUCache::removeByName(const std::string& name) {
 void PxrPointsLRUCache::clear() {
 	size_t old_items_count = 0;
 	{
-		std::lock_guard<std::mutex> lock(mMutex);
+		std::unique_lock<std::shared_mutex> shards_lock(mShardsMutex);
 		
-		old_items_count = mCacheItemsList.size();
-		mCacheItemsMap.clear();
-		mCacheItemsList.clear();
-		mCurrentMemSizeBytes = kInvalidUsedMemSize;
+		old_items_count = size();
+		mShards.clear();
+		mCurrentMemSizeBytes = 0;
+		mItemsCount = 0;
+	}
+
+	if(mpSpillStore) {
+		mpSpillStore->clear();
 	}
 	if(old_items_count != 0) {
 		LOG_DBG << "PxrPointsLRUCache: cleared.";
@@ -130,10 +223,10 @@ void PxrPointsLRUCache::clear() {
 }
 
 std::string PxrPointsLRUCache::getCacheUtilizationString() const {
-	static char _buffer[50];
+	char buffer[50];
 
-	sprintf(_buffer, "%.2f", getMemUsagePercent());
-    return std::string(_buffer);
+	snprintf(buffer, sizeof(buffer), "%.2f", getMemUsagePercent());
+	return std::string(buffer);
 }
 
 std::string PxrPointsLRUCache::getMemUsageString() const {
@@ -4,14 +4,17 @@
 #include "framework.h"
 #include "common.h"
 #include "points_list.h"
+#include "pxr_points_spill_store.h"
 
 #include <pxr/usd/usd/timeCode.h>
 #include <pxr/base/gf/matrix3f.h>
 
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <list>
+#include <memory>
 #include <string>
 
 
@@ -19,28 +22,28 @@ namespace Piston {
 
 class CPxrPointsLRUCacheShrinkLock;
 
+// Deformed points cache sharded by deformer. Each shard has its own lock and LRU list, so concurrently evaluated deformers
+// don't contend on lookups. Memory is accounted incrementally and eviction stays globally bounded: the globally least recently
+// used entry (oldest shard list tail) goes first. Optional spill store keeps evicted entries on disk and get() maps them back.
 class PxrPointsLRUCache {
 	public:
+		using DeformerID = uint32_t;
+
+		enum class Channel: uint8_t {
+			POINTS,
+			VELOCITIES
+		};
+
 		struct CompositeKey {
-			std::string name;
+			DeformerID deformer_id;
+			Channel channel;
 			pxr::UsdTimeCode time;
 
-			bool operator==(const CompositeKey &other) const { 
-				return (name == other.name && time == other.time);
+			bool operator==(const CompositeKey &other) const {
+				return (deformer_id == other.deformer_id && channel == other.channel && time == other.time);
 			}
-
-			struct Hasher {
-				size_t operator()(const CompositeKey& key) const {
-					size_t name_hash = std::hash<std::string>()(key.name);
-					size_t time_hash = hash_value(key.time) << 1;
-					return name_hash ^ time_hash;
-				}
-			};
 		};
 
-		typedef typename std::pair<CompositeKey, PointsList> key_value_pair_t;
-		typedef typename std::list<key_value_pair_t>::iterator list_iterator_t;
-
 		using UniquePtr = std::unique_ptr<PxrPointsLRUCache>;
 		static UniquePtr create(const size_t max_mem_size_bytes);
 
@@ -48,51 +51,102 @@ class PxrPointsLRUCache {
 
 		PointsList* put(const CompositeKey& key, size_t points_count, bool init_to_zero = false);
 		PointsList* put(const CompositeKey& key, PointsList&& points);
-		const PointsList* get(const CompositeKey& key) const;
+		// Looks up the spill store on miss. Spilled entry is moved back to memory
+		const PointsList* get(const CompositeKey& key);
 
-		bool exists(const CompositeKey& key) const {
-			return mCacheItemsMap.find(key) != mCacheItemsMap.end();
-		}
+		// Evicted entries are written to a scratch file in dir_path of budget_bytes size. Expected to be called right after create()
+		bool enableSpillStore(const std::string& dir_path, size_t budget_bytes);
+		bool hasSpillStore() const { return mpSpillStore != nullptr; }
+
+		bool exists(const CompositeKey& key) const;
 
-		size_t removeByName(const std::string& name);
+		// Removes all entries (all channels) of one deformer
+		size_t removeByDeformer(DeformerID deformer_id);
 
 		// Used memory ignoring keys and iterators mem usage. PointsList mem usage only
-		size_t getMemSize() const;
+		size_t getMemSize() const { return mCurrentMemSizeBytes.load(std::memory_order_relaxed); }
 
 		void setMaxMemSize(size_t max_mem_size_bytes);
 
-		size_t size() const { return mCacheItemsMap.size(); }
+		size_t size() const { return mItemsCount.load(std::memory_order_relaxed); }
 
 		inline float getMemUsagePercent() const { return 100.0f * (static_cast<float>(getMemSize()) / static_cast<float>(mMaxMemSizeBytes)); }
 		std::string getCacheUtilizationString() const;
 		std::string getMemUsageString() const;
 
-		size_t itemsCount() const { return mCacheItemsList.size(); }
+		size_t itemsCount() const { return size(); }
 
 		void clear();
 
 	private:
-		static constexpr size_t kInvalidUsedMemSize = std::numeric_limits<size_t>::max();
+		struct ShardKey {
+			Channel channel;
+			pxr::UsdTimeCode time;
+
+			bool operator==(const ShardKey &other) const { return (channel == other.channel && time == other.time); }
+
+			struct Hasher {
+				size_t operator()(const ShardKey& key) const {
+					return hash_value(key.time) ^ (static_cast<size_t>(key.channel) << 1);
+				}
+			};
+		};
+
+		struct Entry {
+			ShardKey   key;
+			uint64_t   tick;     // last access tick. Shard list is ordered by it, most recent first
+			size_t     bytes;    // points size at insertion
+			PointsList points;
+		};
 
+		using EntriesList = std::list<Entry>;
+
+		struct Shard {
+			DeformerID id;
+			mutable std::mutex mutex;
+			mutable EntriesList items;
+			std::unordered_map<ShardKey, EntriesList::iterator, ShardKey::Hasher> map;
+			size_t memSize = 0;
+		};
 
 		PxrPointsLRUCache(const size_t max_mem_size_bytes);
-	
+
 		void reduceMemUsage(const size_t mem_size_bytes);
 
+		PointsList* insert(const CompositeKey& key, PointsList&& points);
+
+		static PxrPointsSpillStore::Key toSpillKey(DeformerID deformer_id, const ShardKey& key) {
+			return {deformer_id, static_cast<uint8_t>(key.channel), key.time.GetValue()};
+		}
+
+		// Both expect mShardsMutex to be held
+		Shard* findShard(DeformerID deformer_id) const;
+		void eraseEntry(Shard& shard, EntriesList::iterator it);
+
+		uint64_t nextTick() const { return mTick.fetch_add(1, std::memory_order_relaxed) + 1; }
+
 	private:
-		mutable std::list<key_value_pair_t> mCacheItemsList;
-		std::unordered_map<CompositeKey, list_iterator_t, CompositeKey::Hasher> mCacheItemsMap;
-		
+		std::unordered_map<DeformerID, std::unique_ptr<Shard>> mShards;
+		mutable std::shared_mutex   mShardsMutex;   // shared for entries access, exclusive for shards creation/removal
+		std::mutex                  mEvictionMutex; // serializes evictions
+
 		size_t mMaxMemSizeBytes;
-		mutable size_t mCurrentMemSizeBytes;
+		std::atomic<size_t> mCurrentMemSizeBytes;
+		std::atomic<size_t> mItemsCount;
+		mutable std::atomic<uint64_t> mTick;
+
+		PxrPointsSpillStore::UniquePtr mpSpillStore;
 
 		size_t mMinEntries;
 
-		void shrink_lock() { mShrinkLock = true; }
-		void shrink_unlock() { mShrinkLock = false; reduceMemUsage(mMaxMemSizeBytes); }
+		// Shrink lock is counted as several deformers might be evaluated concurrently
+		void shrink_lock() { mShrinkLock++; }
+		void shrink_unlock() {
+			if(--mShrinkLock != 0) return;
+			reduceMemUsage(mMaxMemSizeBytes);
+		}
 
-		std::atomic<bool> mShrinkLock;
-		mutable std::mutex mMutex;
+		std::atomic<uint32_t> mShrinkLock;
 
 		friend class PxrPointsLRUCacheShrinkLock;
 };
@@ -123,9 +177,9 @@ private:
 };
 
 inline std::string to_string(const Piston::PxrPointsLRUCache::CompositeKey& key) {
-	return key.name + ":" + std::to_string(key.time.GetValue());
+	return std::to_string(key.deformer_id) + (key.channel == PxrPointsLRUCache::Channel::VELOCITIES ? "_vel" : "") + ":" + std::to_string(key.time.GetValue());
 }
 
 } // namespace Piston
 
-#endif // PISTON_LIB_PXR_POINTS_LRU_CACHE_H_
\ No newline at end of file
+#endif // PISTON_LIB_PXR_POINTS_LRU_CACHE_H_
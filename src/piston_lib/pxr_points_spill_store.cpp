@@ -0,0 +1,215 @@
+#include "pxr_points_spill_store.h"
+#include "common.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace Piston {
+
+PxrPointsSpillStore::UniquePtr PxrPointsSpillStore::create(const std::string& dir_path, size_t budget_bytes) {
+	MappedScratchFile::UniquePtr pFile = MappedScratchFile::create(dir_path, budget_bytes);
+	if(!pFile) {
+		LOG_ERR << "Unable to create points cache spill file in \"" << dir_path << "\" !";
+		return nullptr;
+	}
+
+	PxrPointsSpillStore::UniquePtr pStore = PxrPointsSpillStore::UniquePtr(new PxrPointsSpillStore());
+	pStore->mpFile = std::move(pFile);
+	pStore->mWriterThread = std::thread(&PxrPointsSpillStore::writerLoop, pStore.get());
+
+	LOG_INF << "PxrPointsSpillStore with " << std::string(stringifyMemSize(budget_bytes)) << " budget created in \"" << dir_path << "\".";
+	return pStore;
+}
+
+PxrPointsSpillStore::~PxrPointsSpillStore() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mQueueCondition.notify_all();
+
+	if(mWriterThread.joinable()) {
+		mWriterThread.join();
+	}
+}
+
+void PxrPointsSpillStore::store(const Key& key, PointsList&& points) {
+	if(points.sizeInBytes() == 0 || points.sizeInBytes() > getBudget()) return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// frame was read back from the spill file and evicted again unchanged
+	if(mPending.find(key) == mPending.end() && mRecords.find(key) != mRecords.end()) return;
+
+	// writer is behind. It's only a cache, so frame is dropped rather than piling up in RAM
+	const size_t bytes = points.sizeInBytes();
+	if((mQueuedBytes + bytes) > std::min(kMaxQueuedBytes, getBudget())) {
+		LOG_DBG << "PxrPointsSpillStore: write queue is full. Frame " << key.time << " is dropped.";
+		return;
+	}
+
+	auto pPoints = std::make_shared<PointsList>(std::move(points));
+	mPending[key] = pPoints;
+	mQueue.push_back({key, pPoints});
+	mQueuedBytes += bytes;
+	mQueueCondition.notify_one();
+}
+
+std::unique_ptr<PointsList> PxrPointsSpillStore::load(const Key& key) const {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto pending_it = mPending.find(key);
+	if(pending_it != mPending.end()) {
+		const PointsList& src = *pending_it->second;
+		auto pPoints = std::make_unique<PointsList>(src.size());
+		std::memcpy(pPoints->data(), src.data(), src.sizeInBytes());
+		return pPoints;
+	}
+
+	auto it = mRecords.find(key);
+	if(it == mRecords.end()) return nullptr;
+
+	const Record& record = it->second;
+	auto pPoints = std::make_unique<PointsList>(record.bytes / sizeof(PointsList::PointType));
+	std::memcpy(pPoints->data(), mpFile->data() + record.offset, record.bytes);
+	return pPoints;
+}
+
+bool PxrPointsSpillStore::contains(const Key& key) const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPending.find(key) != mPending.end() || mRecords.find(key) != mRecords.end();
+}
+
+void PxrPointsSpillStore::remove(const Key& key) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// queued writes of removed frames are skipped by the writer
+	mPending.erase(key);
+
+	auto it = mRecords.find(key);
+	if(it != mRecords.end()) {
+		mStoredBytes -= it->second.bytes;
+		mRecords.erase(it);
+	}
+}
+
+size_t PxrPointsSpillStore::removeByDeformer(uint32_t deformer_id) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	size_t removed_count = 0;
+
+	for(auto it = mPending.begin(); it != mPending.end();) {
+		if(it->first.deformer_id == deformer_id) {
+			it = mPending.erase(it);
+			removed_count++;
+		} else {
+			++it;
+		}
+	}
+
+	for(auto it = mRecords.begin(); it != mRecords.end();) {
+		if(it->first.deformer_id == deformer_id) {
+			mStoredBytes -= it->second.bytes;
+			it = mRecords.erase(it);
+			removed_count++;
+		} else {
+			++it;
+		}
+	}
+
+	return removed_count;
+}
+
+void PxrPointsSpillStore::clear() {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mPending.clear();
+	mQueue.clear();
+	mQueuedBytes = 0;
+	mRecords.clear();
+	mRing.clear();
+	mRingHead = 0;
+	mStoredBytes = 0;
+}
+
+void PxrPointsSpillStore::dropRingFront() {
+	const RingItem& item = mRing.front();
+
+	auto it = mRecords.find(item.key);
+	if(it != mRecords.end() && it->second.serial == item.serial) {
+		mStoredBytes -= it->second.bytes;
+		mRecords.erase(it);
+	}
+
+	mRing.pop_front();
+}
+
+size_t PxrPointsSpillStore::allocate(size_t bytes) {
+	assert(bytes <= mpFile->size());
+
+	if((mRingHead + bytes) > mpFile->size()) {
+		// skip the ring tail. records located there are the oldest ones
+		while(!mRing.empty() && mRing.front().offset >= mRingHead) {
+			dropRingFront();
+		}
+		mRingHead = 0;
+	}
+
+	while(!mRing.empty() && (mRing.front().offset < (mRingHead + bytes)) && ((mRing.front().offset + mRing.front().bytes) > mRingHead)) {
+		dropRingFront();
+	}
+
+	const size_t offset = mRingHead;
+	mRingHead += bytes;
+	return offset;
+}
+
+void PxrPointsSpillStore::writerLoop() {
+	while(true) {
+		PendingWrite job;
+		size_t offset = 0;
+		size_t bytes = 0;
+		uint64_t serial = 0;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mQueueCondition.wait(lock, [this] { return mStop || !mQueue.empty(); });
+			if(mStop) return;
+
+			job = std::move(mQueue.front());
+			mQueue.pop_front();
+			mQueuedBytes -= job.pPoints->sizeInBytes();
+
+			// removed or replaced while queued
+			auto it = mPending.find(job.key);
+			if(it == mPending.end() || it->second != job.pPoints) continue;
+
+			bytes = job.pPoints->sizeInBytes();
+			offset = allocate(bytes);
+			serial = ++mSerial;
+			mRing.push_back({job.key, offset, bytes, serial});
+		}
+
+		// Allocations only happen on this thread, so the reserved range can't be reused while we copy
+		std::memcpy(mpFile->data() + offset, job.pPoints->data(), bytes);
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			auto it = mPending.find(job.key);
+			if(it == mPending.end() || it->second != job.pPoints) continue; // removed while writing. space is reclaimed by the ring
+
+			mPending.erase(it);
+
+			auto record_it = mRecords.find(job.key);
+			if(record_it != mRecords.end()) {
+				mStoredBytes -= record_it->second.bytes;
+			}
+			mRecords[job.key] = {offset, bytes, serial};
+			mStoredBytes += bytes;
+		}
+	}
+}
+
+} // namespace Piston
@@ -0,0 +1,114 @@
+#ifndef PISTON_LIB_PXR_POINTS_SPILL_STORE_H_
+#define PISTON_LIB_PXR_POINTS_SPILL_STORE_H_
+
+#include "framework.h"
+#include "os.h"
+#include "points_list.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+
+namespace Piston {
+
+// Second tier of PxrPointsLRUCache. Evicted points lists are written to a memory mapped scratch file on a background thread
+// and can be read back later without re-running deformation. Scratch file is used as a ring buffer, so when the budget is
+// exhausted the oldest spilled frames are overwritten first.
+class PxrPointsSpillStore {
+	public:
+		using UniquePtr = std::unique_ptr<PxrPointsSpillStore>;
+
+		struct Key {
+			uint32_t deformer_id;
+			uint8_t  channel;
+			double   time;
+
+			bool operator==(const Key &other) const {
+				return (deformer_id == other.deformer_id && channel == other.channel && time == other.time);
+			}
+
+			struct Hasher {
+				size_t operator()(const Key& key) const {
+					return std::hash<double>()(key.time) ^ (static_cast<size_t>(key.deformer_id) << 8) ^ static_cast<size_t>(key.channel);
+				}
+			};
+		};
+
+		// Returns nullptr if scratch file can't be created
+		static UniquePtr create(const std::string& dir_path, size_t budget_bytes);
+
+		~PxrPointsSpillStore();
+
+		// Queues asynchronous write. Cheap if the same frame is already stored. Frame is dropped when the writer falls
+		// behind and queued frames already hold kMaxQueuedBytes (or the whole budget) of RAM
+		void store(const Key& key, PointsList&& points);
+
+		// Copies spilled (or still pending) points. Returns nullptr if the key isn't stored
+		std::unique_ptr<PointsList> load(const Key& key) const;
+
+		bool contains(const Key& key) const;
+
+		void remove(const Key& key);
+		size_t removeByDeformer(uint32_t deformer_id);
+		void clear();
+
+		size_t getBudget() const { return mpFile ? mpFile->size() : 0; }
+		size_t getMemSize() const { return mStoredBytes.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr size_t kMaxQueuedBytes = 256 * 1024 * 1024;
+
+		struct Record {
+			size_t   offset;
+			size_t   bytes;
+			uint64_t serial;  // ring item that owns this record
+		};
+
+		struct RingItem {
+			Key      key;
+			size_t   offset;
+			size_t   bytes;
+			uint64_t serial;
+		};
+
+		struct PendingWrite {
+			Key                         key;
+			std::shared_ptr<PointsList> pPoints;
+		};
+
+		PxrPointsSpillStore() = default;
+
+		void writerLoop();
+
+		// Allocates ring space for bytes dropping overlapped records. Expects mMutex to be held
+		size_t allocate(size_t bytes);
+		void dropRingFront();
+
+	private:
+		MappedScratchFile::UniquePtr                                mpFile;
+
+		std::unordered_map<Key, Record, Key::Hasher>                mRecords;
+		std::deque<RingItem>                                        mRing;     // ring allocations, oldest first
+		size_t                                                      mRingHead = 0;
+		uint64_t                                                    mSerial = 0;
+		std::atomic<size_t>                                         mStoredBytes{0};
+
+		std::unordered_map<Key, std::shared_ptr<PointsList>, Key::Hasher>  mPending; // queued, not yet written frames
+		std::deque<PendingWrite>                                    mQueue;
+		size_t                                                      mQueuedBytes = 0; // RAM held by mQueue frames
+
+		mutable std::mutex                                          mMutex;
+		std::condition_variable                                     mQueueCondition;
+		bool                                                        mStop = false;
+		std::thread                                                 mWriterThread;
+};
+
+} // namespace Piston
+
+#endif // PISTON_LIB_PXR_POINTS_SPILL_STORE_H_
@@ -13,6 +13,18 @@ bool SerializableDeformerDataBase::serialize(BSON& v_bson) const {
 		return false;
 	}
 
+	if(hasBinaryLayout()) {
+		const DataVersion& version = jsonDataVersion();
+		BinaryDataWriter writer(jsonDataKey(), static_cast<uint32_t>(version.major), static_cast<uint32_t>(version.minor), static_cast<uint32_t>(version.build));
+
+		const std::lock_guard<std::mutex> lock(mMutex);
+		if(!dumpToBinary(writer) || !writer.write(v_bson)) {
+			LOG_ERR << "Error serializing deformer data !";
+			return false;
+		}
+		return true;
+	}
+
 	json j = R"({"compact": true, "schema": 0})"_json;
 	j["data_name"] = jsonDataKey();
 	j["data_version_major"] = jsonDataVersion().major;
@@ -39,9 +51,52 @@ bool SerializableDeformerDataBase::serialize(BSON& v_bson) const {
 }
 
 bool SerializableDeformerDataBase::deserialize(const BSON& v_bson) {
-	if(v_bson.empty()) return false;
+	#if BSON_USES_PXR_VTARRAY
+		// VtArray copy shares the buffer, so it's a cheap owner for lazily decoded blocks
+		auto pBson = std::make_shared<const BSON>(v_bson);
+		return deserialize(reinterpret_cast<const uint8_t*>(pBson->cdata()), pBson->size(), pBson);
+	#else
+		return deserialize(reinterpret_cast<const uint8_t*>(v_bson.data()), v_bson.size());
+	#endif
+}
+
+bool SerializableDeformerDataBase::deserialize(const uint8_t* pData, size_t size, std::shared_ptr<const void> pOwner) {
+	if(!pData || size == 0) return false;
+
+	if(BinaryData::hasBinaryHeader(pData, size)) {
+		BinaryDataReader reader;
+		if(!reader.open(pData, size, std::move(pOwner))) return false;
+
+		clear();
+
+		if(reader.getDataName() != jsonDataKey()) {
+			LOG_ERR << "Error de-serializing deformer data ! Data key is different !";
+			return false;
+		}
+
+		const DataVersion& version = jsonDataVersion();
+		if(reader.getDataVersionMajor() != version.major || reader.getDataVersionMinor() != version.minor || reader.getDataVersionBuild() != version.build) {
+			LOG_ERR << "Error de-serializing deformer data ! Data version is different !";
+			return false;
+		}
+
+		bool result;
+		{
+			const std::lock_guard<std::mutex> lock(mMutex);
+			result = readFromBinary(reader);
+		}
+
+		if(!result) {
+			// drop partially read data, blocks waiting for lazy decode included
+			clear();
+			LOG_ERR << "Error de-serializing deformer data !";
+			return false;
+		}
+
+		return isValid();
+	}
 
-	json j = json::from_bson(v_bson);
+	json j = json::from_bson(pData, pData + size);
 	clear();
 
 	if(j["data_name"] != jsonDataKey()) {
@@ -3,6 +3,7 @@
 
 #include "framework.h"
 #include "common.h"
+#include "binary_data_container.h"
 
 #include <pxr/usd/usd/prim.h>
 
@@ -41,6 +42,9 @@ class SerializableDeformerDataBase: public std::enable_shared_from_this<Serializ
 
 		bool serialize(BSON& v_bson) const;
 		bool deserialize(const BSON& v_bson);
+		// Payload memory (e.g. memory mapped sidecar file) is only read during the call unless pOwner is given.
+		// Owner keeps the memory alive for chunked blocks decoded on first access.
+		bool deserialize(const uint8_t* pData, size_t size, std::shared_ptr<const void> pOwner = nullptr);
 		void clear();
 
 		virtual bool isValid() const = 0;
@@ -53,6 +57,12 @@ class SerializableDeformerDataBase: public std::enable_shared_from_this<Serializ
 		virtual bool readFromJSON(const json& j) = 0;
 		virtual void clearData() = 0;
 
+		// Binary columnar layout. Classes without it are serialized through json/bson. Both payload kinds are readable.
+		// Called with mMutex held, as writer references the data arrays until the payload is written.
+		virtual bool hasBinaryLayout() const { return false; }
+		virtual bool dumpToBinary(BinaryDataWriter& writer) const { return false; }
+		virtual bool readFromBinary(const BinaryDataReader& reader) { return false; }
+
 		mutable std::mutex mMutex;
 };
 
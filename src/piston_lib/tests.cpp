@@ -1,4 +1,5 @@
 #include "tests.h"
+#include "binary_data_container.h"
 
 
 #define RUN_TEST(func, result, verbose) \
@@ -71,6 +72,63 @@ static bool testPointPlaneDistance(bool verbose) {
 	return true;
 }
 
+static bool testBinaryDataRoundtrip(bool verbose) {
+	const std::vector<uint32_t> ids{0u, 7u, 42u, 0xFFFFFFFFu};
+	const std::vector<pxr::GfVec3f> vectors{sTestTriangle.begin(), sTestTriangle.end()};
+
+	BinaryDataWriter writer("test_data", 1u, 2u, 3u);
+	writer.addBlock("ids", ids);
+	writer.addBlock("vectors", vectors);
+	writer.addValue("hash", uint64_t(12345));
+	writer.addString("path", "/root/mesh");
+
+	std::vector<uint32_t> chunked(1000);
+	for(size_t i = 0; i < chunked.size(); ++i) chunked[i] = static_cast<uint32_t>(i * 3);
+	writer.addChunkedBlock("chunked", chunked, 64u);
+
+	BSON bson;
+	if(!writer.write(bson)) return false;
+
+	BinaryDataReader reader;
+	if(!reader.open(reinterpret_cast<const uint8_t*>(bson.data()), bson.size())) return false;
+	if(reader.getDataName() != "test_data" || reader.getDataVersionMinor() != 2u) return false;
+
+	std::vector<uint32_t> read_ids;
+	BinaryData::ConstSpan<pxr::GfVec3f> read_vectors;
+	uint64_t hash = 0;
+	std::string path;
+
+	if(!reader.readBlock("ids", read_ids) || read_ids != ids) return false;
+	if(!reader.getSpan("vectors", read_vectors) || read_vectors.size() != vectors.size() || read_vectors[1] != vectors[1]) return false;
+	if(!reader.readValue("hash", hash) || hash != 12345) return false;
+	if(!reader.readString("path", path) || path != "/root/mesh") return false;
+
+	// element size mismatch must be rejected
+	std::vector<uint64_t> wrong_type;
+	if(reader.readBlock("ids", wrong_type)) return false;
+
+	std::vector<uint32_t> read_chunked;
+	if(!reader.readBlock("chunked", read_chunked) || read_chunked != chunked) return false;
+
+	// sorted ids shrink well below raw size
+	std::vector<uint8_t> encoded;
+	if(!BinaryData::compressChunk(reinterpret_cast<const uint8_t*>(chunked.data()), sizeof(uint32_t), chunked.size(), encoded)) return false;
+	if(encoded.size() * 2 >= chunked.size() * sizeof(uint32_t)) return false;
+
+	// lazy decode keeps the payload alive through the owner
+	auto pOwner = std::make_shared<const BSON>(bson);
+	BinaryDataReader owned_reader;
+	if(!owned_reader.open(reinterpret_cast<const uint8_t*>(pOwner->data()), pOwner->size(), pOwner)) return false;
+
+	std::vector<uint32_t> lazy_chunked;
+	LazyChunkedBlock loader;
+	if(!loader.attach(owned_reader, "chunked", lazy_chunked) || !loader.isPending()) return false;
+	loader.ensureAll();
+	if(loader.isPending() || lazy_chunked != chunked) return false;
+
+	return true;
+}
+
 bool runTests(bool verbose) {
 	bool result = true;
 	
@@ -79,6 +137,7 @@ bool runTests(bool verbose) {
 	RUN_TEST(testRayTriangleIntersectNoDist, result, verbose);
 	RUN_TEST(testRayTriangleIntersectNoDistMiss, result, verbose);
 	RUN_TEST(testPointPlaneDistance, result, verbose);
+	RUN_TEST(testBinaryDataRoundtrip, result, verbose);
 
 	if(verbose && result) {
 		std::cout << "All test passed !" << std::endl;
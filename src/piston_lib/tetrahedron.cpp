@@ -1,139 +1,290 @@
 #include "tetrahedron.h"
 #include "phantom_trimesh.h"
 
+#include <algorithm>
+
 namespace Piston {
 
-template<typename VtxIndexType>
-TetrahedronKDTree<VtxIndexType>::TetrahedronKDTree(const std::vector<Tetrahedron<VtxIndexType>>& tets, const pxr::VtArray<pxr::GfVec3f>& points): mTetrahedrons(tets), mPoints(points) {
-    std::vector<TetraIndexType> node_tet_inidices;
-    node_tet_inidices.resize(mTetrahedrons.size());
-    mTetrahedronAABBs.resize(mTetrahedrons.size());
-    mTetrahedronCentroids.resize(mTetrahedrons.size());
-
-    for (auto tet_index = 0; tet_index < mTetrahedrons.size(); ++tet_index) {
-        const auto& tet = mTetrahedrons[tet_index];
-        mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[0]]);
-        mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[1]]);
-        mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[2]]);
-        mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[3]]);
-
-        mTetrahedronCentroids[tet_index] =  (mPoints[tet.indices[0]] + mPoints[tet.indices[1]] + mPoints[tet.indices[2]] + mPoints[tet.indices[3]]) * 0.25;
-        node_tet_inidices[tet_index] = static_cast<TetraIndexType>(tet_index);
-    }
-    mpRoot = build(std::move(node_tet_inidices), 0);
+static inline float halfSurfaceArea(const AABB& aabb) {
+    const pxr::GfVec3f d = aabb.max - aabb.min;
+    return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
 }
 
 template<typename VtxIndexType>
-typename TetrahedronKDTree<VtxIndexType>::KDNode* TetrahedronKDTree<VtxIndexType>::build(std::vector<TetraIndexType>&& tet_indices, int depth) {
-    if (tet_indices.empty()) return nullptr;
+TetrahedronBVH<VtxIndexType>::TetrahedronBVH(const std::vector<Tetrahedron<VtxIndexType>>& tets, const pxr::VtArray<pxr::GfVec3f>& points, ThreadPool* pThreadPool): mTetrahedrons(tets), mPoints(points) {
+    const uint32_t tets_count = static_cast<uint32_t>(mTetrahedrons.size());
+    if (tets_count == 0) return;
+
+    mTetIndices.resize(tets_count);
+    mTetrahedronAABBs.resize(tets_count);
+    mTetrahedronCentroids.resize(tets_count);
+
+    auto func = [&](const std::size_t start, const std::size_t end) {
+        for (size_t tet_index = start; tet_index < end; ++tet_index) {
+            const auto& tet = mTetrahedrons[tet_index];
+            mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[0]]);
+            mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[1]]);
+            mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[2]]);
+            mTetrahedronAABBs[tet_index].fit(mPoints[tet.indices[3]]);
 
-    KDNode* node = new KDNode();
-    for (auto tet_index : tet_indices) {
-        node->nodeBounds.fit(mTetrahedronAABBs[tet_index].min);
-        node->nodeBounds.fit(mTetrahedronAABBs[tet_index].max);
+            mTetrahedronCentroids[tet_index] = (mPoints[tet.indices[0]] + mPoints[tet.indices[1]] + mPoints[tet.indices[2]] + mPoints[tet.indices[3]]) * 0.25;
+            mTetIndices[tet_index] = static_cast<TetraIndexType>(tet_index);
+        }
+    };
+
+    if (pThreadPool) {
+        BS::multi_future<void> blocks = pThreadPool->submit_blocks(0u, tets_count, func);
+        blocks.wait();
+    } else {
+        func(0u, tets_count);
     }
 
-    if (tet_indices.size() <= MAX_LEAF_SIZE) {
-        node->tet_indices = std::move(tet_indices);
-        return node;
+    // Top of the tree is split serially. Subtrees below task size are built concurrently and spliced afterwards
+    uint32_t task_size = 0;
+    if (pThreadPool && tets_count > kMinBuildTaskSize * 2) {
+        task_size = std::max(kMinBuildTaskSize, static_cast<uint32_t>(tets_count / (pThreadPool->get_thread_count() * 4)));
     }
 
-    int axis = depth % 3;
-    std::sort(tet_indices.begin(), tet_indices.end(), [&, axis](const TetraIndexType i_a, const TetraIndexType i_b) {
-        const pxr::GfVec3f& ca = mTetrahedronCentroids[i_a];
-        const pxr::GfVec3f& cb = mTetrahedronCentroids[i_b];
-        return (axis == 0) ? (ca[0] < cb[0]) : ((axis == 1) ? (ca[1] < cb[1]) : (ca[2] < cb[2]));
-    });
+    mNodes.reserve(2 * (tets_count / kMaxLeafSize + 1));
+    mNodes.resize(1);
+    build(mNodes, 0, 0, tets_count, 0, task_size);
+
+    if (!mBuildTasks.empty()) {
+        std::vector<std::vector<Node>> tasks_nodes(mBuildTasks.size());
+
+        auto task_func = [&](const std::size_t start, const std::size_t end) {
+            for (size_t i = start; i < end; ++i) {
+                const BuildTask& task = mBuildTasks[i];
+                tasks_nodes[i].resize(1);
+                build(tasks_nodes[i], 0, task.start, task.end, task.depth, 0);
+            }
+        };
+
+        BS::multi_future<void> blocks = pThreadPool->submit_blocks(size_t(0), mBuildTasks.size(), task_func, mBuildTasks.size());
+        blocks.wait();
+
+        for (size_t i = 0; i < mBuildTasks.size(); ++i) {
+            const std::vector<Node>& task_nodes = tasks_nodes[i];
+            const uint32_t base = static_cast<uint32_t>(mNodes.size());
+
+            // task root takes the placeholder node. The rest is appended, so local child indices shift by (base - 1)
+            auto remap = [base](Node node) {
+                if (!node.isLeaf()) node.offset = base + node.offset - 1;
+                return node;
+            };
+
+            mNodes[mBuildTasks[i].node_index] = remap(task_nodes[0]);
+            for (size_t j = 1; j < task_nodes.size(); ++j) {
+                mNodes.push_back(remap(task_nodes[j]));
+            }
+        }
+    }
 
-    auto medianIdx = tet_indices[tet_indices.size() / 2];
-    const auto& centroid = mTetrahedronCentroids[medianIdx];
-    double splitVal = (axis == 0) ? centroid[0] : ((axis == 1) ? centroid[1] : centroid[2]);
-
-    std::vector<TetraIndexType> leftTets, rightTets;
-    for (auto tet_index : tet_indices) {
-        const auto& aabb = mTetrahedronAABBs[tet_index];
-        double tMin = (axis == 0) ? aabb.min[0] : ((axis == 1) ? aabb.min[1] : aabb.min[2]);
-        double tMax = (axis == 0) ? aabb.max[0] : ((axis == 1) ? aabb.max[1] : aabb.max[2]);
-        
-        if (tMin <= splitVal) leftTets.push_back(tet_index);
-        if (tMax >= splitVal) rightTets.push_back(tet_index);
+    mNodes.shrink_to_fit();
+
+    // only needed while building
+    mTetrahedronAABBs = {};
+    mTetrahedronCentroids = {};
+    mBuildTasks = {};
+}
+
+template<typename VtxIndexType>
+void TetrahedronBVH<VtxIndexType>::build(std::vector<Node>& nodes, uint32_t node_index, uint32_t start, uint32_t end, uint32_t depth, uint32_t task_size) {
+    Node node;
+    for (uint32_t i = start; i < end; ++i) {
+        const AABB& aabb = mTetrahedronAABBs[mTetIndices[i]];
+        node.bounds.fit(aabb.min);
+        node.bounds.fit(aabb.max);
+    }
+
+    const uint32_t count = end - start;
+
+    if (count > kMaxLeafSize && depth < kMaxDepth && task_size > 0 && count <= task_size) {
+        nodes[node_index] = node;
+        mBuildTasks.push_back({node_index, start, end, depth});
+        return;
     }
 
-    // Avoid infinite recursion if items cannot be split cleanly
-    if (leftTets.size() == tet_indices.size() || rightTets.size() == tet_indices.size()) {
-        node->tet_indices = tet_indices;
-        return node;
+    uint32_t mid = start;
+    if (count <= kMaxLeafSize || depth >= kMaxDepth || !findSplit(start, end, mid)) {
+        node.offset = start;
+        node.count = count;
+        nodes[node_index] = node;
+        return;
     }
 
-    node->left = build(std::move(leftTets), depth + 1);
-    node->right = build(std::move(rightTets), depth + 1);
-    return node;
+    // children are allocated as a pair. nodes may reallocate, so no references are kept across recursion
+    const uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes.resize(left + 2);
+
+    node.offset = left;
+    node.count = 0;
+    nodes[node_index] = node;
+
+    build(nodes, left, start, mid, depth + 1, task_size);
+    build(nodes, left + 1, mid, end, depth + 1, task_size);
 }
 
 template<typename VtxIndexType>
-void TetrahedronKDTree<VtxIndexType>::searchClosest(const KDNode* node, const pxr::GfVec3f& p, TetraIndexType& bestTetIndex, float& bestSqDist) const {
-    if (!node) return;
-
-    // Prune path if it cannot beat current best distance
-    if (node->nodeBounds.squareDist(p) >= bestSqDist) return;
-
-    if (node->isLeaf()) {
-        for (auto tet_index : node->tet_indices) {
-            float d = minSqDistToTetrahedron<VtxIndexType>(p, mTetrahedrons[tet_index], mPoints);
-            if (d < bestSqDist) {
-                bestSqDist = d;
-                bestTetIndex = tet_index;
+bool TetrahedronBVH<VtxIndexType>::findSplit(uint32_t start, uint32_t end, uint32_t& mid) {
+    AABB centroid_bounds;
+    for (uint32_t i = start; i < end; ++i) {
+        centroid_bounds.fit(mTetrahedronCentroids[mTetIndices[i]]);
+    }
+
+    float best_cost = std::numeric_limits<float>::max();
+    int best_axis = -1;
+    uint32_t best_bin = 0;
+
+    auto binIndex = [&](const pxr::GfVec3f& c, int axis, float k) {
+        return std::min(static_cast<uint32_t>((c[axis] - centroid_bounds.min[axis]) * k), kSAHBinsCount - 1);
+    };
+
+    for (int axis = 0; axis < 3; ++axis) {
+        const float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+        if (extent <= 0.f) continue;
+
+        const float k = static_cast<float>(kSAHBinsCount) / extent;
+
+        std::array<AABB, kSAHBinsCount> bins_bounds;
+        std::array<uint32_t, kSAHBinsCount> bins_counts{};
+
+        for (uint32_t i = start; i < end; ++i) {
+            const TetraIndexType tet_index = mTetIndices[i];
+            const uint32_t b = binIndex(mTetrahedronCentroids[tet_index], axis, k);
+            bins_counts[b]++;
+            bins_bounds[b].fit(mTetrahedronAABBs[tet_index].min);
+            bins_bounds[b].fit(mTetrahedronAABBs[tet_index].max);
+        }
+
+        // right side areas and counts for split after bin b
+        std::array<float, kSAHBinsCount> right_areas{};
+        std::array<uint32_t, kSAHBinsCount> right_counts{};
+        AABB right_bounds;
+        uint32_t right_count = 0;
+        for (uint32_t b = kSAHBinsCount - 1; b > 0; --b) {
+            if (bins_counts[b] > 0) {
+                right_bounds.fit(bins_bounds[b].min);
+                right_bounds.fit(bins_bounds[b].max);
+                right_count += bins_counts[b];
             }
+            right_areas[b - 1] = right_count > 0 ? halfSurfaceArea(right_bounds) : 0.f;
+            right_counts[b - 1] = right_count;
         }
-        return;
-    }
 
-    float dLeft = node->left ? node->left->nodeBounds.squareDist(p) : std::numeric_limits<float>::max();
-    float dRight = node->right ? node->right->nodeBounds.squareDist(p) : std::numeric_limits<float>::max();
+        AABB left_bounds;
+        uint32_t left_count = 0;
+        for (uint32_t b = 0; b < kSAHBinsCount - 1; ++b) {
+            if (bins_counts[b] > 0) {
+                left_bounds.fit(bins_bounds[b].min);
+                left_bounds.fit(bins_bounds[b].max);
+                left_count += bins_counts[b];
+            }
+            if (left_count == 0 || right_counts[b] == 0) continue;
 
-    if (dLeft < dRight) {
-        searchClosest(node->left, p, bestTetIndex, bestSqDist);
-        searchClosest(node->right, p, bestTetIndex, bestSqDist);
-    } else {
-        searchClosest(node->right, p, bestTetIndex, bestSqDist);
-        searchClosest(node->left, p, bestTetIndex, bestSqDist);
+            const float cost = halfSurfaceArea(left_bounds) * left_count + right_areas[b] * right_counts[b];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = b;
+            }
+        }
     }
+
+    if (best_axis < 0) return false; // all centroids coincide
+
+    const float k = static_cast<float>(kSAHBinsCount) / (centroid_bounds.max[best_axis] - centroid_bounds.min[best_axis]);
+    auto it = std::partition(mTetIndices.begin() + start, mTetIndices.begin() + end, [&](const TetraIndexType tet_index) {
+        return binIndex(mTetrahedronCentroids[tet_index], best_axis, k) <= best_bin;
+    });
+
+    mid = static_cast<uint32_t>(it - mTetIndices.begin());
+    return mid > start && mid < end;
 }
 
 template<typename VtxIndexType>
-typename TetrahedronKDTree<VtxIndexType>::TetraIndexType TetrahedronKDTree<VtxIndexType>::searchInside(const KDNode* node, const pxr::GfVec3f& p) const {
-    if (!node || node->nodeBounds.squareDist(p) > 1e-9) return kInvalidTetraID;
-
-    if (node->isLeaf()) {
-        for (auto tet_index : node->tet_indices) {
-            
-            if (isPointInTetrahedron<VtxIndexType>(p, mTetrahedrons[tet_index], mPoints)) {
-                return tet_index;
+typename TetrahedronBVH<VtxIndexType>::TetraIndexType TetrahedronBVH<VtxIndexType>::searchInside(const pxr::GfVec3f& p) const {
+    if (mNodes.empty()) return kInvalidTetraID;
+
+    std::array<uint32_t, kMaxDepth + 2> stack;
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const Node& node = mNodes[stack[--stack_size]];
+        if (node.bounds.squareDist(p) > 1e-9) continue;
+
+        if (node.isLeaf()) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                if (isPointInTetrahedron<VtxIndexType>(p, mTetrahedrons[mTetIndices[i]], mPoints)) {
+                    return mTetIndices[i];
+                }
             }
+            continue;
+        }
+
+        // Test closest bounding space child node first
+        const uint32_t left = node.offset;
+        const uint32_t right = node.offset + 1;
+        if (mNodes[left].bounds.squareDist(p) < mNodes[right].bounds.squareDist(p)) {
+            stack[stack_size++] = right;
+            stack[stack_size++] = left;
+        } else {
+            stack[stack_size++] = left;
+            stack[stack_size++] = right;
         }
-        return kInvalidTetraID;
     }
 
-    // Test closest bounding space child node first
-    float dLeft = node->left ? node->left->nodeBounds.squareDist(p) : std::numeric_limits<float>::max();
-    float dRight = node->right ? node->right->nodeBounds.squareDist(p) : std::numeric_limits<float>::max();
+    return kInvalidTetraID;
+}
 
-    if (dLeft < dRight) {
-        TetraIndexType found = searchInside(node->left, p);
-        if (found != kInvalidTetraID) return found;
-        return searchInside(node->right, p);
-    } else {
-        TetraIndexType found = searchInside(node->right, p);
-        if (found != kInvalidTetraID) return found;
-        return searchInside(node->left, p);
+template<typename VtxIndexType>
+void TetrahedronBVH<VtxIndexType>::searchClosest(const pxr::GfVec3f& p, TetraIndexType& bestTetIndex, float& bestSqDist) const {
+    if (mNodes.empty()) return;
+
+    std::array<std::pair<uint32_t, float>, kMaxDepth + 2> stack;
+    size_t stack_size = 0;
+    stack[stack_size++] = {0u, mNodes[0].bounds.squareDist(p)};
+
+    while (stack_size > 0) {
+        const auto [node_index, node_sq_dist] = stack[--stack_size];
+
+        // Prune path if it cannot beat current best distance
+        if (node_sq_dist >= bestSqDist) continue;
+
+        const Node& node = mNodes[node_index];
+        if (node.isLeaf()) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                const TetraIndexType tet_index = mTetIndices[i];
+                float d = minSqDistToTetrahedron<VtxIndexType>(p, mTetrahedrons[tet_index], mPoints);
+                if (d < bestSqDist) {
+                    bestSqDist = d;
+                    bestTetIndex = tet_index;
+                }
+            }
+            continue;
+        }
+
+        const uint32_t left = node.offset;
+        const uint32_t right = node.offset + 1;
+        const float dLeft = mNodes[left].bounds.squareDist(p);
+        const float dRight = mNodes[right].bounds.squareDist(p);
+
+        if (dLeft < dRight) {
+            stack[stack_size++] = {right, dRight};
+            stack[stack_size++] = {left, dLeft};
+        } else {
+            stack[stack_size++] = {left, dLeft};
+            stack[stack_size++] = {right, dRight};
+        }
     }
 }
 
 template<typename VtxIndexType>
-typename TetrahedronKDTree<VtxIndexType>::TetraIndexType TetrahedronKDTree<VtxIndexType>::queryPoint(const pxr::GfVec3f& p, bool& is_inside) const {
+typename TetrahedronBVH<VtxIndexType>::TetraIndexType TetrahedronBVH<VtxIndexType>::queryPoint(const pxr::GfVec3f& p, bool& is_inside) const {
     is_inside = false;
     // Pass 1: Try to look for strict volumetric containment
-    TetraIndexType containingTetIndex = searchInside(mpRoot, p);
+    TetraIndexType containingTetIndex = searchInside(p);
     if (containingTetIndex != kInvalidTetraID) {
         is_inside = true;
         return containingTetIndex;
@@ -141,12 +292,12 @@ typename TetrahedronKDTree<VtxIndexType>::TetraIndexType TetrahedronKDTree<VtxIn
     // Pass 2: Fallback to finding the element with closest geometric feature
     TetraIndexType closestTetIndex = kInvalidTetraID;
     float bestSqDist = std::numeric_limits<float>::max();
-    searchClosest(mpRoot, p, closestTetIndex, bestSqDist);
+    searchClosest(p, closestTetIndex, bestSqDist);
     return closestTetIndex;
 }
 
 template<typename VtxIndexType>
-typename TetrahedronKDTree<VtxIndexType>::TetraIndexType TetrahedronKDTree<VtxIndexType>::queryPointWithCache(const pxr::GfVec3f& p, TetraIndexType& cachedTetraIndex, bool& is_inside) const {
+typename TetrahedronBVH<VtxIndexType>::TetraIndexType TetrahedronBVH<VtxIndexType>::queryPointWithCache(const pxr::GfVec3f& p, TetraIndexType& cachedTetraIndex, bool& is_inside) const {
     is_inside = false;
     // Step 1: O(1) Check - Is the point still inside the previous tetrahedron?
     if ((cachedTetraIndex != kInvalidTetraID) && isPointInTetrahedron(p, mTetrahedrons[cachedTetraIndex], mPoints)) {
@@ -159,7 +310,7 @@ typename TetrahedronKDTree<VtxIndexType>::TetraIndexType TetrahedronKDTree<VtxIn
     // you can check the 4 neighboring tets here before traversing the tree).
 
     // Step 3: Fallback - Search the tree for strict containment
-    TetraIndexType containingTetIndex = searchInside(mpRoot, p);
+    TetraIndexType containingTetIndex = searchInside(p);
     if (containingTetIndex != kInvalidTetraID) {
         is_inside = true;
         cachedTetraIndex = containingTetIndex; // Update the cache for the next frame/step
@@ -169,13 +320,41 @@ typename TetrahedronKDTree<VtxIndexType>::TetraIndexType TetrahedronKDTree<VtxIn
     // Step 4: Fallback - Find the closest face if completely outside the mesh
     TetraIndexType closestTetIndex = kInvalidTetraID;
     float bestSqDist = std::numeric_limits<float>::max();
-    searchClosest(mpRoot, p, closestTetIndex, bestSqDist);
+    searchClosest(p, closestTetIndex, bestSqDist);
     
     cachedTetraIndex = closestTetIndex; // Update the cache with the closest element
     return closestTetIndex;
 }
 
+template<typename VtxIndexType>
+void TetrahedronBVH<VtxIndexType>::queryPoints(const std::vector<pxr::GfVec3f>& points, std::vector<TetraIndexType>& tetra_indices, std::vector<uint8_t>& inside_flags, ThreadPool* pThreadPool) const {
+    tetra_indices.assign(points.size(), kInvalidTetraID);
+    inside_flags.assign(points.size(), 0);
+    if (points.empty()) return;
+
+    std::vector<uint32_t> order;
+    buildMortonOrder(points, order);
+
+    auto func = [&](const std::size_t start, const std::size_t end) {
+        TetraIndexType cachedTetraIndex = kInvalidTetraID;
+        bool is_inside = false;
+
+        for (size_t i = start; i < end; ++i) {
+            const uint32_t query_index = order[i];
+            tetra_indices[query_index] = queryPointWithCache(points[query_index], cachedTetraIndex, is_inside);
+            inside_flags[query_index] = is_inside ? 1 : 0;
+        }
+    };
+
+    if (pThreadPool) {
+        BS::multi_future<void> blocks = pThreadPool->submit_blocks(size_t(0), order.size(), func);
+        blocks.wait();
+    } else {
+        func(0, order.size());
+    }
+}
+
 } // namespace Piston
 
 template class Piston::Tetrahedron<Piston::PhantomTrimesh::PxrIndexType>;
-template class Piston::TetrahedronKDTree<Piston::PhantomTrimesh::PxrIndexType>;
\ No newline at end of file
+template class Piston::TetrahedronBVH<Piston::PhantomTrimesh::PxrIndexType>;
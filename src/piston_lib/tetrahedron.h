@@ -4,6 +4,7 @@
 #include "framework.h"
 #include "common.h"
 #include "geometry_tools.h"
+#include "thread_pool.h"
 #include "logging.h"
 
 #include <pxr/usd/usdGeom/mesh.h>
@@ -94,44 +95,64 @@ inline bool isPointInTetrahedron(const pxr::GfVec3f& p, const Tetrahedron<VtxInd
     return !(has_neg && has_pos);
 }
 
+// Flattened bounding volume hierarchy over tetrahedrons built with binned SAH splits. Children of an inner node
+// are stored next to each other, leaf tetrahedron indices live in one shared index buffer.
 template<typename VtxIndexType>
-class TetrahedronKDTree {
+class TetrahedronBVH {
 public:
     using TetraIndexType = uint32_t;
     static constexpr TetraIndexType kInvalidTetraID = std::numeric_limits<TetraIndexType>::max();
 
-	struct KDNode {
-	    AABB nodeBounds;
-	    KDNode* left = nullptr;
-	    KDNode* right = nullptr;
-	    std::vector<TetraIndexType> tet_indices; 
-	    bool isLeaf() const { return left == nullptr && right == nullptr; }
-	};
+    struct Node {
+        AABB     bounds;
+        uint32_t offset = 0; // first tetra index for leaves, left child node index for inner nodes. Right child is offset + 1
+        uint32_t count = 0;  // tetrahedrons count. 0 for inner nodes
+
+        bool isLeaf() const { return count > 0; }
+    };
 
 public:
-	TetrahedronKDTree(const std::vector<Tetrahedron<VtxIndexType>>& tets, const pxr::VtArray<pxr::GfVec3f>& points);
+    TetrahedronBVH(const std::vector<Tetrahedron<VtxIndexType>>& tets, const pxr::VtArray<pxr::GfVec3f>& points, ThreadPool* pThreadPool = nullptr);
 
     TetraIndexType queryPoint(const pxr::GfVec3f& p, bool& is_inside) const;
     TetraIndexType queryPointWithCache(const pxr::GfVec3f& p, TetraIndexType& cachedTetraIndex, bool& is_inside) const;
 
-    const KDNode* getRootNode() const { return mpRoot; }
- 
+    // Batch point location. Queries are processed in morton order so consecutive lookups mostly hit the cached tetrahedron
+    void queryPoints(const std::vector<pxr::GfVec3f>& points, std::vector<TetraIndexType>& tetra_indices, std::vector<uint8_t>& inside_flags, ThreadPool* pThreadPool = nullptr) const;
+
+    const std::vector<Node>& getNodes() const { return mNodes; }
+    bool empty() const { return mNodes.empty(); }
+
 private:
-    KDNode* build(std::vector<TetraIndexType>&& tet_indices, int depth);
+    void build(std::vector<Node>& nodes, uint32_t node_index, uint32_t start, uint32_t end, uint32_t depth, uint32_t task_size);
+    bool findSplit(uint32_t start, uint32_t end, uint32_t& mid);
 
-    TetraIndexType searchInside(const KDNode* node, const pxr::GfVec3f& p) const;
-    void searchClosest(const KDNode* node, const pxr::GfVec3f& p, TetraIndexType& bestTetIndex, float& bestSqDist) const;
+    TetraIndexType searchInside(const pxr::GfVec3f& p) const;
+    void searchClosest(const pxr::GfVec3f& p, TetraIndexType& bestTetIndex, float& bestSqDist) const;
 
 private:
-    const int MAX_LEAF_SIZE = 4;
+    static constexpr uint32_t kMaxLeafSize = 4;
+    static constexpr uint32_t kMaxDepth = 48; // keeps traversal stacks fixed size
+    static constexpr uint32_t kSAHBinsCount = 12;
+    static constexpr uint32_t kMinBuildTaskSize = 1024;
+
+    struct BuildTask {
+        uint32_t node_index;
+        uint32_t start;
+        uint32_t end;
+        uint32_t depth;
+    };
 
-	const std::vector<Tetrahedron<VtxIndexType>>& mTetrahedrons;
+    const std::vector<Tetrahedron<VtxIndexType>>& mTetrahedrons;
     const pxr::VtArray<pxr::GfVec3f>& mPoints;
 
-    std::vector<AABB> mTetrahedronAABBs;
-    std::vector<pxr::GfVec3f> mTetrahedronCentroids;
-   
-    KDNode* mpRoot = nullptr;
+    std::vector<Node>               mNodes;
+    std::vector<TetraIndexType>     mTetIndices;
+
+    // build time only
+    std::vector<AABB>               mTetrahedronAABBs;
+    std::vector<pxr::GfVec3f>       mTetrahedronCentroids;
+    std::vector<BuildTask>          mBuildTasks;
 };
 
 template<typename VtxIndexType>
@@ -0,0 +1,45 @@
+#include "thread_pool.h"
+#include "global_config.h"
+#include "logging.h"
+
+#include <algorithm>
+
+
+namespace Piston {
+
+ThreadPool& SharedThreadPool::getInstance() {
+	ThreadPool* pInstance = mInstancePtr.load(std::memory_order_acquire);
+	if (pInstance == nullptr) {
+		const size_t threads_count = GlobalConfig::getInstance().getThreadsCount();
+		std::lock_guard<std::mutex> lock(mMutex);
+		pInstance = mInstancePtr.load(std::memory_order_relaxed);
+		if (pInstance == nullptr) {
+			pInstance = new ThreadPool(threads_count);
+			mInstancePtr.store(pInstance, std::memory_order_release);
+			LOG_INF << "Shared thread pool started with " << pInstance->get_thread_count() << " threads";
+		}
+	}
+
+	return *pInstance;
+}
+
+void SharedThreadPool::setThreadsCount(size_t threads_count) {
+	threads_count = std::max(size_t(1), threads_count);
+
+	ThreadPool& pool = getInstance();
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	if(pool.get_thread_count() == threads_count) return;
+	pool.reset(threads_count);
+	LOG_INF << "Shared thread pool restarted with " << pool.get_thread_count() << " threads";
+}
+
+size_t SharedThreadPool::getThreadsCount() {
+	return getInstance().get_thread_count();
+}
+
+} // namespace Piston
+
+// Initialize static members
+std::atomic<Piston::ThreadPool*> Piston::SharedThreadPool::mInstancePtr{nullptr};
+std::mutex Piston::SharedThreadPool::mMutex;
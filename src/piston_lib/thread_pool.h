@@ -0,0 +1,50 @@
+#ifndef PISTON_LIB_THREAD_POOL_H_
+#define PISTON_LIB_THREAD_POOL_H_
+
+#include "BS_thread_pool.hpp" // BS::multi_future, BS::thread_pool
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace Piston {
+
+using ThreadPool = BS::thread_pool<BS::tp::none>;
+
+/*
+ * Process wide thread pool singleton. All deformers share the same pool so the total amount
+ * of worker threads stays bounded by GlobalConfig::getThreadsCount() no matter how many deformers exist.
+ *
+ * NOTE: Tasks submitted to this pool must never block on other tasks of the same pool.
+ */
+class SharedThreadPool {
+	public:
+		// Deleting the copy constructor to prevent copies
+		SharedThreadPool(const SharedThreadPool& obj) = delete;
+
+		// Static method to get the shared pool instance
+		static ThreadPool& getInstance();
+
+		// Waits for all running tasks and recreates worker threads.
+		static void setThreadsCount(size_t threads_count);
+		static size_t getThreadsCount();
+
+		// True when called from a worker of the shared pool. Such callers run nested work inline instead of waiting on the pool.
+		static bool isWorkerThread() {
+			ThreadPool* pInstance = mInstancePtr.load(std::memory_order_acquire);
+			return pInstance && BS::this_thread::get_pool() == static_cast<void*>(pInstance);
+		}
+
+	private:
+		SharedThreadPool() = default;
+
+		// Mutex to ensure thread safety
+		static std::mutex mMutex;
+
+		// Static pointer to the ThreadPool instance. Published with release store so lock free readers see a fully constructed pool
+		static std::atomic<ThreadPool*> mInstancePtr;
+};
+
+} // namespace Piston
+
+#endif // PISTON_LIB_THREAD_POOL_H_
@@ -0,0 +1,209 @@
+#include "trimesh_bvh.h"
+#include "phantom_trimesh.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace Piston {
+
+TrimeshBVH::UniquePtr TrimeshBVH::create(const PhantomTrimesh* pTrimesh, const pxr::VtArray<pxr::GfVec3f>& positions, ThreadPool* pThreadPool) {
+	assert(pTrimesh);
+
+	return createImpl(pTrimesh->getFaceCount(), positions, pThreadPool, [pTrimesh](const uint32_t face_id) -> const TriangleIndices& {
+		return pTrimesh->getFace(face_id).getIndices();
+	});
+}
+
+TrimeshBVH::UniquePtr TrimeshBVH::create(const std::vector<TriangleIndices>& triangles, const pxr::VtArray<pxr::GfVec3f>& positions, ThreadPool* pThreadPool) {
+	return createImpl(static_cast<uint32_t>(triangles.size()), positions, pThreadPool, [&triangles](const uint32_t face_id) -> const TriangleIndices& {
+		return triangles[face_id];
+	});
+}
+
+template<typename F>
+TrimeshBVH::UniquePtr TrimeshBVH::createImpl(uint32_t faces_count, const pxr::VtArray<pxr::GfVec3f>& positions, ThreadPool* pThreadPool, F&& getFaceIndices) {
+	TrimeshBVH::UniquePtr pBVH = TrimeshBVH::UniquePtr(new TrimeshBVH());
+
+	if(faces_count == 0) {
+		return pBVH;
+	}
+
+	pBVH->mFaceIndices.resize(faces_count);
+	pBVH->mFaceBounds.resize(faces_count);
+	pBVH->mFaceCentroids.resize(faces_count);
+
+	static constexpr float kF = 1.f / 3.f;
+
+	auto func = [&](const size_t start, const size_t end) {
+		for(size_t face_id = start; face_id < end; ++face_id) {
+			const TriangleIndices& indices = getFaceIndices(static_cast<uint32_t>(face_id));
+			const pxr::GfVec3f& p0 = positions[indices[0]];
+			const pxr::GfVec3f& p1 = positions[indices[1]];
+			const pxr::GfVec3f& p2 = positions[indices[2]];
+
+			AABB& bounds = pBVH->mFaceBounds[face_id];
+			bounds.fit(p0);
+			bounds.fit(p1);
+			bounds.fit(p2);
+
+			pBVH->mFaceCentroids[face_id] = (p0 + p1 + p2) * kF;
+			pBVH->mFaceIndices[face_id] = static_cast<uint32_t>(face_id);
+		}
+	};
+
+	if(pThreadPool) {
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(0u, faces_count, func);
+		blocks.wait();
+	} else {
+		func(0u, faces_count);
+	}
+
+	pBVH->mNodes.reserve(2 * (faces_count / kMaxLeafSize + 1));
+	pBVH->build(0, faces_count);
+
+	// store triangles in leaf order so queries read them sequentially
+	pBVH->mTriangles.resize(faces_count);
+
+	auto copy_func = [&](const size_t start, const size_t end) {
+		for(size_t i = start; i < end; ++i) {
+			const TriangleIndices& indices = getFaceIndices(pBVH->mFaceIndices[i]);
+			pBVH->mTriangles[i] = {positions[indices[0]], positions[indices[1]], positions[indices[2]]};
+		}
+	};
+
+	if(pThreadPool) {
+		BS::multi_future<void> blocks = pThreadPool->submit_blocks(0u, faces_count, copy_func);
+		blocks.wait();
+	} else {
+		copy_func(0u, faces_count);
+	}
+
+	pBVH->mFaceBounds = std::vector<AABB>();
+	pBVH->mFaceCentroids = std::vector<pxr::GfVec3f>();
+
+	LOG_DBG << "TrimeshBVH built for " << faces_count << " faces. " << pBVH->mNodes.size() << " nodes.";
+	return pBVH;
+}
+
+uint32_t TrimeshBVH::findClosestFace(const pxr::GfVec3f& p, float& sq_dist, float max_dist) const {
+	uint32_t closest_slot = kInvalidFaceID;
+	sq_dist = std::numeric_limits<float>::max();
+
+	visitNearestSlots(p, max_dist, [&](const uint32_t slot) {
+		const auto& tri = mTriangles[slot];
+		const float d = pointTriangleDistSquared(p, tri[0], tri[1], tri[2]);
+		if(d < sq_dist) {
+			sq_dist = d;
+			closest_slot = slot;
+			max_dist = std::sqrt(d);
+		}
+	});
+
+	return (closest_slot == kInvalidFaceID) ? kInvalidFaceID : mFaceIndices[closest_slot];
+}
+
+static inline bool rayHitsBounds(const AABB& bounds, const pxr::GfVec3f& orig, const pxr::GfVec3f& inv_dir, float t_max) {
+	float t_near = 0.f;
+	float t_far = t_max;
+	for(int i = 0; i < 3; ++i) {
+		float t0 = (bounds.min[i] - orig[i]) * inv_dir[i];
+		float t1 = (bounds.max[i] - orig[i]) * inv_dir[i];
+		if(t0 > t1) std::swap(t0, t1);
+		// NaN (zero direction component on the slab plane) never shrinks the interval
+		if(t0 > t_near) t_near = t0;
+		if(t1 < t_far) t_far = t1;
+		if(t_near > t_far) return false;
+	}
+	return true;
+}
+
+bool TrimeshBVH::intersectRay(const pxr::GfVec3f& orig, const pxr::GfVec3f& dir, float t_max, uint32_t& face_id, float& u, float& v, float& t) const {
+	if(mNodes.empty()) return false;
+
+	const float dir_length = dir.GetLength();
+	if(dir_length <= std::numeric_limits<float>::epsilon()) return false;
+
+	const pxr::GfVec3f inv_dir = {1.f / dir[0], 1.f / dir[1], 1.f / dir[2]};
+
+	uint32_t hit_slot = kInvalidFaceID;
+	float best_t = t_max;
+
+	std::array<uint32_t, 64> stack;
+	size_t stack_size = 0;
+	stack[stack_size++] = 0u;
+
+	while(stack_size > 0) {
+		const uint32_t node_index = stack[--stack_size];
+		const Node& node = mNodes[node_index];
+		if(!rayHitsBounds(node.bounds, orig, inv_dir, best_t)) continue;
+
+		if(!node.isLeaf()) {
+			stack[stack_size++] = node.offset;
+			stack[stack_size++] = node_index + 1;
+			continue;
+		}
+
+		for(uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+			const auto& tri = mTriangles[i];
+
+			// rayTriangleIntersect() doesn't reject parallel rays
+			const pxr::GfVec3f n = pxr::GfCross(tri[1] - tri[0], tri[2] - tri[0]);
+			if(std::fabs(pxr::GfDot(n, dir)) <= std::numeric_limits<float>::epsilon() * n.GetLength() * dir_length) continue;
+
+			float hit_t, hit_u, hit_v;
+			if(!rayTriangleIntersect(orig, dir, tri[0], tri[1], tri[2], hit_t, hit_u, hit_v)) continue;
+			if(hit_t < 0.f || hit_t > best_t) continue;
+
+			best_t = hit_t;
+			hit_slot = i;
+			u = hit_u;
+			v = hit_v;
+		}
+	}
+
+	if(hit_slot == kInvalidFaceID) return false;
+
+	face_id = mFaceIndices[hit_slot];
+	t = best_t;
+	return true;
+}
+
+uint32_t TrimeshBVH::build(uint32_t start, uint32_t end) {
+	const uint32_t node_index = static_cast<uint32_t>(mNodes.size());
+	mNodes.emplace_back();
+
+	AABB bounds;
+	AABB centroid_bounds;
+	for(uint32_t i = start; i < end; ++i) {
+		bounds.fit(mFaceBounds[mFaceIndices[i]].min);
+		bounds.fit(mFaceBounds[mFaceIndices[i]].max);
+		centroid_bounds.fit(mFaceCentroids[mFaceIndices[i]]);
+	}
+	mNodes[node_index].bounds = bounds;
+
+	if((end - start) <= kMaxLeafSize) {
+		mNodes[node_index].offset = start;
+		mNodes[node_index].count = end - start;
+		return node_index;
+	}
+
+	// median split along the longest centroids axis
+	const pxr::GfVec3f extent = centroid_bounds.max - centroid_bounds.min;
+	const int axis = (extent[0] > extent[1] && extent[0] > extent[2]) ? 0 : ((extent[1] > extent[2]) ? 1 : 2);
+
+	const uint32_t mid = start + (end - start) / 2;
+	std::nth_element(mFaceIndices.begin() + start, mFaceIndices.begin() + mid, mFaceIndices.begin() + end, [&](const uint32_t a, const uint32_t b) {
+		return mFaceCentroids[a][axis] < mFaceCentroids[b][axis];
+	});
+
+	build(start, mid);
+	const uint32_t right = build(mid, end);
+
+	mNodes[node_index].offset = right;
+	mNodes[node_index].count = 0;
+	return node_index;
+}
+
+} // namespace Piston
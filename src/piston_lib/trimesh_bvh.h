@@ -0,0 +1,128 @@
+#ifndef PISTON_LIB_TRIMESH_BVH_H_
+#define PISTON_LIB_TRIMESH_BVH_H_
+
+#include "framework.h"
+#include "geometry_tools.h"
+#include "phantom_trimesh.h"
+#include "thread_pool.h"
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+
+namespace Piston {
+
+// Flattened bounding volume hierarchy over PhantomTrimesh faces or arbitrary triangles list (rest triangles).
+// Nodes are stored depth first, so left child of an inner node always follows its parent.
+class TrimeshBVH {
+	public:
+		using UniquePtr = std::unique_ptr<TrimeshBVH>;
+		using TriangleIndices = PhantomTrimesh::TriFace::IndicesList;
+
+		static constexpr uint32_t kInvalidFaceID = std::numeric_limits<uint32_t>::max();
+
+		struct Node {
+			AABB     bounds;
+			uint32_t offset = 0; // first face index for leaves, right child node index for inner nodes
+			uint32_t count = 0;  // faces count. 0 for inner nodes
+
+			bool isLeaf() const { return count > 0; }
+		};
+
+		static UniquePtr create(const PhantomTrimesh* pTrimesh, const pxr::VtArray<pxr::GfVec3f>& positions, ThreadPool* pThreadPool = nullptr);
+		// Face ids reported by queries are indices into triangles list
+		static UniquePtr create(const std::vector<TriangleIndices>& triangles, const pxr::VtArray<pxr::GfVec3f>& positions, ThreadPool* pThreadPool = nullptr);
+
+		// Calls func(face_id) for faces which bounds are within max_dist from p. Nearest nodes are visited first.
+		// func may shrink max_dist to prune remaining search
+		template<typename F>
+		void visitNearest(const pxr::GfVec3f& p, float& max_dist, F&& func) const;
+
+		// Returns closest face id within max_dist from p or kInvalidFaceID. sq_dist receives squared distance to that face
+		uint32_t findClosestFace(const pxr::GfVec3f& p, float& sq_dist, float max_dist = std::numeric_limits<float>::max()) const;
+
+		// Nearest ray/face intersection with t in [0, t_max] range. t is measured in dir units, same as rayTriangleIntersect()
+		bool intersectRay(const pxr::GfVec3f& orig, const pxr::GfVec3f& dir, float t_max, uint32_t& face_id, float& u, float& v, float& t) const;
+
+		size_t getFaceCount() const { return mFaceIndices.size(); }
+		const std::vector<Node>& getNodes() const { return mNodes; }
+
+	private:
+		TrimeshBVH() = default;
+
+		template<typename F>
+		static UniquePtr createImpl(uint32_t faces_count, const pxr::VtArray<pxr::GfVec3f>& positions, ThreadPool* pThreadPool, F&& getFaceIndices);
+
+		uint32_t build(uint32_t start, uint32_t end);
+
+		// Same as visitNearest but calls func(slot) with leaf ordered slot index into mFaceIndices and mTriangles
+		template<typename F>
+		void visitNearestSlots(const pxr::GfVec3f& p, float& max_dist, F&& func) const;
+
+	private:
+		static constexpr uint32_t kMaxLeafSize = 4;
+
+		std::vector<Node>                           mNodes;
+		std::vector<uint32_t>                       mFaceIndices;
+		std::vector<std::array<pxr::GfVec3f, 3>>    mTriangles;      // rest triangles in mFaceIndices (leaf) order
+
+		// build time only
+		std::vector<AABB>                           mFaceBounds;
+		std::vector<pxr::GfVec3f>                   mFaceCentroids;
+};
+
+template<typename F>
+void TrimeshBVH::visitNearest(const pxr::GfVec3f& p, float& max_dist, F&& func) const {
+	visitNearestSlots(p, max_dist, [&](const uint32_t slot) {
+		func(mFaceIndices[slot]);
+	});
+}
+
+template<typename F>
+void TrimeshBVH::visitNearestSlots(const pxr::GfVec3f& p, float& max_dist, F&& func) const {
+	if(mNodes.empty()) return;
+
+	auto outOfReach = [&](const float sq_dist) {
+		return max_dist < std::numeric_limits<float>::max() && sq_dist > max_dist * max_dist;
+	};
+
+	std::array<std::pair<uint32_t, float>, 64> stack;
+	size_t stack_size = 0;
+	stack[stack_size++] = {0u, mNodes[0].bounds.squareDist(p)};
+
+	while(stack_size > 0) {
+		const auto [node_index, node_sq_dist] = stack[--stack_size];
+		if(outOfReach(node_sq_dist)) continue;
+
+		const Node& node = mNodes[node_index];
+		if(node.isLeaf()) {
+			for(uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+				func(i);
+			}
+			continue;
+		}
+
+		const uint32_t left = node_index + 1;
+		const uint32_t right = node.offset;
+		const float left_sq_dist = mNodes[left].bounds.squareDist(p);
+		const float right_sq_dist = mNodes[right].bounds.squareDist(p);
+
+		// push farther child first so nearer one is visited first
+		if(left_sq_dist < right_sq_dist) {
+			stack[stack_size++] = {right, right_sq_dist};
+			stack[stack_size++] = {left, left_sq_dist};
+		} else {
+			stack[stack_size++] = {left, left_sq_dist};
+			stack[stack_size++] = {right, right_sq_dist};
+		}
+	}
+}
+
+} // namespace Piston
+
+#endif // PISTON_LIB_TRIMESH_BVH_H_
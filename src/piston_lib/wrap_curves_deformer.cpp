@@ -3,8 +3,8 @@
 
 #include "common.h"
 #include "logging.h"
-#include "kdtree.hpp"
 #include "geometry_tools.h"
+#include "trimesh_bvh.h"
 
 #include <pxr/base/gf/matrix4f.h>
 
@@ -19,6 +19,8 @@ namespace Piston {
 
 static constexpr float kEpsilon = std::numeric_limits<float>::epsilon();
 static constexpr float kMaxFloat = std::numeric_limits<float>::max();
+static constexpr float kBVHSearchRelMargin = 1e-4f;
+static constexpr float kBVHSearchAbsMargin = 1e-5f;
 
 WrapCurvesDeformer::WrapCurvesDeformer(const std::string& name): BaseMeshCurvesDeformer(BaseCurvesDeformer::Type::WRAP, name) {
 	mBindMode = BindMode::DIST;
@@ -40,17 +42,17 @@ void WrapCurvesDeformer::invalidateData(DeformerDataCache& cache) {
 }
 
 
-bool WrapCurvesDeformer::deformImpl(PointsList& points, pxr::UsdTimeCode time_code) {
+bool WrapCurvesDeformer::deformImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) {
 	PROFILE("WrapCurvesDeformer::deformImpl");
-	return __deform__(points, false, time_code);
+	return __deform__(static_cast<EvalContext&>(ctx), points, false, time_code);
 }
 
-bool WrapCurvesDeformer::deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) {
+bool WrapCurvesDeformer::deformMtImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) {
 	PROFILE("WrapCurvesDeformer::deformMtImpl");
-	return __deform__(points, true, time_code);
+	return __deform__(static_cast<EvalContext&>(ctx), points, true, time_code);
 }
 
-bool WrapCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code) {
+bool WrapCurvesDeformer::__deform__(EvalContext& ctx, PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code) {
 	assert(mpPhantomTrimeshData);
 	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
 
@@ -60,17 +62,17 @@ bool WrapCurvesDeformer::__deform__(PointsList& points, bool multi_threaded, pxr
 
 	assert(points.size() == mpWrapCurvesDeformerData->getPointBinds().size());
 	assert(mpAdjacencyData);
-	assert(mpDeformerMeshContainer);
+	assert(ctx.pDeformerMeshContainer);
 
-	buildVertexNormals(mpAdjacencyData->getAdjacency(), pPhantomTrimesh, mLiveVertexNormals, mpDeformerMeshContainer->getLivePositions(), (multi_threaded ? &mPool : nullptr));
+	buildVertexNormals(mpAdjacencyData->getAdjacency(), pPhantomTrimesh, ctx.liveVertexNormals, ctx.pDeformerMeshContainer->getLivePositions(), (multi_threaded ? &mPool : nullptr));
 
 	bool result = false;
 	switch(mpWrapCurvesDeformerData->getBindMode()) {
 		case BindMode::SPACE:
-			result = deformImpl_SpaceMode(multi_threaded, points, time_code);
+			result = deformImpl_SpaceMode(ctx, multi_threaded, points, time_code);
 			break;
 		default:
-			result = deformImpl_DistMode(multi_threaded, points, time_code);
+			result = deformImpl_DistMode(ctx, multi_threaded, points, time_code);
 			break;
 	}
 	
@@ -81,7 +83,7 @@ static inline bool saturate(bool a) {
 	return a < 0.f ? 0.f : (a > 1.f ? 1.f : a);
 }
 
-bool WrapCurvesDeformer::deformImpl_SpaceMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool WrapCurvesDeformer::deformImpl_SpaceMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	assert(mpPhantomTrimeshData);
 	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
 	assert(pPhantomTrimesh);
@@ -90,7 +92,8 @@ bool WrapCurvesDeformer::deformImpl_SpaceMode(bool multi_threaded, PointsList& p
 
 	const auto& pointBinds = mpWrapCurvesDeformerData->getPointBinds();
 
-	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
+	const auto* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
+	const auto& liveVertexNormals = ctx.liveVertexNormals;
 
 	auto func = [&](const std::size_t start, const std::size_t end) {
 		for(size_t i = start; i < end; ++i) {
@@ -100,7 +103,7 @@ bool WrapCurvesDeformer::deformImpl_SpaceMode(bool multi_threaded, PointsList& p
 			const auto& face = pPhantomTrimesh->getFace(bind.face_id);
 			
 			pxr::GfVec3f interpolated_normal = pxr::GfGetNormalized(
-				bind.u * mLiveVertexNormals[face.indices[1]] + bind.v * mLiveVertexNormals[face.indices[2]] + (1.f - bind.u - bind.v) * mLiveVertexNormals[face.indices[0]]
+				bind.u * liveVertexNormals[face.indices[1]] + bind.v * liveVertexNormals[face.indices[2]] + (1.f - bind.u - bind.v) * liveVertexNormals[face.indices[0]]
 			, MIN_VECTOR_LENGTH_F);
 
 			points[i] = pDeformerMeshContainer->getInterpolatedLivePosition(face, bind.u, bind.v) + (interpolated_normal * bind.dist);
@@ -117,14 +120,18 @@ bool WrapCurvesDeformer::deformImpl_SpaceMode(bool multi_threaded, PointsList& p
     return true;
 }
 
-bool WrapCurvesDeformer::buildCurvesLocalAnimVectors(bool multi_threaded) {
+bool WrapCurvesDeformer::buildCurvesLocalAnimVectors(EvalContext& ctx, bool multi_threaded) {
 	if(!mCurvesGeoPrimHandle.positionsMightBeTimeVarying()) return false;
 
 	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
-	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
+	const auto* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
+	const PxrCurvesContainer* pCurvesContainer = ctx.pCurvesContainer;
 
-	mTmpCurvesLocalAnimVectors.resize(mpCurvesContainer->getTotalVertexCount());
-	mTmpFaceNTBMatrices.resize(pPhantomTrimesh->getFaceCount());
+	auto& curvesLocalAnimVectors = ctx.curvesLocalAnimVectors;
+	auto& faceNTBMatrices = ctx.faceNTBMatrices;
+
+	curvesLocalAnimVectors.resize(pCurvesContainer->getTotalVertexCount());
+	faceNTBMatrices.resize(pPhantomTrimesh->getFaceCount());
 
 	const std::vector<PhantomTrimesh::TriFace>& faces = pPhantomTrimesh->getFaces();
 
@@ -143,25 +150,25 @@ bool WrapCurvesDeformer::buildCurvesLocalAnimVectors(bool multi_threaded) {
 				const pxr::GfVec3f B = p2 - p0;
 				const pxr::GfVec3f N = pxr::GfGetNormalized(pxr::GfCross(T, B), MIN_VECTOR_LENGTH_F);
 
-				mTmpFaceNTBMatrices[face_id] = pxr::GfMatrix3f(N[0], T[0], B[0], N[1], T[1], B[1], N[2], T[2], B[2]).GetInverse();
+				faceNTBMatrices[face_id] = pxr::GfMatrix3f(N[0], T[0], B[0], N[1], T[1], B[1], N[2], T[2], B[2]).GetInverse();
 			}
 		}
 	};
 
 	auto func = [&](const std::size_t start, const std::size_t end) {
 		const auto& pointBinds = mpWrapCurvesDeformerData->getPointBinds();
-		const auto& rest_curves_points = mpCurvesContainer->getRestCurvePoints();
-		assert(rest_curves_points.size() == mpCurvesContainer->getTotalVertexCount());
+		const auto& rest_curves_points = pCurvesContainer->getRestCurvePoints();
+		assert(rest_curves_points.size() == pCurvesContainer->getTotalVertexCount());
 		assert(rest_curves_points.size() == pointBinds.size());
 
 		for(size_t curve_idx = start; curve_idx < end; ++curve_idx) {
-			uint32_t vertex_offset = mpCurvesContainer->getCurveVertexOffset(curve_idx);
-			const PxrCurvesContainer::CurveDataPtr curve_data_ptr = mpCurvesContainer->getCurveDataPtr(curve_idx); // curve_data_ptr.first is curve_points_count and curve_data_ptr.second is ptr to vertex 0
-			const pxr::GfVec3f& root_pt = mpCurvesContainer->getCurveRootPoint(curve_idx);
+			uint32_t vertex_offset = pCurvesContainer->getCurveVertexOffset(curve_idx);
+			const PxrCurvesContainer::CurveDataPtr curve_data_ptr = pCurvesContainer->getCurveDataPtr(curve_idx); // curve_data_ptr.first is curve_points_count and curve_data_ptr.second is ptr to vertex 0
+			const pxr::GfVec3f& root_pt = pCurvesContainer->getCurveRootPoint(curve_idx);
 
 			for(size_t i = 0; i < curve_data_ptr.first; ++i) {
 				const auto face_id = pointBinds[vertex_offset].face_id;
-				mTmpCurvesLocalAnimVectors[vertex_offset] = mTmpFaceNTBMatrices[face_id] * (rest_curves_points[vertex_offset] - (root_pt + *(curve_data_ptr.second + i)));
+				curvesLocalAnimVectors[vertex_offset] = faceNTBMatrices[face_id] * (rest_curves_points[vertex_offset] - (root_pt + *(curve_data_ptr.second + i)));
 				vertex_offset++;
 			}
 		}
@@ -171,38 +178,42 @@ bool WrapCurvesDeformer::buildCurvesLocalAnimVectors(bool multi_threaded) {
 		BS::multi_future<void> blocks_mf = mPool.submit_blocks(0u, pPhantomTrimesh->getFaceCount(), face_matrix_func);
 		blocks_mf.wait();
 
-		BS::multi_future<void> blocks = mPool.submit_blocks(0u, mpCurvesContainer->getCurvesCount(), func);
+		BS::multi_future<void> blocks = mPool.submit_blocks(0u, pCurvesContainer->getCurvesCount(), func);
 		blocks.wait();
 	} else {
 		face_matrix_func(0u, pPhantomTrimesh->getFaceCount());
-		func(0u, mpCurvesContainer->getCurvesCount());
+		func(0u, pCurvesContainer->getCurvesCount());
 	}
 
 	return true;
 }
 
-bool WrapCurvesDeformer::deformImpl_DistMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
+bool WrapCurvesDeformer::deformImpl_DistMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code) {
 	assert(mpPhantomTrimeshData);
 	const auto* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
 	assert(pPhantomTrimesh);
 
 	if(!pPhantomTrimesh || !pPhantomTrimesh->isValid()) return false;
 
-	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
+	const auto* pDeformerMeshContainer = ctx.pDeformerMeshContainer;
 	assert(pDeformerMeshContainer);
 
+	auto& liveTriFaceNormals = ctx.liveTriFaceNormals;
+	auto& faceNTBMatrices = ctx.faceNTBMatrices;
+	const auto& curvesLocalAnimVectors = ctx.curvesLocalAnimVectors;
+
 	const auto& pointBinds = mpWrapCurvesDeformerData->getPointBinds();
 
-	mLiveTriFaceNormals.resize(pPhantomTrimesh->getFaceCount());
-	const bool adjust_for_curve_local_anim = buildCurvesLocalAnimVectors(multi_threaded);
+	liveTriFaceNormals.resize(pPhantomTrimesh->getFaceCount());
+	const bool adjust_for_curve_local_anim = buildCurvesLocalAnimVectors(ctx, multi_threaded);
 
 	auto face_normal_and_matrix_func = [&](const std::size_t start, const std::size_t end) {
 		const auto& face_flags = pPhantomTrimesh->getFaceFlags(); 
 		for(uint32_t face_id = static_cast<uint32_t>(start); face_id < static_cast<uint32_t>(end); ++face_id) {
 			assert(face_id < face_flags.size());
 			if(is_set(face_flags[face_id], PhantomTrimesh::TriFace::Flags::Bound)) {
-				assert(face_id < mLiveTriFaceNormals.size());
-				mLiveTriFaceNormals[face_id] = pDeformerMeshContainer->getFaceLiveNormal(pPhantomTrimesh->getFace(face_id));
+				assert(face_id < liveTriFaceNormals.size());
+				liveTriFaceNormals[face_id] = pDeformerMeshContainer->getFaceLiveNormal(pPhantomTrimesh->getFace(face_id));
 			}
 		}
 
@@ -221,7 +232,7 @@ bool WrapCurvesDeformer::deformImpl_DistMode(bool multi_threaded, PointsList& po
 					const pxr::GfVec3f B = p2 - p0;
 					const pxr::GfVec3f N = pxr::GfGetNormalized(pxr::GfCross(T, B), MIN_VECTOR_LENGTH_F);
 
-					mTmpFaceNTBMatrices[face_id] = pxr::GfMatrix3f(N[0], T[0], B[0], N[1], T[1], B[1], N[2], T[2], B[2]);
+					faceNTBMatrices[face_id] = pxr::GfMatrix3f(N[0], T[0], B[0], N[1], T[1], B[1], N[2], T[2], B[2]);
 				}
 			}
 		}
@@ -231,15 +242,15 @@ bool WrapCurvesDeformer::deformImpl_DistMode(bool multi_threaded, PointsList& po
 		for(size_t i = start; i < end; ++i) {
 			const auto& bind = pointBinds[i];
 			assert(bind.face_id != PointBindData::kInvalidFaceID);
-			assert(bind.face_id < mLiveTriFaceNormals.size());
+			assert(bind.face_id < liveTriFaceNormals.size());
 
-			points[i] = pDeformerMeshContainer->getInterpolatedLivePosition(pPhantomTrimesh->getFace(bind.face_id), bind.u, bind.v) + (mLiveTriFaceNormals[bind.face_id] * bind.dist);
+			points[i] = pDeformerMeshContainer->getInterpolatedLivePosition(pPhantomTrimesh->getFace(bind.face_id), bind.u, bind.v) + (liveTriFaceNormals[bind.face_id] * bind.dist);
 		}
 
 		if(adjust_for_curve_local_anim) {
 			for(size_t i = start; i < end; ++i) {
-				const auto& m = mTmpFaceNTBMatrices[pointBinds[i].face_id];
-				points[i] += m * mTmpCurvesLocalAnimVectors[i];
+				const auto& m = faceNTBMatrices[pointBinds[i].face_id];
+				points[i] += m * curvesLocalAnimVectors[i];
 			}
 		}
 	};
@@ -257,16 +268,10 @@ bool WrapCurvesDeformer::deformImpl_DistMode(bool multi_threaded, PointsList& po
 	return true;
 }
 
-bool WrapCurvesDeformer::writeJsonDataToPrimImpl() const {
-	if(!BaseMeshCurvesDeformer::writeJsonDataToPrimImpl()) {
-		return false;
-	}
+void WrapCurvesDeformer::collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const {
+	BaseMeshCurvesDeformer::collectDataToWrite(requests);
 
-	if(mpWrapCurvesDeformerData && !mCurvesGeoPrimHandle.writeDataToBson(getDataPrimPath(), mpWrapCurvesDeformerData.get())) {
-		DLOG_ERR << "Error writing " << mpWrapCurvesDeformerData->typeName() << " deformer data to json !";	
-		return false;
-	}
-	return true;
+	if(mpWrapCurvesDeformerData) requests.push_back({&mCurvesGeoPrimHandle, mpWrapCurvesDeformerData.get()});
 }
 
 bool WrapCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded) {
@@ -292,6 +297,9 @@ bool WrapCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code,
 			// First triangulate using simple "fan" triangulation
 			const uint32_t src_mesh_face_count = pAdjacency->getFaceCount();
 
+			std::vector<PhantomTrimesh::TriFace::IndicesList> fan_faces;
+			fan_faces.reserve(src_mesh_face_count * 2);
+
 			for(uint32_t face_id = 0; face_id < src_mesh_face_count; ++face_id) {
 				const uint32_t face_vertex_count = pAdjacency->getFaceVertexCount(face_id);
 				
@@ -304,31 +312,33 @@ bool WrapCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code,
 
 				switch(face_vertex_count) {
 					case 3:
-						pPhantomTrimesh->getOrCreateFaceID(
+						fan_faces.push_back(PhantomTrimesh::makeFace(
 							pAdjacency->getFaceVertex(face_id, 0), 
 							pAdjacency->getFaceVertex(face_id, 1),
 							pAdjacency->getFaceVertex(face_id, 2)
-						);
+						).indices);
 						break;
 					default:
 						for(uint32_t ii = 1; ii < (face_vertex_count - 1); ++ii) {
-							pPhantomTrimesh->getOrCreateFaceID(
+							fan_faces.push_back(PhantomTrimesh::makeFace(
 								pAdjacency->getFaceVertex(face_id, 0), 
 								pAdjacency->getFaceVertex(face_id, ii % face_vertex_count),
 								pAdjacency->getFaceVertex(face_id, (ii + 1) % face_vertex_count)
-							);
+							).indices);
 						}
 						break;
 				}
 			}
 
+			std::vector<uint32_t> fan_face_ids;
+			pPhantomTrimesh->createFaceIDs(fan_faces, fan_face_ids, (multi_threaded ? &mPool : nullptr));
+
 			const size_t tri_face_count = pPhantomTrimesh->getFaceCount();
 
 			DLOG_DBG << src_mesh_face_count << " source mesh faces triangulated to " << tri_face_count << " triangles.";
 
 			std::vector<pxr::GfVec3f> rest_vertex_normals;
 			buildVertexNormals(pAdjacency, pPhantomTrimesh, rest_vertex_normals, mpDeformerMeshContainer->getRestPositions(), (multi_threaded ? &mPool : nullptr));
-			mLiveVertexNormals.resize(rest_vertex_normals.size());
 
 			// Bind curve points
 			DLOG_DBG << "Binding " << mpCurvesContainer->getCurvesCount() << " curves (" << mpCurvesContainer->getTotalVertexCount() << " total vertices).";	
@@ -370,16 +380,6 @@ bool WrapCurvesDeformer::buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code,
 	return mpWrapCurvesDeformerData->isValid();
 }
 
-static std::unique_ptr<neighbour_search::KDTree<float, 3>> buildTrimeshCentroidsKDTree(const MeshContainer* pMeshContainer, const PhantomTrimesh* pTrimesh, bool threaded_kdtree_creation) {
-	
-	pxr::VtArray<pxr::GfVec3f> trimesh_centroids(pTrimesh->getFaceCount());
-	for(uint32_t face_id = 0; face_id < pTrimesh->getFaceCount(); ++face_id) {
-		trimesh_centroids[face_id] = pMeshContainer->getFaceRestCentroid(pTrimesh->getFace(face_id));
-	}
-
-	return std::make_unique<neighbour_search::KDTree<float, 3>>(trimesh_centroids, threaded_kdtree_creation);
-}
-
 bool WrapCurvesDeformer::buildDeformerData_DistMode(bool multi_threaded, const std::vector<pxr::GfVec3f>& rest_vertex_normals, pxr::UsdTimeCode rest_time_code) {
 	PROFILE("WrapCurvesDeformer::buildDeformerData_DistMode");
 
@@ -389,7 +389,7 @@ bool WrapCurvesDeformer::buildDeformerData_DistMode(bool multi_threaded, const s
 	const size_t curves_count = pCurvesContainer->getCurvesCount();
 	const size_t curves_vertex_count = pCurvesContainer->getTotalVertexCount(); 
 
-	auto& pointBinds = mpWrapCurvesDeformerData->mPointBinds;
+	auto& pointBinds = mpWrapCurvesDeformerData->pointBinds();
 	pointBinds.resize(pCurvesContainer->getTotalVertexCount());
 
 	assert(mpPhantomTrimeshData);
@@ -415,8 +415,14 @@ bool WrapCurvesDeformer::buildDeformerData_DistMode(bool multi_threaded, const s
 
 	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
 
-	// Build kdtree
-	std::unique_ptr<neighbour_search::KDTree<float, 3>> pKDtree = has_pp_prim_indices ? nullptr : buildTrimeshCentroidsKDTree(mpDeformerMeshContainer.get(), pPhantomTrimesh, true);
+	// Build faces bvh
+	TrimeshBVH::UniquePtr pFacesBVH = has_pp_prim_indices ? nullptr : TrimeshBVH::create(pPhantomTrimesh, pDeformerMeshContainer->getRestPositions(), multi_threaded ? &mPool : nullptr);
+
+	// Per point candidate faces for prim attribute binds. Face ids are created once binding is done
+	std::vector<PhantomTrimesh::TriFace::IndicesList> bind_faces;
+	if(has_pp_prim_indices) {
+		bind_faces.resize(curves_vertex_count, PhantomTrimesh::TriFace::kInvalidIndices);
+	}
 
     auto func = [&](const std::size_t start, const std::size_t end) {
 		if(multi_threaded) {
@@ -450,8 +456,9 @@ bool WrapCurvesDeformer::buildDeformerData_DistMode(bool multi_threaded, const s
 					// bind using per point prim_id attr
 					const uint32_t prim_vertex_count = pAdjacency->getFaceVertexCount(prim_id);
 					assert(prim_vertex_count > 2);
+					PhantomTrimesh::TriFace face;
 					if(prim_vertex_count == 3) {
-						bind.face_id = pPhantomTrimesh->getOrCreateFaceID(
+						face = PhantomTrimesh::makeFace(
 							pAdjacency->getFaceVertex(prim_id, 0), 
 							pAdjacency->getFaceVertex(prim_id, 1),
 							pAdjacency->getFaceVertex(prim_id, 2)
@@ -470,21 +477,25 @@ bool WrapCurvesDeformer::buildDeformerData_DistMode(bool multi_threaded, const s
 								tmp_indexed_squared_distances[2].second != tmp_indexed_squared_distances[0].second
 						);
 
-						bind.face_id = pPhantomTrimesh->getOrCreateFaceID(
+						face = PhantomTrimesh::makeFace(
 							tmp_indexed_squared_distances[0].second,
 							tmp_indexed_squared_distances[1].second,
 							tmp_indexed_squared_distances[2].second
 						);
 					}
 
-					assert(bind.face_id != PhantomTrimesh::kInvalidTriFaceID);
-					pDeformerMeshContainer->projectPoint(curr_pt, pPhantomTrimesh->getFace(bind.face_id), bind.u, bind.v, bind.dist);
+					assert(face.isValid());
+					pDeformerMeshContainer->projectPoint(curr_pt, face, bind.u, bind.v, bind.dist);
+
+					bind_faces[curve_vertex_offset + i] = face.indices;
+					bind.face_id = curve_vertex_offset + i; // pending. resolved to trimesh face id once binding is done
 
 				} else {
         			// auto search
-        			assert(pKDtree);
-					const neighbour_search::KDTree<float, 3>::ReturnType nearest_pt = pKDtree->findNearestNeighbour(curr_pt);
-					const uint32_t face_id = nearest_pt.first;
+        			assert(pFacesBVH);
+					float face_sq_dist;
+					const uint32_t face_id = pFacesBVH->findClosestFace(curr_pt, face_sq_dist);
+					if(face_id == TrimeshBVH::kInvalidFaceID) continue;
 
 					auto bindCurvePointToPrim = [&] (const uint32_t curve_vtx, const uint32_t face_id, PointBindData& bind) {
 						const auto& face = faces[face_id];
@@ -526,6 +537,15 @@ bool WrapCurvesDeformer::buildDeformerData_DistMode(bool multi_threaded, const s
 		func(0, curves_count);
 	}
 
+	if(has_pp_prim_indices) {
+		std::vector<uint32_t> bind_face_ids;
+		pPhantomTrimesh->createFaceIDs(bind_faces, bind_face_ids, (multi_threaded ? &mPool : nullptr));
+
+		for(size_t i = 0; i < curves_vertex_count; ++i) {
+			if(bind_faces[i][0] != PhantomTrimesh::TriFace::kInvalidVertexID) pointBinds[i].face_id = bind_face_ids[i];
+		}
+	}
+
     DLOG_TRC << "WrapCurvesDeformer::buildDeformerData_DistMode() done.";
 
 	return true;
@@ -543,7 +563,7 @@ bool WrapCurvesDeformer::buildDeformerData_SpaceMode(bool multi_threaded, const
 	std::atomic<size_t> bound_curves = 0;
 	std::atomic<size_t> partially_bound_curves = 0;
 
-	auto& pointBinds = mpWrapCurvesDeformerData->mPointBinds;
+	auto& pointBinds = mpWrapCurvesDeformerData->pointBinds();
 	pointBinds.resize(pCurvesContainer->getTotalVertexCount());
 
 	const PhantomTrimesh* pPhantomTrimesh = mpPhantomTrimeshData->getTrimesh();
@@ -566,8 +586,8 @@ bool WrapCurvesDeformer::buildDeformerData_SpaceMode(bool multi_threaded, const
 
 	const auto* pDeformerMeshContainer = mpDeformerMeshContainer.get();
 
-	// Build kdtree
-	std::unique_ptr<neighbour_search::KDTree<float, 3>> pKDtree = has_pp_prim_indices ? nullptr : buildTrimeshCentroidsKDTree(mpDeformerMeshContainer.get(), pPhantomTrimesh, true);
+	// Build faces bvh
+	TrimeshBVH::UniquePtr pFacesBVH = has_pp_prim_indices ? nullptr : TrimeshBVH::create(pPhantomTrimesh, pDeformerMeshContainer->getRestPositions(), multi_threaded ? &mPool : nullptr);
 
     auto func = [&](const std::size_t start, const std::size_t end) {
     	if(multi_threaded) {
@@ -605,7 +625,7 @@ bool WrapCurvesDeformer::buildDeformerData_SpaceMode(bool multi_threaded, const
 					// bind using per point prim_id attr
 				} else { 
 					// automatic search
-					for(uint32_t face_id = 0; face_id < faces_count; ++face_id) {
+					auto testFace = [&](const uint32_t face_id) {
 						const auto& face = faces[face_id];
 						const auto& face_normal = pDeformerMeshContainer->getFaceRestNormal(face);
 						const Plane face_plane(mesh_rest_positions[face.indices[0]], face_normal);
@@ -636,21 +656,32 @@ bool WrapCurvesDeformer::buildDeformerData_SpaceMode(bool multi_threaded, const
 						float denom = d00 * d11 - d01 * d01;
 
 						float u = (d11 * d20 - d01 * d21) / denom;
-						if(u < 0.0f || u > 1.0f) continue;
+						if(u < 0.0f || u > 1.0f) return;
 
 						float v = (d00 * d21 - d01 * d20) / denom;
-						if((v < 0.f) || ((u + v) > 1.f)) continue;
+						if((v < 0.f) || ((u + v) > 1.f)) return;
 
 						const pxr::GfVec3f projected_point = pDeformerMeshContainer->getInterpolatedRestPosition(face, u, v);
 						float bind_dist = point_is_in_plane ? 0.f : distance(projected_point, curr_pt);
 
-						if(abs(bind_dist) < abs(bind.dist)) {
+						// lower face id wins on equal distances, same as a linear scan over all faces
+						if((abs(bind_dist) < abs(bind.dist)) || ((abs(bind_dist) == abs(bind.dist)) && (face_id < bind.face_id))) {
 							bind.face_id = face_id;
 							bind.dist = bind_dist;
 							bind.u = u;
 							bind.v = v;
-						}         			
-					} // faces loop
+						}
+					};
+
+					// bind distance is measured to a point on the rest triangle, so faces which bounds are farther than
+					// the best distance found so far can't win. small margin covers in-plane tolerance and float error
+					float search_dist = PointBindData::kFltMax;
+					pFacesBVH->visitNearest(curr_pt, search_dist, [&](const uint32_t face_id) {
+						testFace(face_id);
+						if(bind.face_id != PointBindData::kInvalidFaceID) {
+							search_dist = abs(bind.dist) * (1.f + kBVHSearchRelMargin) + kBVHSearchAbsMargin;
+						}
+					});
 				}
         	
         		if(bind.face_id != PointBindData::kInvalidFaceID) {
@@ -702,12 +733,13 @@ bool WrapCurvesDeformer::buildDeformerData_SpaceMode(bool multi_threaded, const
 
         	// TODO: Fully unbound curves loop to find best vertex-face candidate for each curve so we can populate remaining vertices
         	// in a subsequent pass
-        	if(bound_curve_vertices_count == 0) {
+        	if(bound_curve_vertices_count == 0 && pFacesBVH) {
+        		float nearest_face_sq_dist;
+        		const uint32_t nearest_face_id = pFacesBVH->findClosestFace(curve_root_pt, nearest_face_sq_dist);
+        		if(nearest_face_id == TrimeshBVH::kInvalidFaceID) continue;
+
         		for(uint32_t curve_vtx = 0; curve_vtx < curve_vertices_count; ++curve_vtx) {
         			auto& bind = pointBinds[curve_vertex_offset + curve_vtx];
-        			const neighbour_search::KDTree<float, 3>::ReturnType nearest_pt = pKDtree->findNearestNeighbour(curve_root_pt);
-        			const auto nearest_face_id = nearest_pt.first;
-        			
         			bindCurvePointToPrimForceI(curve_vtx, nearest_face_id, bind);
 					bound_curve_vertices_count += 1;
         		}
@@ -35,34 +35,38 @@ class WrapCurvesDeformer : public BaseMeshCurvesDeformer, public inherit_shared_
 		void setBindMode(BindMode mode);
 		BindMode getBindMode() const;
 
+		struct EvalContext : public BaseCurvesDeformer::EvalContext {
+			std::vector<pxr::GfVec3f> 				liveVertexNormals;
+			std::vector<pxr::GfVec3f> 				liveTriFaceNormals;
+
+			std::vector<pxr::GfMatrix3f>            faceNTBMatrices;
+			std::vector<pxr::GfVec3f>               curvesLocalAnimVectors;
+		};
+
 	protected:
 		WrapCurvesDeformer(const std::string& name);
-		virtual bool deformImpl(PointsList& points, pxr::UsdTimeCode time_code) override;
-		virtual bool deformMtImpl(PointsList& points, pxr::UsdTimeCode time_code) override;
+		virtual bool deformImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) override;
+		virtual bool deformMtImpl(BaseCurvesDeformer::EvalContext& ctx, PointsList& points, pxr::UsdTimeCode time_code) override;
 		virtual void invalidateData(DeformerDataCache& cache) override;
 
-		bool deformImpl_SpaceMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
-		bool deformImpl_DistMode(bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		virtual BaseCurvesDeformer::EvalContext::UniquePtr createEvalContext() const override { return std::make_unique<EvalContext>(); }
+
+		bool deformImpl_SpaceMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
+		bool deformImpl_DistMode(EvalContext& ctx, bool multi_threaded, PointsList& points, pxr::UsdTimeCode time_code);
 
 	private:
-		bool __deform__(PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code);
+		bool __deform__(EvalContext& ctx, PointsList& points, bool multi_threaded, pxr::UsdTimeCode time_code);
 
 		virtual bool buildDeformerDataImpl(pxr::UsdTimeCode rest_time_code, bool multi_threaded = false);
-		virtual bool writeJsonDataToPrimImpl() const;
+		virtual void collectDataToWrite(std::vector<UsdPrimHandle::DataRequest>& requests) const override;
 		
 		bool buildDeformerData_SpaceMode(bool multi_threaded, const std::vector<pxr::GfVec3f>& rest_vertex_normals, pxr::UsdTimeCode rest_time_code);
 		bool buildDeformerData_DistMode(bool multi_threaded, const std::vector<pxr::GfVec3f>& rest_vertex_normals, pxr::UsdTimeCode rest_time_code);
 
-		bool buildCurvesLocalAnimVectors(bool multi_threaded);
+		bool buildCurvesLocalAnimVectors(EvalContext& ctx, bool multi_threaded);
 
 		std::shared_ptr<WrapCurvesDeformerData> mpWrapCurvesDeformerData;
 
-		std::vector<pxr::GfVec3f> 				mLiveVertexNormals;
-		std::vector<pxr::GfVec3f> 				mLiveTriFaceNormals;
-
-		std::vector<pxr::GfMatrix3f>            mTmpFaceNTBMatrices;
-		std::vector<pxr::GfVec3f>               mTmpCurvesLocalAnimVectors;
-
 		BindMode                                mBindMode;
 };
 
@@ -14,6 +14,7 @@ WrapCurvesDeformerData::WrapCurvesDeformerData(): mIsValid(false), mBindMode(Wra
 void WrapCurvesDeformerData::clearData() {
 	const std::lock_guard<std::mutex> lock(mMutex);
 
+	mPointBindsLoader.reset();
 	mPointBinds.clear();
 	mIsValid = false;
 }
@@ -42,6 +43,7 @@ static constexpr const char* kJDataHash = "data_hash";
 bool WrapCurvesDeformerData::dumpToJSON(json& j) const {
 	const std::lock_guard<std::mutex> lock(mMutex);
 	
+	mPointBindsLoader.ensureAll();
 	j[kJPointBinds] = mPointBinds;
 	j[kJMode] = to_string(mBindMode);
 	j[kJDataHash] = calcHash();
@@ -73,6 +75,42 @@ bool WrapCurvesDeformerData::readFromJSON(const json& j) {
 	return true;
 }
 
+bool WrapCurvesDeformerData::dumpToBinary(BinaryDataWriter& writer) const {
+	mPointBindsLoader.ensureAll();
+
+	writer.addValue(kJMode, static_cast<uint8_t>(mBindMode));
+	writer.addChunkedBlock(kJPointBinds, mPointBinds);
+	writer.addValue(kJDataHash, static_cast<uint64_t>(calcHash()));
+
+	return true;
+}
+
+bool WrapCurvesDeformerData::readFromBinary(const BinaryDataReader& reader) {
+	mIsValid = false;
+
+	uint8_t bind_mode;
+	if(!reader.readValue(kJMode, bind_mode)) return false;
+
+	if(static_cast<BindMode>(bind_mode) != mBindMode) {
+		LOG_ERR << typeName() << " binary data bind mode mismatch !";
+		return false;
+	}
+
+	uint64_t data_hash;
+	if(!mPointBindsLoader.attach(reader, kJPointBinds, mPointBinds) || !reader.readValue(kJDataHash, data_hash)) return false;
+
+	// Lazily decoded chunks are verified by their own checksums
+	if(!mPointBindsLoader.isPending() && data_hash != calcHash()) {
+		LOG_ERR << typeName() << " binary data hash mismatch !";
+		return false;
+	}
+
+	LOG_DBG << "WrapCurvesDeformerData data read from binary payload !";
+
+	mIsValid = true;
+	return true;
+}
+
 void  WrapCurvesDeformerData::setBindMode(const WrapCurvesDeformerData::BindMode& mode) {
 	if(mBindMode == mode) return;
 	mBindMode = mode;
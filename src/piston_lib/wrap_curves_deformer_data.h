@@ -30,7 +30,7 @@ class WrapCurvesDeformerData : public SerializableDeformerDataBase {
 			inline bool isValid() const { return face_id != kInvalidFaceID; }
 		};
 
-		const std::vector<PointBindData>& 	getPointBinds() const { return mPointBinds; }
+		const std::vector<PointBindData>& 	getPointBinds() const { mPointBindsLoader.ensureAll(); return mPointBinds; }
 		BindMode        					getBindMode() const { return mBindMode; }
 		void  								setBindMode(const BindMode& mode);
 
@@ -45,14 +45,21 @@ class WrapCurvesDeformerData : public SerializableDeformerDataBase {
 		virtual bool dumpToJSON(json& j) const override;
 		virtual bool readFromJSON(const json& j) override;
 
+		virtual bool hasBinaryLayout() const override { return true; }
+		virtual bool dumpToBinary(BinaryDataWriter& writer) const override;
+		virtual bool readFromBinary(const BinaryDataReader& reader) override;
+
 		virtual void clearData() override;
 
+		std::vector<PointBindData>& 		pointBinds() { mPointBindsLoader.ensureAll(); return mPointBinds; }
+
 	private:
 		size_t 	calcHash() const;
 		void 	setValid(bool state) { const std::lock_guard<std::mutex> lock(mMutex); mIsValid = state; }
 
 		BindMode                                mBindMode = BindMode::DIST;
 		std::vector<PointBindData>              mPointBinds;
+		LazyChunkedBlock                        mPointBindsLoader;  // decodes mPointBinds chunks on first access
 		bool 									mIsValid;
 
 		friend class WrapCurvesDeformer;